@@ -0,0 +1,53 @@
+/* file allocount.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Replacement global operator new/delete that count allocations.
+ * Array and nothrow forms forward to these;  over-aligned
+ * allocations (operator new(size_t, align_val_t)) are not counted.
+ */
+
+#include "allocount.hpp"
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+namespace xo {
+    namespace bench {
+        namespace {
+            std::atomic<std::size_t> s_n_alloc{0};
+        }
+
+        std::size_t
+        n_alloc() {
+            return s_n_alloc.load(std::memory_order_relaxed);
+        }
+    } /*namespace bench*/
+} /*namespace xo*/
+
+void *
+operator new(std::size_t z)
+{
+    xo::bench::s_n_alloc.fetch_add(1, std::memory_order_relaxed);
+
+    void * retval = std::malloc(z ? z : 1);
+
+    if (!retval)
+        throw std::bad_alloc();
+
+    return retval;
+}
+
+void
+operator delete(void * p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void * p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/* end allocount.cpp */
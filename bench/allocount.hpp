@@ -0,0 +1,20 @@
+/* file allocount.hpp
+ *
+ * author: Roland Conybeare
+ *
+ * Count heap allocations made through global operator new
+ * (replaced in allocount.cpp,  for bench.reader only)
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace xo {
+    namespace bench {
+        /* #of calls to global operator new (any thread) since program start */
+        std::size_t n_alloc();
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end allocount.hpp */
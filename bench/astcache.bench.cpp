@@ -0,0 +1,115 @@
+/* file astcache.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Binary AST images on a synthetic corpus (size in MB given by benchmark arg):
+ * - BM_astcache_parse: reader::read_all(),  for comparison
+ * - BM_astcache_encode: astimage::encode() of parsed corpus
+ * - BM_astcache_decode: astimage::decode(),  i.e. work done on a cache hit
+ *   after mapping the image
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/astimage.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::astimage;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+
+    namespace bench {
+        namespace {
+            std::string
+            astcache_corpus(std::size_t n_mb) {
+                std::vector<const char *> form_v = default_forms();
+
+                form_v.push_back("def f = lambda (x : f64, y : f64) { def z = x * y; z + x; };\n");
+
+                std::string block = make_corpus(form_v, 1024);
+                std::string retval;
+
+                retval.reserve((n_mb << 20) + block.size());
+
+                while (retval.size() < (n_mb << 20))
+                    retval += block;
+
+                return retval;
+            }
+
+            std::vector<reader_result>
+            parse(const std::string & text) {
+                reader rdr;
+                std::vector<reader_result> retval;
+
+                rdr.begin_translation_unit();
+                rdr.read_all(reader::span_type(text.data(), text.data() + text.size()),
+                             true /*eof*/, &retval);
+
+                return retval;
+            }
+
+            astimage::span_type
+            as_span(const std::string & text) {
+                return astimage::span_type(text.data(), text.data() + text.size());
+            }
+        }
+
+        static void
+        BM_astcache_parse(benchmark::State & state) {
+            std::string text = astcache_corpus(state.range(0));
+
+            std::size_t n_expr = 0;
+
+            for (auto _ : state)
+                n_expr = read_all(text);
+
+            state.counters["exprs"] = n_expr;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        static void
+        BM_astcache_encode(benchmark::State & state) {
+            std::string text = astcache_corpus(state.range(0));
+            auto result_v = parse(text);
+
+            std::string image;
+
+            for (auto _ : state) {
+                astimage::encode(as_span(text), 0 /*flags*/, result_v, &image);
+                benchmark::DoNotOptimize(image.data());
+            }
+
+            state.counters["image_bytes"] = image.size();
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        static void
+        BM_astcache_decode(benchmark::State & state) {
+            std::string text = astcache_corpus(state.range(0));
+            auto result_v = parse(text);
+
+            std::string image;
+            astimage::encode(as_span(text), 0 /*flags*/, result_v, &image);
+
+            std::size_t n_expr = 0;
+
+            for (auto _ : state) {
+                auto decoded_v = astimage::decode(as_span(image), as_span(text));
+
+                n_expr = decoded_v.size();
+                benchmark::DoNotOptimize(decoded_v.data());
+            }
+
+            state.counters["exprs"] = n_expr;
+            state.counters["image_bytes"] = image.size();
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        BENCHMARK(BM_astcache_parse)->Arg(4)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_astcache_encode)->Arg(4)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_astcache_decode)->Arg(4)->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end astcache.bench.cpp */
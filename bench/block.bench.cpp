@@ -0,0 +1,208 @@
+/* file block.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Blocks with many local definitions:
+ *
+ *   { def a0 = x; def a1 = a0; ... a(n-1); }
+ *
+ * - BM_block_nested: build AST in the old shape,
+ *   one Apply(Lambda(..)) per local def (see sequence_xs history)
+ * - BM_block_flat: build AST in the shape reader emits now,
+ *   one Sequence holding n DefineExprs
+ * - BM_block_read: read block text,  end to end
+ *
+ * Each reports "nodes" = #of AST nodes per block
+ */
+
+#include "readbench.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include "xo/expression/Sequence.hpp"
+#include "xo/expression/Lambda.hpp"
+#include "xo/expression/Apply.hpp"
+#include "xo/expression/Variable.hpp"
+#include "xo/reflect/Reflect.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::ast::Expression;
+    using xo::ast::DefineExpr;
+    using xo::ast::DefineExprAccess;
+    using xo::ast::Sequence;
+    using xo::ast::Lambda;
+    using xo::ast::Apply;
+    using xo::ast::Variable;
+    using xo::reflect::Reflect;
+
+    namespace bench {
+        namespace {
+            std::string
+            local_name(std::size_t i) {
+                return "a" + std::to_string(i);
+            }
+
+            /* old shape:
+             *   Sequence(Apply(Lambda(gen, [a0], Sequence(Apply(Lambda(gen, [a1], ...)), a0))), x))
+             */
+            rp<Expression>
+            make_nested_block(std::size_t n_def, std::size_t * p_node) {
+                auto td = Reflect::require<double>();
+
+                rp<Expression> body
+                    = Sequence::make({Variable::make(local_name(n_def - 1), td)});
+                *p_node = 2;
+
+                for (std::size_t i = n_def; i > 0; --i) {
+                    std::string rhs_name = (i == 1) ? "x" : local_name(i - 2);
+
+                    auto lm = Lambda::make("let1",
+                                           {Variable::make(local_name(i - 1), td)},
+                                           body);
+                    auto app = Apply::make(lm, {Variable::make(rhs_name, td)});
+
+                    body = Sequence::make({app});
+
+                    /* Sequence, Apply, Lambda, formal, rhs */
+                    *p_node += 5;
+                }
+
+                return body;
+            }
+
+            /* new shape:
+             *   Sequence(Define(a0, x), Define(a1, a0), ..., a(n-1))
+             */
+            rp<Expression>
+            make_flat_block(std::size_t n_def, std::size_t * p_node) {
+                auto td = Reflect::require<double>();
+
+                std::vector<rp<Expression>> expr_v;
+                expr_v.reserve(n_def + 1);
+
+                for (std::size_t i = 0; i < n_def; ++i) {
+                    std::string rhs_name = (i == 0) ? "x" : local_name(i - 1);
+
+                    auto def = DefineExprAccess::make_empty();
+                    def->assign_lhs_name(local_name(i));
+                    def->assign_rhs(Variable::make(rhs_name, td));
+
+                    expr_v.push_back(def);
+                }
+
+                expr_v.push_back(Variable::make(local_name(n_def - 1), td));
+
+                /* Sequence;  Define + rhs per def;  final Variable */
+                *p_node = 1 + 2 * n_def + 1;
+
+                return Sequence::make(expr_v);
+            }
+
+            /* #of nodes in AST emitted by reader for a block-bodied lambda */
+            std::size_t
+            count_nodes(const rp<Expression> & x) {
+                if (!x)
+                    return 0;
+
+                if (auto def = dynamic_cast<DefineExpr *>(x.get()))
+                    return 1 + count_nodes(def->rhs());
+
+                if (auto lm = dynamic_cast<Lambda *>(x.get()))
+                    return 1 + lm->argv().size() + count_nodes(lm->body());
+
+                if (auto seq = dynamic_cast<Sequence *>(x.get())) {
+                    std::size_t n = 1;
+                    for (std::size_t i = 0; i < seq->size(); ++i)
+                        n += count_nodes((*seq)[i]);
+                    return n;
+                }
+
+                if (auto app = dynamic_cast<Apply *>(x.get())) {
+                    std::size_t n = 1 + count_nodes(app->fn());
+                    for (const auto & arg : app->argv())
+                        n += count_nodes(arg);
+                    return n;
+                }
+
+                return 1;
+            }
+
+            std::string
+            block_text(std::size_t n_def) {
+                std::string retval = "def f = lambda (x : f64) {";
+
+                for (std::size_t i = 0; i < n_def; ++i) {
+                    retval += " def " + local_name(i) + " = ";
+                    retval += (i == 0) ? "x" : local_name(i - 1);
+                    retval += ";";
+                }
+
+                retval += " " + local_name(n_def - 1) + "; };\n";
+
+                return retval;
+            }
+        }
+
+        static void
+        BM_block_nested(benchmark::State & state) {
+            std::size_t n_node = 0;
+
+            for (auto _ : state) {
+                auto x = make_nested_block(state.range(0), &n_node);
+                benchmark::DoNotOptimize(x);
+            }
+
+            state.counters["nodes"] = n_node;
+        }
+
+        static void
+        BM_block_flat(benchmark::State & state) {
+            std::size_t n_node = 0;
+
+            for (auto _ : state) {
+                auto x = make_flat_block(state.range(0), &n_node);
+                benchmark::DoNotOptimize(x);
+            }
+
+            state.counters["nodes"] = n_node;
+        }
+
+        static void
+        BM_block_read(benchmark::State & state) {
+            using xo::scm::reader;
+
+            std::string text = block_text(state.range(0));
+            std::size_t n_node = 0;
+
+            /* count nodes once,  outside timed loop */
+            {
+                reader rdr;
+                rdr.begin_translation_unit();
+
+                auto rr = rdr.read_expr(reader::span_type(text.data(),
+                                                          text.data() + text.size()),
+                                        true /*eof*/);
+
+                n_node = count_nodes(rr.expr_);
+            }
+
+            for (auto _ : state) {
+                reader rdr;
+                rdr.begin_translation_unit();
+
+                auto rr = rdr.read_expr(reader::span_type(text.data(),
+                                                          text.data() + text.size()),
+                                        true /*eof*/);
+                benchmark::DoNotOptimize(rr.expr_);
+            }
+
+            state.counters["nodes"] = n_node;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        BENCHMARK(BM_block_nested)->Arg(10)->Arg(100)->Arg(1000);
+        BENCHMARK(BM_block_flat)->Arg(10)->Arg(100)->Arg(1000);
+        BENCHMARK(BM_block_read)->Arg(10)->Arg(100)->Arg(1000);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end block.bench.cpp */
@@ -0,0 +1,128 @@
+/* file checkpoint.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Cost of parser::checkpoint / parser::restore,
+ * taken inside an open block with n local definitions:
+ *
+ *   def f = lambda (x : f64) { def a0 = x; def a1 = a0; ... def a(n-1) = a(n-2);
+ *
+ * Stack depth stays the same as n grows;  the block's sequence_xs
+ * and envframe grow with n.  Their contents are copy-on-write,
+ * so all three benchmarks are expected to stay flat in n
+ * (cost proportional to stack depth).
+ *
+ * BM_lookahead_block is the speculative-parse pattern:
+ * checkpoint, parse one more local definition, restore.
+ *
+ * Each reports "depth" = parser stack size at the checkpoint
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/parser.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::parser;
+    using xo::scm::parser_checkpoint;
+    using xo::scm::reader;
+
+    namespace bench {
+        namespace {
+            /* parser positioned inside a block with @p n local defs */
+            void
+            open_block(parser * p_parser, std::size_t n) {
+                std::string text = "def f = lambda (x : f64) { ";
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    text += "def a" + std::to_string(i) + " = ";
+                    text += (i == 0) ? std::string("x") : "a" + std::to_string(i - 1);
+                    text += "; ";
+                }
+
+                reader::tokenizer_type tkz;
+                auto input = reader::span_type(text.data(), text.data() + text.size());
+
+                p_parser->begin_translation_unit();
+
+                while (!input.empty()) {
+                    auto sr = tkz.scan2(input, false /*!eof*/);
+
+                    if (sr.first.is_valid())
+                        p_parser->include_token(sr.first);
+
+                    input = input.after_prefix(sr.second);
+                }
+            }
+        }
+
+        static void
+        BM_checkpoint_block(benchmark::State & state) {
+            parser psr;
+            open_block(&psr, state.range(0));
+
+            for (auto _ : state) {
+                parser_checkpoint cp = psr.checkpoint();
+                benchmark::DoNotOptimize(cp);
+            }
+
+            state.counters["depth"] = psr.stack_size();
+        }
+
+        static void
+        BM_restore_block(benchmark::State & state) {
+            parser psr;
+            open_block(&psr, state.range(0));
+
+            parser_checkpoint cp = psr.checkpoint();
+
+            for (auto _ : state) {
+                psr.restore(cp);
+                benchmark::ClobberMemory();
+            }
+
+            state.counters["depth"] = psr.stack_size();
+        }
+
+        static void
+        BM_lookahead_block(benchmark::State & state) {
+            parser psr;
+            open_block(&psr, state.range(0));
+
+            /* one more local definition */
+            std::string text = "def z = x; ";
+            std::vector<parser::token_type> tk_v;
+            {
+                reader::tokenizer_type tkz;
+                auto input = reader::span_type(text.data(), text.data() + text.size());
+
+                while (!input.empty()) {
+                    auto sr = tkz.scan2(input, false /*!eof*/);
+
+                    if (sr.first.is_valid())
+                        tk_v.push_back(sr.first);
+
+                    input = input.after_prefix(sr.second);
+                }
+            }
+
+            for (auto _ : state) {
+                parser_checkpoint cp = psr.checkpoint();
+
+                for (const auto & tk : tk_v)
+                    psr.include_token(tk);
+
+                psr.restore(cp);
+                benchmark::ClobberMemory();
+            }
+
+            state.counters["depth"] = psr.stack_size();
+        }
+
+        BENCHMARK(BM_checkpoint_block)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+        BENCHMARK(BM_restore_block)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+        BENCHMARK(BM_lookahead_block)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end checkpoint.bench.cpp */
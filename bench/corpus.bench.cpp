@@ -0,0 +1,102 @@
+/* file corpus.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Reader throughput by input shape,  on ~1MB corpora from @ref corpusgen
+ * (shape parameter given by benchmark arg).
+ *
+ * Each benchmark reports:
+ * - bytes_per_second
+ * - tokens/s, exprs/s
+ * - peak_depth:  max parser stack size,  sampled after each token
+ * - allocs/expr: global operator new calls per toplevel expression
+ * - <category> B/expr:  bytes per toplevel expression,  by alloccategory
+ * - tk_ipc, parse_ipc, *_miss/tk:  hardware counters,  when available
+ */
+
+#include "readbench.hpp"
+#include "corpusgen.hpp"
+#include "allocount.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    namespace bench {
+        namespace {
+            constexpr std::size_t c_corpus_bytes = 1024 * 1024;
+
+            void
+            run_shape(benchmark::State & state, corpusshape shape)
+            {
+                std::string text = corpusgen(shape, state.range(0)).generate(c_corpus_bytes);
+
+                std::size_t n_token = count_tokens(text);
+                std::size_t peak_depth = peak_stack_depth(text);
+                std::size_t n_expr = 0;
+                std::size_t n_alloc_total = 0;
+
+                for (auto _ : state) {
+                    std::size_t n_alloc0 = n_alloc();
+
+                    n_expr = read_all(text);
+                    benchmark::DoNotOptimize(n_expr);
+
+                    n_alloc_total += n_alloc() - n_alloc0;
+                }
+
+                state.SetLabel(corpusshape_descr(shape));
+                state.SetBytesProcessed(text.size() * state.iterations());
+                state.counters["tokens/s"]
+                    = benchmark::Counter(n_token * state.iterations(),
+                                         benchmark::Counter::kIsRate);
+                state.counters["exprs/s"]
+                    = benchmark::Counter(n_expr * state.iterations(),
+                                         benchmark::Counter::kIsRate);
+                state.counters["peak_depth"] = peak_depth;
+                state.counters["allocs/expr"]
+                    = double(n_alloc_total) / double(n_expr * state.iterations());
+
+                report_alloc(state, text);
+                report_perf(state, text);
+            }
+        }
+
+        static void
+        BM_corpus_defs(benchmark::State & state) {
+            run_shape(state, corpusshape::def_stream);
+        }
+
+        static void
+        BM_corpus_parens(benchmark::State & state) {
+            run_shape(state, corpusshape::deep_paren);
+        }
+
+        static void
+        BM_corpus_infix(benchmark::State & state) {
+            run_shape(state, corpusshape::infix_chain);
+        }
+
+        static void
+        BM_corpus_formals(benchmark::State & state) {
+            run_shape(state, corpusshape::wide_lambda);
+        }
+
+        static void
+        BM_corpus_block(benchmark::State & state) {
+            run_shape(state, corpusshape::block_defs);
+        }
+
+        static void
+        BM_corpus_lambdas(benchmark::State & state) {
+            run_shape(state, corpusshape::nested_lambda);
+        }
+
+        BENCHMARK(BM_corpus_defs)->Arg(1);
+        BENCHMARK(BM_corpus_parens)->Arg(8)->Arg(64);
+        BENCHMARK(BM_corpus_infix)->Arg(8)->Arg(64);
+        BENCHMARK(BM_corpus_formals)->Arg(8)->Arg(64);
+        BENCHMARK(BM_corpus_block)->Arg(8)->Arg(64);
+        BENCHMARK(BM_corpus_lambdas)->Arg(8)->Arg(64);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end corpus.bench.cpp */
@@ -0,0 +1,152 @@
+/* file corpusgen.hpp
+ *
+ * author: Roland Conybeare
+ *
+ * Deterministic generator for shape-controlled reader input
+ */
+
+#pragma once
+
+#include <random>
+#include <string>
+#include <cstdint>
+
+namespace xo {
+    namespace bench {
+        /* shape of each toplevel form in a generated corpus.
+         * width is the shape parameter,  e.g. nesting depth
+         */
+        enum class corpusshape {
+            /* def v7 = 12.345;  (width ignored) */
+            def_stream,
+            /* def p7 = ((((12.345))));  width = #of paren pairs */
+            deep_paren,
+            /* def c7 = lambda (x : f64) x * 1.5 + x - 2.25 ..;  width = #of operators */
+            infix_chain,
+            /* def w7 = lambda (a0 : f64, a1 : f64, ..) a0;  width = #of formals */
+            wide_lambda,
+            /* def b7 = lambda (x : f64) { def a0 = x; def a1 = a0; .. };  width = #of local defs */
+            block_defs,
+            /* def n7 = lambda (x0 : f64) lambda (x1 : f64) .. x0;  width = #of lambdas */
+            nested_lambda,
+        };
+
+        inline const char *
+        corpusshape_descr(corpusshape x) {
+            switch (x) {
+            case corpusshape::def_stream: return "def_stream";
+            case corpusshape::deep_paren: return "deep_paren";
+            case corpusshape::infix_chain: return "infix_chain";
+            case corpusshape::wide_lambda: return "wide_lambda";
+            case corpusshape::block_defs: return "block_defs";
+            case corpusshape::nested_lambda: return "nested_lambda";
+            }
+
+            return "???";
+        }
+
+        /* Generates toplevel forms of one shape.
+         * Output depends only on (shape, width, seed):
+         * constants come from std::mt19937_64,  whose sequence is fixed
+         * by the standard,  and are formatted without locale or libm.
+         */
+        class corpusgen {
+        public:
+            corpusgen(corpusshape shape, std::size_t width, std::uint64_t seed = 1)
+                : shape_{shape}, width_{width < 1 ? 1 : width}, rng_{seed} {}
+
+            /* forms appended until corpus is at least @p n_byte long */
+            std::string generate(std::size_t n_byte) {
+                std::string retval;
+                retval.reserve(n_byte + 256);
+
+                while (retval.size() < n_byte)
+                    this->append_form(&retval);
+
+                return retval;
+            }
+
+            /* append next toplevel form (newline-terminated) to @p *p_text */
+            void append_form(std::string * p_text) {
+                std::string & s = *p_text;
+                std::string ix = std::to_string(n_form_++);
+
+                switch (shape_) {
+                case corpusshape::def_stream:
+                    s += "def v" + ix + " = ";
+                    this->append_constant(p_text);
+                    s += ";\n";
+                    break;
+                case corpusshape::deep_paren:
+                    s += "def p" + ix + " = ";
+                    s.append(width_, '(');
+                    this->append_constant(p_text);
+                    s.append(width_, ')');
+                    s += ";\n";
+                    break;
+                case corpusshape::infix_chain: {
+                    static const char * s_op_v[] = {" * ", " + ", " - ", " / "};
+
+                    s += "def c" + ix + " = lambda (x : f64) x";
+                    for (std::size_t i = 0; i < width_; ++i) {
+                        s += s_op_v[i % 4];
+                        if (i % 2 == 0)
+                            this->append_constant(p_text);
+                        else
+                            s += "x";
+                    }
+                    s += ";\n";
+                    break;
+                }
+                case corpusshape::wide_lambda:
+                    s += "def w" + ix + " = lambda (";
+                    for (std::size_t i = 0; i < width_; ++i) {
+                        if (i > 0)
+                            s += ", ";
+                        s += "a" + std::to_string(i) + " : f64";
+                    }
+                    s += ") a" + std::to_string(width_ - 1) + ";\n";
+                    break;
+                case corpusshape::block_defs:
+                    s += "def b" + ix + " = lambda (x : f64) {";
+                    for (std::size_t i = 0; i < width_; ++i) {
+                        s += " def a" + std::to_string(i) + " = ";
+                        s += (i == 0) ? std::string("x") : "a" + std::to_string(i - 1);
+                        s += ";";
+                    }
+                    s += " a" + std::to_string(width_ - 1) + "; };\n";
+                    break;
+                case corpusshape::nested_lambda:
+                    s += "def n" + ix + " =";
+                    for (std::size_t i = 0; i < width_; ++i)
+                        s += " lambda (x" + std::to_string(i) + " : f64)";
+                    s += " x0;\n";
+                    break;
+                }
+            }
+
+            /* #of forms generated so far */
+            std::size_t n_form() const { return n_form_; }
+
+        private:
+            /* append a constant d.ddd,  0 <= value < 1000 */
+            void append_constant(std::string * p_text) {
+                std::uint64_t r = rng_() % 1000000;
+                std::string frac = std::to_string(r % 1000);
+
+                *p_text += std::to_string(r / 1000);
+                *p_text += '.';
+                p_text->append(3 - frac.size(), '0');
+                *p_text += frac;
+            }
+
+        private:
+            corpusshape shape_;
+            std::size_t width_;
+            std::mt19937_64 rng_;
+            std::size_t n_form_ = 0;
+        };
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end corpusgen.hpp */
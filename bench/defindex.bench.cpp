@@ -0,0 +1,104 @@
+/* file defindex.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Toplevel definition index on a synthetic corpus (size in MB given by benchmark arg):
+ * - BM_defindex_scan: defindexer::scan() (no expressions built)
+ * - BM_defindex_parse: reader::read_all(),  for comparison
+ * - BM_defindex_find: defindex::find() on an index file,
+ *   for a corpus of distinctly-named definitions
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/defindex.hpp"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <unistd.h>
+
+namespace xo {
+    using xo::scm::defindexer;
+    using xo::scm::defindex;
+
+    namespace bench {
+        namespace {
+            std::string
+            defindex_corpus(std::size_t n_mb) {
+                std::string block = make_corpus(default_forms(), 1024);
+                std::string retval;
+
+                retval.reserve((n_mb << 20) + block.size());
+
+                while (retval.size() < (n_mb << 20))
+                    retval += block;
+
+                return retval;
+            }
+        }
+
+        static void
+        BM_defindex_scan(benchmark::State & state) {
+            std::string text = defindex_corpus(state.range(0));
+
+            std::size_t n_def = 0;
+
+            for (auto _ : state) {
+                n_def = defindexer::scan(defindexer::span_type(text.data(),
+                                                               text.data() + text.size())).size();
+            }
+
+            state.counters["defs"] = n_def;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        static void
+        BM_defindex_parse(benchmark::State & state) {
+            std::string text = defindex_corpus(state.range(0));
+
+            std::size_t n_expr = 0;
+
+            for (auto _ : state)
+                n_expr = read_all(text);
+
+            state.counters["exprs"] = n_expr;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        static void
+        BM_defindex_find(benchmark::State & state) {
+            std::string text;
+            std::size_t n_def = 0;
+
+            while (text.size() < (std::size_t(state.range(0)) << 20))
+                text += "def f" + std::to_string(n_def++) + " : f64 = 1.0;\n";
+
+            std::string target = "f" + std::to_string(n_def / 2);
+
+            std::string path
+                = (std::filesystem::temp_directory_path()
+                   / ("xo_defindex_bench_" + std::to_string(::getpid()) + ".defix")).string();
+
+            defindexer::write(path,
+                              defindexer::scan(defindexer::span_type(text.data(),
+                                                                     text.data() + text.size())));
+
+            defindex ix = defindex::open(path);
+            std::size_t n_found = 0;
+
+            for (auto _ : state) {
+                n_found = ix.find(target).size();
+                benchmark::DoNotOptimize(n_found);
+            }
+
+            state.counters["entries"] = ix.size();
+            state.counters["found"] = n_found;
+
+            std::filesystem::remove(path);
+        }
+
+        BENCHMARK(BM_defindex_scan)->Arg(16)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_defindex_parse)->Arg(16)->Iterations(1)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_defindex_find)->Arg(16);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end defindex.bench.cpp */
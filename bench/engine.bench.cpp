@@ -0,0 +1,71 @@
+/* file engine.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Reader throughput for each parserengine:
+ * - virtual_dispatch: pooled heap exprstates + virtual calls
+ * - variant_dispatch: inline std::variant exprstates + std::visit
+ *
+ * Paren-heavy corpus stresses push/pop + dispatch,
+ * since each '(' costs two exprstates (paren_xs, expect_expr_xs)
+ */
+
+#include "readbench.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::parserengine;
+
+    namespace bench {
+        namespace {
+            /* corpus with deeply nested parens */
+            const std::vector<const char *> &
+            nested_forms() {
+                static std::vector<const char *> s_form_v = {
+                    "def a = ((((2.0 * 3.0))));\n",
+                    "def b = (((((((1.0 + 2.0)))))));\n",
+                    "def c = lambda (x : f64) ((((x))));\n",
+                };
+
+                return s_form_v;
+            }
+
+            void
+            run_engine(benchmark::State & state,
+                       const std::vector<const char *> & form_v,
+                       parserengine engine)
+            {
+                state.SetLabel(parserengine_descr(engine));
+
+                run_corpus(state, make_corpus(form_v, state.range(0)), engine);
+            }
+        }
+
+        static void
+        BM_engine_virtual(benchmark::State & state) {
+            run_engine(state, default_forms(), parserengine::virtual_dispatch);
+        }
+
+        static void
+        BM_engine_variant(benchmark::State & state) {
+            run_engine(state, default_forms(), parserengine::variant_dispatch);
+        }
+
+        static void
+        BM_engine_virtual_nested(benchmark::State & state) {
+            run_engine(state, nested_forms(), parserengine::virtual_dispatch);
+        }
+
+        static void
+        BM_engine_variant_nested(benchmark::State & state) {
+            run_engine(state, nested_forms(), parserengine::variant_dispatch);
+        }
+
+        BENCHMARK(BM_engine_virtual)->Arg(10000);
+        BENCHMARK(BM_engine_variant)->Arg(10000);
+        BENCHMARK(BM_engine_virtual_nested)->Arg(10000);
+        BENCHMARK(BM_engine_variant_nested)->Arg(10000);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end engine.bench.cpp */
@@ -0,0 +1,146 @@
+/* file file.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Reading a large translation unit from disk:
+ * - BM_file_mmap: reader::read_file(), whole file mapped as one span
+ * - BM_file_chunked: read(2) into a fixed buffer,  reader::read_all() per chunk
+ *
+ * Both read the same synthetic file (size in MB given by benchmark arg);
+ * file is written once, on first use, and removed at exit.
+ * Second and later passes run from page cache.
+ */
+
+#include "readbench.hpp"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xo {
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+
+    namespace bench {
+        namespace {
+            /* synthetic source files,  by size in MB */
+            class corpus_files {
+            public:
+                ~corpus_files() {
+                    for (const auto & ix : path_map_)
+                        std::filesystem::remove(ix.second);
+                }
+
+                const std::string & require(std::size_t n_mb) {
+                    auto ix = path_map_.find(n_mb);
+
+                    if (ix != path_map_.end())
+                        return ix->second;
+
+                    std::string path
+                        = (std::filesystem::temp_directory_path()
+                           / ("xo_reader_bench_" + std::to_string(::getpid())
+                              + "_" + std::to_string(n_mb) + "mb.scm")).string();
+
+                    /* write in blocks of forms */
+                    std::string block = make_corpus(default_forms(), 1024);
+                    std::size_t z_target = n_mb << 20;
+
+                    std::ofstream ofs(path, std::ios::binary);
+
+                    for (std::size_t z = 0; z < z_target; z += block.size())
+                        ofs.write(block.data(), block.size());
+
+                    return path_map_[n_mb] = path;
+                }
+
+            private:
+                std::map<std::size_t, std::string> path_map_;
+            };
+
+            corpus_files s_corpus_files;
+
+            /* no-op sink;  keeps each expression alive until delivered */
+            void
+            discard(reader_result && rr) {
+                benchmark::DoNotOptimize(rr.expr_);
+            }
+
+            /* read file at @p path in chunks of @p z_chunk bytes */
+            std::size_t
+            read_chunked(const std::string & path, std::size_t z_chunk) {
+                int fd = ::open(path.c_str(), O_RDONLY);
+
+                if (fd < 0)
+                    throw std::runtime_error("read_chunked: open failed");
+
+                std::vector<char> buf(z_chunk);
+
+                reader rdr;
+                rdr.begin_translation_unit();
+
+                std::size_t n_expr = 0;
+
+                for (;;) {
+                    ssize_t n = ::read(fd, buf.data(), buf.size());
+
+                    if (n < 0) {
+                        ::close(fd);
+                        throw std::runtime_error("read_chunked: read failed");
+                    }
+
+                    bool eof = (n == 0);
+
+                    n_expr += rdr.read_all(reader::span_type(buf.data(), buf.data() + n),
+                                           eof, discard);
+
+                    if (eof)
+                        break;
+                }
+
+                ::close(fd);
+
+                return n_expr;
+            }
+
+            void
+            report(benchmark::State & state, const std::string & path, std::size_t n_expr) {
+                state.counters["exprs"] = n_expr;
+                state.SetBytesProcessed(std::filesystem::file_size(path) * state.iterations());
+            }
+        }
+
+        static void
+        BM_file_mmap(benchmark::State & state) {
+            const std::string & path = s_corpus_files.require(state.range(0));
+
+            std::size_t n_expr = 0;
+
+            for (auto _ : state) {
+                reader rdr;
+                n_expr = rdr.read_file(path, discard);
+            }
+
+            report(state, path, n_expr);
+        }
+
+        static void
+        BM_file_chunked(benchmark::State & state) {
+            const std::string & path = s_corpus_files.require(state.range(0));
+
+            std::size_t n_expr = 0;
+
+            for (auto _ : state)
+                n_expr = read_chunked(path, 64 * 1024);
+
+            report(state, path, n_expr);
+        }
+
+        BENCHMARK(BM_file_mmap)->Arg(100)->Iterations(2)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_file_chunked)->Arg(100)->Iterations(2)->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end file.bench.cpp */
@@ -0,0 +1,86 @@
+/* file incremental.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Re-reading an edited translation unit (#of forms given by benchmark arg):
+ * - BM_incremental_reread: incrementalreader::read() after editing one form
+ * - BM_incremental_full: reader::read_all() on the same input,  for comparison
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/incrementalreader.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::incrementalreader;
+
+    namespace bench {
+        namespace {
+            /* @p n_form distinctly-named definitions;
+             * definition number @p edit_ix has value @p value
+             */
+            std::string
+            incremental_corpus(std::size_t n_form, std::size_t edit_ix, const char * value) {
+                std::string retval;
+
+                for (std::size_t i = 0; i < n_form; ++i) {
+                    std::string name = "f" + std::to_string(i);
+
+                    if (i % 2 == 0)
+                        retval += "def " + name + " : f64 = " + ((i == edit_ix) ? value : "1.0") + ";\n";
+                    else
+                        retval += "def " + name + " = lambda (x : f64, y : f64) x * y;\n";
+                }
+
+                return retval;
+            }
+        }
+
+        static void
+        BM_incremental_reread(benchmark::State & state) {
+            std::size_t n_form = state.range(0);
+
+            /* alternate between two versions,  so each read sees one edited form */
+            std::string text[2] = { incremental_corpus(n_form, n_form / 2, "1.0"),
+                                    incremental_corpus(n_form, n_form / 2, "2.0") };
+
+            incrementalreader ird;
+            ird.read(incrementalreader::span_type(text[0].data(), text[0].data() + text[0].size()));
+
+            std::size_t i = 1;
+            std::size_t n_reparsed = 0;
+
+            for (auto _ : state) {
+                const std::string & s = text[i++ % 2];
+
+                auto result_v = ird.read(incrementalreader::span_type(s.data(), s.data() + s.size()));
+
+                benchmark::DoNotOptimize(result_v.data());
+
+                n_reparsed = ird.last_stats().n_changed_ + ird.last_stats().n_invalidated_;
+            }
+
+            state.counters["forms"] = n_form;
+            state.counters["reparsed"] = n_reparsed;
+            state.SetBytesProcessed(text[0].size() * state.iterations());
+        }
+
+        static void
+        BM_incremental_full(benchmark::State & state) {
+            std::size_t n_form = state.range(0);
+
+            std::string text = incremental_corpus(n_form, n_form / 2, "2.0");
+
+            for (auto _ : state)
+                read_all(text);
+
+            state.counters["forms"] = n_form;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        BENCHMARK(BM_incremental_reread)->Arg(50000)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_incremental_full)->Arg(50000)->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end incremental.bench.cpp */
@@ -0,0 +1,97 @@
+/* file lazy.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Loading a library of functions with block bodies (#of functions given by benchmark arg):
+ * - BM_lazy_off: every body parsed at load
+ * - BM_lazy_on: bodies skipped by brace matching,  kept as LazyLambda
+ * - BM_lazy_force: lazy load,  then force every body
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/lazylambda.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+    using xo::scm::LazyLambda;
+    using xo::ast::DefineExpr;
+
+    namespace bench {
+        namespace {
+            std::string
+            library_corpus(std::size_t n_fn) {
+                static const std::vector<const char *> s_form_v = {
+                    "def f = lambda (x : f64, y : f64) {\n"
+                    "  def a = x * y;\n"
+                    "  def b = a * x;\n"
+                    "  def c = b * y;\n"
+                    "  def d = c * a;\n"
+                    "  d;\n"
+                    "};\n",
+                    "def g = lambda (x : f64) { def s = x * x; def t = s * s; t; };\n",
+                };
+
+                return make_corpus(s_form_v, n_fn);
+            }
+
+            /* read @p text,  keeping results;  force lazy bodies iff @p force */
+            std::size_t
+            load(const std::string & text, bool lazy, bool force) {
+                std::vector<reader_result> result_v;
+
+                reader rdr;
+                rdr.enable_lazy_lambda(lazy);
+                rdr.begin_translation_unit();
+                rdr.read_all(reader::span_type(text.data(), text.data() + text.size()),
+                             true /*eof*/, &result_v);
+
+                if (force) {
+                    for (const auto & rr : result_v) {
+                        auto lz = LazyLambda::from(DefineExpr::from(rr.expr_)->rhs());
+
+                        if (lz)
+                            benchmark::DoNotOptimize(lz->force());
+                    }
+                }
+
+                return result_v.size();
+            }
+
+            void
+            run_load(benchmark::State & state, bool lazy, bool force) {
+                std::string text = library_corpus(state.range(0));
+                std::size_t n_expr = 0;
+
+                for (auto _ : state)
+                    n_expr = load(text, lazy, force);
+
+                state.counters["exprs"] = n_expr;
+                state.SetBytesProcessed(text.size() * state.iterations());
+            }
+        }
+
+        static void
+        BM_lazy_off(benchmark::State & state) {
+            run_load(state, false /*!lazy*/, false /*!force*/);
+        }
+
+        static void
+        BM_lazy_on(benchmark::State & state) {
+            run_load(state, true /*lazy*/, false /*!force*/);
+        }
+
+        static void
+        BM_lazy_force(benchmark::State & state) {
+            run_load(state, true /*lazy*/, true /*force*/);
+        }
+
+        BENCHMARK(BM_lazy_off)->Arg(10000)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_lazy_on)->Arg(10000)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_lazy_force)->Arg(10000)->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end lazy.bench.cpp */
@@ -0,0 +1,41 @@
+/* file logging.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Reader throughput with debug logging compiled in vs. compiled out.
+ * Logging mode is fixed when xo_reader is built,  so compare by building twice:
+ *
+ *   $ cmake -DENABLE_BENCHMARKS=on -DXO_READER_ENABLE_LOGGING=on  -B .build-log
+ *   $ cmake -DENABLE_BENCHMARKS=on -DXO_READER_ENABLE_LOGGING=off -B .build-nolog
+ *
+ * and compare the tokens/s column from bench.reader in each.
+ * Active mode is reported in benchmark context as xo_reader.logging
+ * (see reader_bench_main.cpp)
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/logpolicy.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::logpolicy;
+
+    namespace bench {
+        /* logging as configured at build time;  runtime verbosity 0.
+         * With XO_READER_LOGGING=1 this measures scope setup + argument
+         * evaluation that runs even when nothing prints.
+         */
+        static void
+        BM_read_logging_silent(benchmark::State & state) {
+            logpolicy::set_verbosity_all(0);
+
+            run_corpus(state, make_corpus(default_forms(), state.range(0)));
+
+            logpolicy::set_verbosity_all(1);
+        }
+
+        BENCHMARK(BM_read_logging_silent)->Arg(100)->Arg(10000);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end logging.bench.cpp */
@@ -0,0 +1,64 @@
+/* file parallel.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Many small translation units (startup-style load),
+ * read by a parallelreader with 1, 2, 4, 8 threads.
+ * Compare against 1 thread for scaling
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/parallelreader.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::parallelreader;
+
+    namespace bench {
+        namespace {
+            /* 2000 inputs of 40 forms each */
+            const std::vector<std::string> &
+            unit_texts() {
+                static std::vector<std::string> s_text_v;
+
+                if (s_text_v.empty()) {
+                    for (std::size_t i = 0; i < 2000; ++i)
+                        s_text_v.push_back(make_corpus(default_forms(), 40));
+                }
+
+                return s_text_v;
+            }
+        }
+
+        static void
+        BM_parallel_units(benchmark::State & state) {
+            const auto & text_v = unit_texts();
+
+            std::vector<parallelreader::span_type> input_v;
+            std::size_t z = 0;
+
+            for (const auto & text : text_v) {
+                input_v.push_back(parallelreader::span_type(text.data(),
+                                                            text.data() + text.size()));
+                z += text.size();
+            }
+
+            parallelreader prdr(state.range(0));
+
+            for (auto _ : state) {
+                auto res_v = prdr.read_buffers(input_v);
+                benchmark::DoNotOptimize(res_v);
+            }
+
+            state.counters["units/s"]
+                = benchmark::Counter(input_v.size() * state.iterations(),
+                                     benchmark::Counter::kIsRate);
+            state.SetBytesProcessed(z * state.iterations());
+        }
+
+        BENCHMARK(BM_parallel_units)->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+            ->UseRealTime()->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end parallel.bench.cpp */
@@ -0,0 +1,99 @@
+/* file pipeline.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Large in-memory translation unit (size in MB given by benchmark arg):
+ * - BM_pipeline_serial: reader::read_all(),  tokenize + parse on one thread
+ * - BM_pipeline_2thread: pipelinereader,  tokenizer on a helper thread
+ *
+ * Pipeline reports per-stage throughput (tokens per busy second)
+ * and token-ring occupancy/stall counts from the last pass
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/pipelinereader.hpp"
+#include <map>
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+    using xo::scm::pipelinereader;
+
+    namespace bench {
+        namespace {
+            /* corpus of at least @p n_mb megabytes */
+            const std::string &
+            large_corpus(std::size_t n_mb) {
+                static std::map<std::size_t, std::string> s_corpus_map;
+
+                std::string & retval = s_corpus_map[n_mb];
+
+                if (retval.empty()) {
+                    std::string block = make_corpus(default_forms(), 1024);
+                    std::size_t z_target = n_mb << 20;
+
+                    retval.reserve(z_target + block.size());
+
+                    while (retval.size() < z_target)
+                        retval += block;
+                }
+
+                return retval;
+            }
+
+            void
+            discard(reader_result && rr) {
+                benchmark::DoNotOptimize(rr.expr_);
+            }
+        }
+
+        static void
+        BM_pipeline_serial(benchmark::State & state) {
+            const std::string & text = large_corpus(state.range(0));
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            std::size_t n_expr = 0;
+
+            for (auto _ : state) {
+                reader rdr;
+                rdr.begin_translation_unit();
+
+                n_expr = rdr.read_all(input, true /*eof*/, discard);
+            }
+
+            state.counters["exprs"] = n_expr;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        static void
+        BM_pipeline_2thread(benchmark::State & state) {
+            const std::string & text = large_corpus(state.range(0));
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            pipelinereader prdr;
+            std::size_t n_expr = 0;
+
+            for (auto _ : state)
+                n_expr = prdr.read_all(input, discard);
+
+            const auto & stats = prdr.stats();
+
+            state.counters["exprs"] = n_expr;
+            state.counters["tokenize_tok/s"]
+                = stats.n_token_ / (1e-9 * stats.tokenize_busy_ns_);
+            state.counters["parse_tok/s"]
+                = stats.n_token_ / (1e-9 * stats.parse_busy_ns_);
+            state.counters["mean_occupancy"] = stats.mean_occupancy();
+            state.counters["max_occupancy"] = stats.occupancy_max_;
+            state.counters["producer_stalls"] = stats.n_producer_stall_;
+            state.counters["consumer_stalls"] = stats.n_consumer_stall_;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        BENCHMARK(BM_pipeline_serial)->Arg(64)->Arg(256)->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_pipeline_2thread)->Arg(64)->Arg(256)->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end pipeline.bench.cpp */
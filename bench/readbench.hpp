@@ -0,0 +1,232 @@
+/* file readbench.hpp
+ *
+ * author: Roland Conybeare
+ *
+ * Helpers shared by reader benchmarks
+ */
+
+#pragma once
+
+#include "xo/reader/reader.hpp"
+#include "xo/reader/readerperf.hpp"
+#include "xo/reader/allocaccount.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace xo {
+    namespace bench {
+        /* toplevel forms the parser handles today */
+        inline const std::vector<const char *> &
+        default_forms() {
+            static std::vector<const char *> s_form_v = {
+                "def foo : f64 = 3.14159265;\n",
+                "def bar = (2.0 * 3.0);\n",
+                "def sq = lambda (x : f64, y : f64) x;\n",
+            };
+
+            return s_form_v;
+        }
+
+        /* concatenate @p n_form forms,  cycling through @p form_v */
+        inline std::string
+        make_corpus(const std::vector<const char *> & form_v, std::size_t n_form) {
+            std::string retval;
+
+            for (std::size_t i = 0; i < n_form; ++i)
+                retval += form_v[i % form_v.size()];
+
+            return retval;
+        }
+
+        /* number of tokens in @p text */
+        inline std::size_t
+        count_tokens(const std::string & text) {
+            using xo::scm::reader;
+
+            reader::tokenizer_type tkz;
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+            std::size_t n = 0;
+
+            while (!input.empty()) {
+                auto sr = tkz.scan2(input, true /*eof*/);
+
+                if (sr.first.is_valid())
+                    ++n;
+
+                input = input.after_prefix(sr.second);
+            }
+
+            return n;
+        }
+
+        /* max parser stack size seen while reading @p text,
+         * sampled after each token
+         */
+        inline std::size_t
+        peak_stack_depth(const std::string & text,
+                         xo::scm::parserengine engine = xo::scm::parserengine::virtual_dispatch)
+        {
+            using xo::scm::reader;
+            using xo::scm::parser;
+
+            reader::tokenizer_type tkz;
+            parser psr(engine);
+            psr.begin_translation_unit();
+
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+            std::size_t retval = 0;
+
+            while (!input.empty()) {
+                auto sr = tkz.scan2(input, true /*eof*/);
+
+                if (sr.first.is_valid()) {
+                    psr.include_token(sr.first);
+                    psr.clear_varrefs();
+
+                    retval = std::max(retval, psr.stack_size());
+                }
+
+                input = input.after_prefix(sr.second);
+            }
+
+            return retval;
+        }
+
+        /* read all expressions in @p text,  return #of expressions */
+        inline std::size_t
+        read_all(const std::string & text,
+                 xo::scm::parserengine engine = xo::scm::parserengine::virtual_dispatch)
+        {
+            using xo::scm::reader;
+
+            reader rdr(engine);
+            rdr.begin_translation_unit();
+
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            std::size_t n_expr
+                = rdr.read_all(input, true /*eof*/,
+                               [](xo::scm::reader_result && rr)
+                                   {
+                                       benchmark::DoNotOptimize(rr.expr_);
+                                   });
+
+            return n_expr;
+        }
+
+        /* untimed pass over @p text with hardware counters attached;
+         * report IPC for tokenizer and parser,  and misses per token.
+         * Reports nothing if counters unavailable
+         */
+        inline void
+        report_perf(benchmark::State & state,
+                    const std::string & text,
+                    xo::scm::parserengine engine = xo::scm::parserengine::virtual_dispatch)
+        {
+            using xo::scm::reader;
+            using xo::scm::readerperf;
+            using xo::scm::readerphase;
+            using xo::scm::perfevent;
+            using xo::scm::perfsample;
+
+            readerperf perf;
+
+            if (!perf.available())
+                return;
+
+            reader rdr(engine);
+            rdr.attach_readerperf(&perf);
+            rdr.begin_translation_unit();
+            rdr.read_all(reader::span_type(text.data(), text.data() + text.size()),
+                         true /*eof*/,
+                         [](xo::scm::reader_result && rr)
+                             {
+                                 benchmark::DoNotOptimize(rr.expr_);
+                             });
+
+            const perfsample & tk = perf.phase(readerphase::tokenize);
+            const perfsample & ps = perf.phase(readerphase::parse);
+
+            perfsample total = tk;
+            total += ps;
+
+            double n_token = perf.n_token() ? double(perf.n_token()) : 1.0;
+
+            state.counters["tk_ipc"] = tk.ipc();
+            state.counters["parse_ipc"] = ps.ipc();
+            state.counters["br_miss/tk"] = double(total[perfevent::branch_misses]) / n_token;
+            state.counters["l1d_miss/tk"] = double(total[perfevent::l1d_misses]) / n_token;
+            state.counters["llc_miss/tk"] = double(total[perfevent::llc_misses]) / n_token;
+        }
+
+        /* untimed pass over @p text with an allocaccount attached;
+         * report bytes per toplevel expression for each alloccategory
+         */
+        inline void
+        report_alloc(benchmark::State & state,
+                     const std::string & text,
+                     xo::scm::parserengine engine = xo::scm::parserengine::virtual_dispatch)
+        {
+            using xo::scm::reader;
+            using xo::scm::allocaccount;
+            using xo::scm::alloccategory;
+            using xo::scm::allocstats;
+
+            allocaccount acct;
+            std::size_t n_expr = 0;
+
+            {
+                reader rdr(engine);
+                rdr.attach_allocaccount(&acct);
+                rdr.begin_translation_unit();
+                rdr.read_all(reader::span_type(text.data(), text.data() + text.size()),
+                             true /*eof*/,
+                             [&n_expr](xo::scm::reader_result && rr)
+                                 {
+                                     ++n_expr;
+                                     benchmark::DoNotOptimize(rr.expr_);
+                                 });
+            }
+
+            const allocstats & s = acct.current();
+            double n = n_expr ? double(n_expr) : 1.0;
+
+            for (std::size_t i = 0; i < allocstats::c_n_category; ++i) {
+                alloccategory c = static_cast<alloccategory>(i);
+
+                state.counters[std::string(alloccategory_descr(c)) + " B/expr"]
+                    = double(s.n_byte(c)) / n;
+            }
+        }
+
+        /* benchmark loop: read @p text with @p engine,
+         * report tokens/s, bytes/s and #of expressions per pass,
+         * along with hardware counters (see report_perf)
+         */
+        inline void
+        run_corpus(benchmark::State & state,
+                   const std::string & text,
+                   xo::scm::parserengine engine = xo::scm::parserengine::virtual_dispatch)
+        {
+            std::size_t n_token = count_tokens(text);
+            std::size_t n_expr = 0;
+
+            for (auto _ : state) {
+                n_expr = read_all(text, engine);
+                benchmark::DoNotOptimize(n_expr);
+            }
+
+            state.counters["tokens/s"]
+                = benchmark::Counter(n_token * state.iterations(),
+                                     benchmark::Counter::kIsRate);
+            state.counters["exprs"] = n_expr;
+            state.SetBytesProcessed(text.size() * state.iterations());
+
+            report_perf(state, text, engine);
+        }
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end readbench.hpp */
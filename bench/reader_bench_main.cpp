@@ -0,0 +1,33 @@
+/* file reader_bench_main.cpp */
+
+#include "xo/reader/logpolicy.hpp"
+#include "xo/reader/readerperf.hpp"
+#include <benchmark/benchmark.h>
+
+int
+main(int argc, char ** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    /* logging mode is fixed when xo_reader is built;
+     * report it so results from different builds can be told apart
+     */
+    benchmark::AddCustomContext("xo_reader.logging",
+                                xo::scm::logpolicy::c_logging_enabled ? "on" : "off");
+
+    /* without counters (e.g. perf_event_paranoid, VM without PMU)
+     * rows omit tk_ipc, parse_ipc and the misses-per-token columns
+     */
+    benchmark::AddCustomContext("xo_reader.perf_counters",
+                                xo::scm::perfcounters().available() ? "on" : "off");
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+/* end reader_bench_main.cpp */
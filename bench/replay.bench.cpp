@@ -0,0 +1,101 @@
+/* file replay.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Parser cost without tokenizer,  on ~1MB corpora from @ref corpusgen
+ * (shape parameter given by benchmark arg):
+ * - BM_replay_*: tokenreplay::replay() of a recording into a fresh parser
+ * - BM_replay_*_read: reader::read_all() on the same text,  for comparison
+ */
+
+#include "readbench.hpp"
+#include "corpusgen.hpp"
+#include "xo/reader/tokenrecord.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::tokenrecorder;
+    using xo::scm::tokenreplay;
+    using xo::scm::reader;
+    using xo::scm::parser;
+
+    namespace bench {
+        namespace {
+            constexpr std::size_t c_corpus_bytes = 1024 * 1024;
+
+            tokenreplay
+            record_corpus(const std::string & text) {
+                tokenrecorder rec;
+
+                reader rdr;
+                rdr.attach_tokenrecorder(&rec);
+                rdr.begin_translation_unit();
+                rdr.read_all(reader::span_type(text.data(), text.data() + text.size()),
+                             true /*eof*/,
+                             [](xo::scm::reader_result &&) {});
+
+                return tokenreplay::from_image(rec.image());
+            }
+
+            void
+            run_replay(benchmark::State & state, corpusshape shape) {
+                std::string text = corpusgen(shape, state.range(0)).generate(c_corpus_bytes);
+                tokenreplay tr = record_corpus(text);
+
+                std::size_t n_expr = 0;
+
+                for (auto _ : state) {
+                    parser psr;
+
+                    n_expr = tr.replay(&psr,
+                                       [](rp<xo::ast::Expression> x)
+                                           {
+                                               benchmark::DoNotOptimize(x);
+                                           });
+                }
+
+                state.SetLabel(corpusshape_descr(shape));
+                state.counters["tokens/s"]
+                    = benchmark::Counter(tr.size() * state.iterations(),
+                                         benchmark::Counter::kIsRate);
+                state.counters["exprs"] = n_expr;
+            }
+
+            void
+            run_read(benchmark::State & state, corpusshape shape) {
+                std::string text = corpusgen(shape, state.range(0)).generate(c_corpus_bytes);
+
+                state.SetLabel(corpusshape_descr(shape));
+
+                run_corpus(state, text);
+            }
+        }
+
+        static void
+        BM_replay_infix(benchmark::State & state) {
+            run_replay(state, corpusshape::infix_chain);
+        }
+
+        static void
+        BM_replay_infix_read(benchmark::State & state) {
+            run_read(state, corpusshape::infix_chain);
+        }
+
+        static void
+        BM_replay_block(benchmark::State & state) {
+            run_replay(state, corpusshape::block_defs);
+        }
+
+        static void
+        BM_replay_block_read(benchmark::State & state) {
+            run_read(state, corpusshape::block_defs);
+        }
+
+        BENCHMARK(BM_replay_infix)->Arg(16);
+        BENCHMARK(BM_replay_infix_read)->Arg(16);
+        BENCHMARK(BM_replay_block)->Arg(16);
+        BENCHMARK(BM_replay_block_read)->Arg(16);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end replay.bench.cpp */
@@ -0,0 +1,103 @@
+/* file split.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * One large translation unit (size in MB given by first benchmark arg):
+ * - BM_split_serial: reader::read_all()
+ * - BM_split_parallel: parallelreader::read_split(),
+ *   with #of threads given by second benchmark arg
+ *
+ * Both retain all results,  like a loader would
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/parallelreader.hpp"
+#include "xo/reader/segmenter.hpp"
+#include <benchmark/benchmark.h>
+
+namespace xo {
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+    using xo::scm::parallelreader;
+    using xo::scm::segmenter;
+
+    namespace bench {
+        namespace {
+            std::string
+            split_corpus(std::size_t n_mb) {
+                std::string block = make_corpus(default_forms(), 1024);
+                std::string retval;
+
+                retval.reserve((n_mb << 20) + block.size());
+
+                while (retval.size() < (n_mb << 20))
+                    retval += block;
+
+                return retval;
+            }
+        }
+
+        static void
+        BM_split_serial(benchmark::State & state) {
+            std::string text = split_corpus(state.range(0));
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            std::size_t n_expr = 0;
+
+            for (auto _ : state) {
+                std::vector<reader_result> result_v;
+
+                reader rdr;
+                rdr.begin_translation_unit();
+                rdr.read_all(input, true /*eof*/, &result_v);
+
+                n_expr = result_v.size();
+            }
+
+            state.counters["exprs"] = n_expr;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        static void
+        BM_split_parallel(benchmark::State & state) {
+            std::string text = split_corpus(state.range(0));
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            parallelreader prdr(state.range(1));
+            std::size_t n_expr = 0;
+
+            for (auto _ : state) {
+                auto res = prdr.read_split(input);
+
+                n_expr = res.result_v_.size();
+            }
+
+            state.counters["exprs"] = n_expr;
+            state.counters["segments"] = prdr.last_split_stats().n_segment_;
+            state.counters["reparsed"] = prdr.last_split_stats().n_reparse_;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        /* cost of the pre-scan alone */
+        static void
+        BM_split_prescan(benchmark::State & state) {
+            std::string text = split_corpus(state.range(0));
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            for (auto _ : state) {
+                auto cut_v = segmenter::split(input, 64);
+                benchmark::DoNotOptimize(cut_v);
+            }
+
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        BENCHMARK(BM_split_serial)->Args({16, 1})
+            ->UseRealTime()->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_split_parallel)->Args({16, 1})->Args({16, 4})
+            ->UseRealTime()->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_split_prescan)->Arg(16)->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end split.bench.cpp */
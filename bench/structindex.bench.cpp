@@ -0,0 +1,105 @@
+/* file structindex.bench.cpp
+ *
+ * author: Roland Conybeare
+ *
+ * Structural index throughput on a synthetic corpus (size in MB given by benchmark arg):
+ * - BM_structindex_{scalar,sse2,avx2}: structscanner at each simdlevel,
+ *   in 16KB pieces,  like segmenter::split
+ * - BM_structindex_tokenize: tokenizer alone over same input,  for scale
+ */
+
+#include "readbench.hpp"
+#include "xo/reader/structindex.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+
+namespace xo {
+    using xo::scm::structindex;
+    using xo::scm::structscanner;
+    using xo::scm::simdlevel;
+
+    namespace bench {
+        namespace {
+            std::string
+            structindex_corpus(std::size_t n_mb) {
+                std::string block = make_corpus(default_forms(), 1024);
+                std::string retval;
+
+                retval.reserve((n_mb << 20) + block.size());
+
+                while (retval.size() < (n_mb << 20))
+                    retval += block;
+
+                return retval;
+            }
+
+            void
+            run_structindex(benchmark::State & state, simdlevel level) {
+                constexpr std::size_t c_piece_size = 256 * structscanner::c_block_size;
+
+                std::string text = structindex_corpus(state.range(0));
+
+                structscanner scanner(level);
+                structindex index;
+                std::size_t n_struct = 0;
+
+                for (auto _ : state) {
+                    scanner.reset();
+                    n_struct = 0;
+
+                    for (std::size_t lo = 0; lo < text.size(); lo += c_piece_size) {
+                        std::size_t hi = std::min(lo + c_piece_size, text.size());
+
+                        index.clear();
+                        scanner.scan(structscanner::span_type(text.data() + lo, text.data() + hi),
+                                     &index);
+                        n_struct += index.size();
+                    }
+
+                    benchmark::DoNotOptimize(n_struct);
+                }
+
+                state.SetLabel(simdlevel_descr(scanner.level()));
+                state.counters["structurals"] = n_struct;
+                state.SetBytesProcessed(text.size() * state.iterations());
+            }
+        }
+
+        static void
+        BM_structindex_scalar(benchmark::State & state) {
+            run_structindex(state, simdlevel::scalar);
+        }
+
+        static void
+        BM_structindex_sse2(benchmark::State & state) {
+            run_structindex(state, simdlevel::sse2);
+        }
+
+        static void
+        BM_structindex_avx2(benchmark::State & state) {
+            run_structindex(state, simdlevel::avx2);
+        }
+
+        static void
+        BM_structindex_tokenize(benchmark::State & state) {
+            std::string text = structindex_corpus(state.range(0));
+
+            std::size_t n_token = 0;
+
+            for (auto _ : state) {
+                n_token = count_tokens(text);
+                benchmark::DoNotOptimize(n_token);
+            }
+
+            state.counters["tokens"] = n_token;
+            state.SetBytesProcessed(text.size() * state.iterations());
+        }
+
+        BENCHMARK(BM_structindex_scalar)->Arg(64)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_structindex_sse2)->Arg(64)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_structindex_avx2)->Arg(64)->Unit(benchmark::kMillisecond);
+        BENCHMARK(BM_structindex_tokenize)->Arg(64)->Unit(benchmark::kMillisecond);
+    } /*namespace bench*/
+} /*namespace xo*/
+
+/* end structindex.bench.cpp */
@@ -0,0 +1,208 @@
+/* file allocaccount.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include <memory_resource>
+#include <array>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** reader allocations,  by origin.
+         *
+         *  Only @c exprstate is measured:  that memory is owned by the reader,
+         *  and comes from a @ref countingresource.  The other categories
+         *  are estimates,  reported with allocaccount::note where the reader
+         *  causes an allocation inside a type owned by another library
+         *  (tokenizer, xo::ast),  using sizes visible to the reader.
+         **/
+        enum class alloccategory {
+            /** estimate:  token text (std::string) too long for small-string storage,
+             *  charged as string capacity
+             **/
+            token_text,
+            /** measured:  each exprstate (virtual_dispatch engine;  served from
+             *  exprstatepool,  charged per state),  stack segments
+             *  (variant_dispatch engine,  which stores states inline),
+             *  and contents of open blocks and infix expressions
+             *  (chunks of @ref cowvector)
+             **/
+            exprstate,
+            /** estimate:  formal lists of pushed envframes,  and the frame
+             *  list kept by each lazy lambda (frame contents are shared)
+             **/
+            envframe,
+            /** estimate:  formal-list copies in lambda_xs::argl_ **/
+            lambda_argl,
+            /** estimate:  AST nodes (rp<Expression>) built by the parser,
+             *  charged as size of node object;  for an operator application
+             *  also its argument vector,  and its primitive (as sizeof(Expression),
+             *  a lower bound).  Storage owned by nodes beyond that is not seen
+             **/
+            expression,
+
+            n_alloccategory
+        };
+
+        extern const char *
+        alloccategory_descr(alloccategory x);
+
+        inline std::ostream &
+        operator<< (std::ostream & os, alloccategory x) {
+            os << alloccategory_descr(x);
+            return os;
+        }
+
+        /** @class allocstats
+         *  @brief allocation counts and bytes,  per @ref alloccategory
+         **/
+        struct allocstats {
+            static constexpr std::size_t c_n_category
+                = static_cast<std::size_t>(alloccategory::n_alloccategory);
+
+            std::uint64_t n_alloc(alloccategory x) const { return n_alloc_v_[static_cast<std::size_t>(x)]; }
+            std::uint64_t n_byte(alloccategory x) const { return n_byte_v_[static_cast<std::size_t>(x)]; }
+
+            /** true iff nothing counted **/
+            bool empty() const;
+
+            void print(std::ostream & os) const;
+
+            /** #of allocations,  indexed by alloccategory **/
+            std::array<std::uint64_t, c_n_category> n_alloc_v_ = {};
+            /** #of bytes allocated,  indexed by alloccategory **/
+            std::array<std::uint64_t, c_n_category> n_byte_v_ = {};
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const allocstats & x) {
+            x.print(os);
+            return os;
+        }
+
+        class allocaccount;
+
+        /** @class countingresource
+         *  @brief std::pmr::memory_resource that charges each allocation
+         *         to one category of an @ref allocaccount (if any),
+         *         then forwards to an upstream resource
+         *
+         *  Deallocation never touches the account,  so memory from
+         *  a countingresource may be freed after its account is gone.
+         **/
+        class countingresource : public std::pmr::memory_resource {
+        public:
+            countingresource(allocaccount * account,
+                             alloccategory category,
+                             std::pmr::memory_resource * upstream)
+                : account_{account}, category_{category}, upstream_{upstream} {}
+
+            /** charge future allocations to @p account (nullptr: don't count) **/
+            void set_account(allocaccount * account) { account_ = account; }
+
+        private:
+            void * do_allocate(std::size_t z, std::size_t align) override;
+            void do_deallocate(void * p, std::size_t z, std::size_t align) override;
+            bool do_is_equal(const std::pmr::memory_resource & x) const noexcept override;
+
+        private:
+            allocaccount * account_ = nullptr;
+            alloccategory category_;
+            std::pmr::memory_resource * upstream_ = nullptr;
+        };
+
+        /** @class allocaccount
+         *  @brief where reader allocations come from,  per translation unit
+         *
+         *  Attach with reader::attach_allocaccount (or parser::attach_allocaccount).
+         *  Allocations reach the account two ways:
+         *  - memory the reader owns (exprstates,  their vectors,
+         *    variant stack segments) comes from counting memory resources
+         *    owned by the parser,  and is measured;
+         *  - allocations made inside types owned by other libraries
+         *    (token text, std::vector<rp<Variable>>, Expression nodes)
+         *    are estimated,  and reported with @ref note at the point
+         *    the reader causes them.  See @ref alloccategory.
+         *
+         *  Parser-owned resources charge the account only on allocation,
+         *  so an account may be destroyed before the reader,  provided
+         *  no reading happens after that while it is attached.
+         *
+         *  @ref resource gives a counting resource for other uses;
+         *  memory from it must be freed while the account exists.
+         *
+         *  Counts are kept separately for each translation unit,
+         *  see @ref begin_translation_unit.  Not thread-safe.
+         **/
+        class allocaccount {
+        public:
+            explicit allocaccount(std::pmr::memory_resource * upstream
+                                  = std::pmr::new_delete_resource());
+            allocaccount(const allocaccount &) = delete;
+            allocaccount & operator=(const allocaccount &) = delete;
+
+            /** counting memory resource for category @p x **/
+            std::pmr::memory_resource * resource(alloccategory x) {
+                return &resource_v_[static_cast<std::size_t>(x)];
+            }
+
+            /** charge one allocation of @p z bytes to category @p x **/
+            void note(alloccategory x, std::size_t z) {
+                allocstats & s = tu_v_.back();
+                std::size_t i = static_cast<std::size_t>(x);
+
+                ++(s.n_alloc_v_[i]);
+                s.n_byte_v_[i] += z;
+            }
+
+            /** charge heap storage of @p s (if any) to category @p x **/
+            void note_string(alloccategory x, const std::string & s) {
+                if (s.capacity() > c_sso_capacity)
+                    this->note(x, s.capacity() + 1);
+            }
+
+            /** start counting a new translation unit.
+             *  Reader calls this from reader::begin_translation_unit
+             **/
+            void begin_translation_unit();
+
+            /** counts for current translation unit **/
+            const allocstats & current() const { return tu_v_.back(); }
+            /** counts for each translation unit,  oldest first;
+             *  last is current
+             **/
+            const std::vector<allocstats> & tu_v() const { return tu_v_; }
+            /** sum over all translation units **/
+            allocstats total() const;
+
+            /** forget all counts **/
+            void clear();
+
+            void print(std::ostream & os) const;
+
+        private:
+            /** strings up to this length need no heap storage **/
+            static const std::size_t c_sso_capacity;
+
+            /** one resource per category **/
+            std::vector<countingresource> resource_v_;
+            /** per-translation-unit counts;  never empty **/
+            std::vector<allocstats> tu_v_;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const allocaccount & x) {
+            x.print(os);
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end allocaccount.hpp */
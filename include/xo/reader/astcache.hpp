@@ -0,0 +1,95 @@
+/* file astcache.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "reader.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class astcache_stats
+         *  @brief counters for an @ref astcache
+         **/
+        struct astcache_stats {
+            /** number of lookups answered from an image **/
+            std::size_t n_hit_ = 0;
+            /** number of lookups with no usable image **/
+            std::size_t n_miss_ = 0;
+            /** number of images written **/
+            std::size_t n_store_ = 0;
+            /** number of stores skipped because some expression
+             *  has no image form (see @ref astimage)
+             **/
+            std::size_t n_unencodable_ = 0;
+
+            void print(std::ostream & os) const;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const astcache_stats & x) {
+            x.print(os);
+            return os;
+        }
+
+        /** @class astcache
+         *  @brief directory of @ref astimage files,  keyed by source content
+         *
+         *  Image for a source is found by hash of its text,
+         *  @ref astimage::c_version,  and reader settings that change
+         *  the expressions it produces (see reader::attach_astcache).
+         *  Image header repeats hash and size of the source,
+         *  so a stale or colliding image is treated as a miss.
+         *
+         *  Images are written to a temporary file and renamed into place,
+         *  so concurrent processes sharing a cache directory see either
+         *  a complete image or none.
+         **/
+        class astcache {
+        public:
+            using span_type = span<const char>;
+
+        public:
+            /** cache with images in directory @p dir (created on first store) **/
+            explicit astcache(std::string dir);
+
+            const std::string & dir() const { return dir_; }
+            const astcache_stats & stats() const { return stats_; }
+
+            /** path to image for source with hash @p source_hash
+             *  read with settings @p flags
+             **/
+            std::string image_path(std::uint64_t source_hash, std::uint32_t flags) const;
+
+            /** Look for image of @p source,  read with settings @p flags.
+             *  On hit,  replace @p *p_result_v with expressions rebuilt from image;
+             *  spans point into @p source.
+             *
+             *  @return true on hit
+             **/
+            bool lookup(const span_type & source,
+                        std::uint32_t flags,
+                        std::vector<reader_result> * p_result_v);
+
+            /** Save image of @p result_v,  read from @p source with settings @p flags.
+             *  @return false if not stored:  some expression has no image form,
+             *  or image could not be written
+             **/
+            bool store(const span_type & source,
+                       std::uint32_t flags,
+                       const std::vector<reader_result> & result_v);
+
+        private:
+            /** cache directory **/
+            std::string dir_;
+
+            astcache_stats stats_;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end astcache.hpp */
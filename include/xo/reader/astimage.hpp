@@ -0,0 +1,88 @@
+/* file astimage.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "reader.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class astimage
+         *  @brief compact binary form for toplevel expressions read from one source
+         *
+         *  Image is position-independent:  nodes refer to each other,
+         *  and to names,  by index.  Every record has fixed size and natural
+         *  alignment,  so an image can be used straight from a read-only mapping.
+         *
+         *  Layout (native byte order):
+         *  @code
+         *    header      { char magic[8]; u32 version; u32 flags;
+         *                  u64 source_hash; u64 source_size;
+         *                  u64 n_node; u64 n_const; u64 n_toplevel; u64 n_varref;
+         *                  u64 n_string; u64 string_bytes; }
+         *    node[n]     { u8 type; u8 td; u16 n_child; u32 arg; }
+         *    const[n]    f64
+         *    toplevel[n] { u32 node; u32 varref_lo; u32 n_varref; u32 pad; u64 lo; u64 hi; }
+         *    varref[n]   { u32 node; u32 depth; u32 slot; u32 pad; }
+         *    string[n]   { u32 off; u32 len; }
+         *    bytes       string text,  each distinct string once
+         *  @endcode
+         *
+         *  Nodes appear in post-order,  one toplevel expression after another;
+         *  a node's children are the @c n_child subtrees completed just before it,
+         *  so decoding is a single pass with a stack.
+         *  @c arg indexes the string table (names) or the constant table.
+         *  Types (TypeDescr) are stored as codes into a fixed table
+         *  of the types the reader can produce.
+         *  Toplevel spans are offsets into the source text.
+         *
+         *  Covers the expression kinds the reader emits:
+         *  f64 constant, variable, define, convert, lambda, sequence,
+         *  and application of an f64 arithmetic primitive.
+         *  Anything else (e.g. an unforced @ref LazyLambda) is not encodable.
+         **/
+        class astimage {
+        public:
+            using Expression = xo::ast::Expression;
+            using span_type = span<const char>;
+
+            /** bump when image layout,  or reader output for the same source, changes **/
+            static constexpr std::uint32_t c_version = 1;
+
+        public:
+            /** Encode @p result_v,  read from @p source with reader settings @p flags.
+             *  @return false (and leave @p *p_image unspecified) if some
+             *  expression is not encodable
+             **/
+            static bool encode(const span_type & source,
+                               std::uint32_t flags,
+                               const std::vector<reader_result> & result_v,
+                               std::string * p_image);
+
+            /** true iff @p image is an image of @p source (same hash and size),
+             *  written with reader settings @p flags by this version
+             **/
+            static bool matches(const span_type & image,
+                                const span_type & source,
+                                std::uint64_t source_hash,
+                                std::uint32_t flags);
+
+            /** Rebuild expressions from @p image.
+             *  Result spans point into @p source.
+             *  Throws std::runtime_error if @p image is malformed
+             **/
+            static std::vector<reader_result> decode(const span_type & image,
+                                                     const span_type & source);
+
+            /** 64-bit hash of @p text (FNV-1a) **/
+            static std::uint64_t content_hash(const span_type & text);
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end astimage.hpp */
@@ -0,0 +1,65 @@
+/* file concurrentsymboltable.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "symboltable.hpp"
+#include <shared_mutex>
+
+namespace xo {
+    namespace scm {
+        /** @class concurrentsymboltable
+         *  @brief intern table: name <-> symbolid,  shared between threads
+         *
+         *  Same contract as @ref symboltable,  but safe to call from
+         *  multiple threads.  Readers share a lock;  @ref intern of a new
+         *  name takes it exclusively.
+         *
+         *  Intended as the backing table for per-thread symboltables
+         *  (see symboltable::attach_shared),  which cache lookups locally;
+         *  so each thread takes the lock roughly once per distinct name.
+         **/
+        class concurrentsymboltable {
+        public:
+            concurrentsymboltable() = default;
+            concurrentsymboltable(const concurrentsymboltable &) = delete;
+            concurrentsymboltable & operator=(const concurrentsymboltable &) = delete;
+
+            /** number of distinct names interned **/
+            std::size_t size() const;
+
+            /** id for @p name,  assigning a new one if not already interned **/
+            symbolid intern(std::string_view name);
+
+            /** id for @p name if already interned;  c_invalid_symbolid otherwise **/
+            symbolid find(std::string_view name) const;
+
+            /** name with id @p id.  Reference remains valid for lifetime of table.
+             *  @pre @p id obtained from this table
+             **/
+            const std::string & name(symbolid id) const;
+
+            void print(std::ostream & os) const;
+
+        private:
+            /** protects .name_v_,  .id_map_ **/
+            mutable std::shared_mutex mutex_;
+            /** name_v_[id]: name with symbol id @p id.
+             *  deque so names don't move; .id_map_ keys refer to them
+             **/
+            std::deque<std::string> name_v_;
+            /** name -> id **/
+            std::unordered_map<std::string_view, symbolid> id_map_;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const concurrentsymboltable & x) {
+            x.print(os);
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end concurrentsymboltable.hpp */
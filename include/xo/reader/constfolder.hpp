@@ -0,0 +1,65 @@
+/* file constfolder.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "progress_xs.hpp"
+#include "xo/expression/Expression.hpp"
+#include <cstddef>
+
+namespace xo {
+    namespace scm {
+        /** @class constfolder
+         *  @brief parse-time constant folding for infix expressions
+         *
+         *  When enabled,  an infix operator applied to two f64 literals
+         *  is replaced by a single literal,  e.g.
+         *  @code
+         *    def k = 2.0 * 3.14159265 / 180.0;
+         *  @endcode
+         *  parses as if written with one constant on the rhs.
+         *
+         *  Result is computed with ordinary IEEE 754 double arithmetic,
+         *  so it's bit-identical to what runtime evaluation produces.
+         *  Folding is skipped when the result isn't finite,
+         *  so division by zero etc. still happens at runtime.
+         *
+         *  Disabled by default.
+         **/
+        class constfolder {
+        public:
+            using Expression = xo::ast::Expression;
+
+        public:
+            constfolder() = default;
+
+            bool enabled() const { return enabled_; }
+            void set_enabled(bool x) { enabled_ = x; }
+
+            /** number of operator nodes folded away so far **/
+            std::size_t n_folded() const { return n_folded_; }
+            void reset_n_folded() { n_folded_ = 0; }
+
+            /** if enabled,  and both @p lhs and @p rhs are f64 constants,
+             *  return constant for value of
+             *  @code
+             *    lhs op rhs
+             *  @endcode
+             *  otherwise nullptr
+             **/
+            rp<Expression> fold(optype op,
+                                const rp<Expression> & lhs,
+                                const rp<Expression> & rhs);
+
+        private:
+            /** true to fold constants **/
+            bool enabled_ = false;
+            /** number of folds performed **/
+            std::size_t n_folded_ = 0;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end constfolder.hpp */
@@ -0,0 +1,246 @@
+/* file cowvector.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <array>
+#include <functional>
+#include <cstddef>
+#include <cassert>
+
+namespace xo {
+    namespace scm {
+        /** @class cowvector
+         *  @brief append-only-at-the-back sequence with O(1) copy,
+         *         for parser state saved by parser::checkpoint
+         *
+         *  Elements live in a backward-linked chain of fixed-size chunks,
+         *  shared between copies.  A chunk reachable from more than one
+         *  cowvector is never modified:
+         *  - copy: O(1) (shares the whole chain);
+         *  - push_back/pop_back on a copy: clones at most the last chunk
+         *    (c_chunk_size elements) before modifying it;
+         *  - back(): O(1);  operator[]: O(distance from back / c_chunk_size).
+         *
+         *  Chunks come from a memory_resource (default new/delete);
+         *  copies share the source's resource,  which must outlive
+         *  every copy.
+         *
+         *  Not thread-safe;  but copies may be used and destroyed
+         *  on different threads,  since shared chunks are never modified.
+         **/
+        template <typename T, std::size_t ChunkSize = 32>
+        class cowvector {
+        public:
+            /** number of elements per chunk **/
+            static constexpr std::size_t c_chunk_size = ChunkSize;
+
+        public:
+            cowvector() = default;
+            explicit cowvector(std::pmr::memory_resource * mr) : mr_{mr} {}
+            cowvector(const std::vector<T> & v,
+                      std::pmr::memory_resource * mr = std::pmr::new_delete_resource())
+                : mr_{mr}
+            {
+                for (const T & x : v)
+                    this->push_back(x);
+            }
+            cowvector(const cowvector &) = default;
+            cowvector(cowvector && x)
+                : mr_{x.mr_}, last_{std::move(x.last_)}, size_{x.size_} { x.size_ = 0; }
+            ~cowvector() { this->clear(); }
+
+            cowvector & operator=(const cowvector & x) {
+                if (this != &x) {
+                    this->clear();
+                    mr_ = x.mr_;
+                    last_ = x.last_;
+                    size_ = x.size_;
+                }
+                return *this;
+            }
+            cowvector & operator=(cowvector && x) {
+                if (this != &x) {
+                    this->clear();
+                    mr_ = x.mr_;
+                    last_ = std::move(x.last_);
+                    size_ = x.size_;
+                    x.size_ = 0;
+                }
+                return *this;
+            }
+
+            bool empty() const { return size_ == 0; }
+            std::size_t size() const { return size_; }
+            std::pmr::memory_resource * resource() const { return mr_; }
+
+            /** last element.  @pre !empty() **/
+            const T & back() const {
+                assert(size_ > 0);
+                return last_->v_[last_->n_ - 1];
+            }
+
+            /** i'th element,  0 = first in **/
+            const T & operator[](std::size_t i) const {
+                assert(i < size_);
+
+                /* chunk k holds elements [k * c_chunk_size, (k+1) * c_chunk_size) */
+                std::size_t k = i / c_chunk_size;
+                const chunk * c = last_.get();
+
+                for (std::size_t j = (size_ - 1) / c_chunk_size; j > k; --j)
+                    c = c->prev_.get();
+
+                return c->v_[i % c_chunk_size];
+            }
+
+            const T & front() const { return (*this)[0]; }
+
+            void push_back(T x) {
+                if (!last_ || (last_->n_ == c_chunk_size)) {
+                    std::shared_ptr<chunk> c
+                        = std::allocate_shared<chunk>(std::pmr::polymorphic_allocator<chunk>(mr_));
+
+                    c->prev_ = std::move(last_);
+                    last_ = std::move(c);
+                } else {
+                    this->unshare_last();
+                }
+
+                last_->v_[last_->n_] = std::move(x);
+                ++(last_->n_);
+                ++size_;
+            }
+
+            /** remove last element.  @pre !empty() **/
+            void pop_back() {
+                assert(size_ > 0);
+
+                this->unshare_last();
+
+                --(last_->n_);
+                last_->v_[last_->n_] = T();
+                --size_;
+
+                if (last_->n_ == 0)
+                    last_ = std::shared_ptr<chunk>(last_->prev_);
+            }
+
+            void clear() {
+                /* unlink iteratively:  recursive ~chunk could exhaust stack on a long chain */
+                while (last_ && (last_.use_count() == 1)) {
+                    std::shared_ptr<chunk> prev = std::move(last_->prev_);
+                    last_ = std::move(prev);
+                }
+
+                last_.reset();
+                size_ = 0;
+            }
+
+            /** true iff this and @p x share all their storage,
+             *  so have identical contents.  O(1)
+             **/
+            bool same_as(const cowvector & x) const {
+                return (last_ == x.last_) && (size_ == x.size_);
+            }
+
+            /** true if @p x's contents are a prefix of this vector's,
+             *  e.g. @p x is an earlier copy and this vector was only appended to since.
+             *  Compares shared chunks by identity,  and at most one chunk
+             *  element-wise using @p eq.
+             *  Cost O((size() - x.size()) / c_chunk_size + c_chunk_size).
+             *  May report false for some prefixes that don't share storage
+             **/
+            template <typename Eq = std::equal_to<T>>
+            bool has_prefix(const cowvector & x, Eq eq = Eq()) const {
+                if (x.size_ > size_)
+                    return false;
+                if (x.size_ == 0)
+                    return true;
+
+                /* chunk of this vector in the same position as x.last_ */
+                const chunk * c = last_.get();
+
+                for (std::size_t j = (size_ - 1) / c_chunk_size,
+                         k = (x.size_ - 1) / c_chunk_size; j > k; --j)
+                {
+                    c = c->prev_.get();
+                }
+
+                if (c == x.last_.get())
+                    return true;
+
+                /* x.last_ cloned before appending here */
+                if (c->prev_ != x.last_->prev_)
+                    return false;
+
+                for (std::size_t i = 0; i < x.last_->n_; ++i) {
+                    if (!eq(c->v_[i], x.last_->v_[i]))
+                        return false;
+                }
+
+                return true;
+            }
+
+            /** invoke @p fn on each element,  first in first **/
+            template <typename Fn>
+            void visit(Fn && fn) const {
+                std::vector<const chunk *> chunk_v;
+                chunk_v.reserve((size_ + c_chunk_size - 1) / c_chunk_size);
+
+                for (const chunk * c = last_.get(); c; c = c->prev_.get())
+                    chunk_v.push_back(c);
+
+                for (std::size_t k = chunk_v.size(); k > 0; --k) {
+                    const chunk * c = chunk_v[k - 1];
+
+                    for (std::size_t i = 0; i < c->n_; ++i)
+                        fn(c->v_[i]);
+                }
+            }
+
+            /** contents as a std::vector,  first in first **/
+            std::vector<T> to_vector() const {
+                std::vector<T> retval;
+                retval.reserve(size_);
+
+                this->visit([&retval](const T & x) { retval.push_back(x); });
+
+                return retval;
+            }
+
+        private:
+            struct chunk {
+                /** preceding chunk;  always full **/
+                std::shared_ptr<chunk> prev_;
+                /** number of elements in use,  at front of .v_ **/
+                std::size_t n_ = 0;
+                std::array<T, c_chunk_size> v_;
+            };
+
+            /** make last chunk exclusive to this vector,  before modifying it **/
+            void unshare_last() {
+                if (last_.use_count() > 1) {
+                    last_ = std::allocate_shared<chunk>(std::pmr::polymorphic_allocator<chunk>(mr_),
+                                                        *last_);
+                }
+            }
+
+        private:
+            /** source for chunks **/
+            std::pmr::memory_resource * mr_ = std::pmr::new_delete_resource();
+            /** last chunk;  holds back().  Earlier chunks reached via chunk::prev_ **/
+            std::shared_ptr<chunk> last_;
+            /** number of elements **/
+            std::size_t size_ = 0;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+
+/* end cowvector.hpp */
@@ -0,0 +1,138 @@
+/* file defindex.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "mapped_file.hpp"
+#include "structindex.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class defindex_entry
+         *  @brief one toplevel definition,  as found by @ref defindexer
+         **/
+        struct defindex_entry {
+            /** defined name **/
+            std::string name_;
+            /** declared type name,  as written;  empty if none **/
+            std::string type_;
+            /** offset of 'def' keyword **/
+            std::uint64_t lo_ = 0;
+            /** offset just past terminating ';' **/
+            std::uint64_t hi_ = 0;
+        };
+
+        /** @class defindexer
+         *  @brief find toplevel definitions without parsing them
+         *
+         *  Tokenizes only the front of each toplevel definition
+         *  (states def_0..def_4 of @ref define_xs:  'def' name [: type] '='),
+         *  then jumps to the terminating toplevel ';' found by
+         *  a @ref structscanner pass.  Builds no expressions.
+         *  Toplevel forms other than definitions are skipped the same way.
+         *
+         *  Index file layout (native byte order),  see @ref defindex:
+         *  @code
+         *    header   { char magic[8]; u64 n_entry; }
+         *    entry[n] { u64 lo; u64 hi; u32 name_off; u32 name_len; u32 type_off; u32 type_len; }
+         *    strings  (name/type text;  offsets relative to start of strings)
+         *  @endcode
+         *  Entries are sorted by name,  then by lo.
+         **/
+        class defindexer {
+        public:
+            using span_type = span<const char>;
+
+        public:
+            /** Index toplevel definitions in @p input (a complete translation unit).
+             *  Throws std::runtime_error on a malformed definition head.
+             *
+             *  @return definitions in input order
+             **/
+            static std::vector<defindex_entry> scan(const span_type & input,
+                                                    simdlevel level = structscanner::best_simdlevel());
+
+            /** write @p entry_v to index file at @p path **/
+            static void write(const std::string & path,
+                              std::vector<defindex_entry> entry_v);
+
+            /** index source file @p src_path,  writing index to @p index_path.
+             *  @return number of definitions indexed
+             **/
+            static std::size_t index_file(const std::string & src_path,
+                                          const std::string & index_path);
+        };
+
+        /** @class defindex
+         *  @brief read-only view of an index file written by @ref defindexer
+         *
+         *  Index file is memory-mapped;  lookup is a binary search
+         *  over fixed-size entries,  touching O(log n) pages.
+         **/
+        class defindex {
+        public:
+            /** one entry,  pointing into the mapped file **/
+            struct entry_view {
+                std::string_view name_;
+                std::string_view type_;
+                std::uint64_t lo_ = 0;
+                std::uint64_t hi_ = 0;
+            };
+
+        public:
+            /** map index file at @p path.  Throws std::runtime_error if header
+             *  is not valid,  or entry count doesn't fit the file.
+             *  O(1):  entries are checked as they are read,  see @ref entry
+             **/
+            static defindex open(const std::string & path);
+
+            std::size_t size() const { return n_entry_; }
+
+            /** i'th entry,  in name order.
+             *  Throws std::runtime_error if its name or type lies outside the string table
+             **/
+            entry_view entry(std::size_t i) const;
+
+            /** all definitions of @p name,  in source order **/
+            std::vector<entry_view> find(std::string_view name) const;
+
+        private:
+            /** on-disk entry **/
+            struct raw_entry {
+                std::uint64_t lo_;
+                std::uint64_t hi_;
+                std::uint32_t name_off_;
+                std::uint32_t name_len_;
+                std::uint32_t type_off_;
+                std::uint32_t type_len_;
+            };
+
+            friend class defindexer;
+
+            static constexpr char c_magic[8] = {'x', 'o', 'd', 'e', 'f', 'i', 'x', '1'};
+
+            /** bytes before first entry **/
+            static constexpr std::size_t c_header_size = 16;
+
+        private:
+            /** index file **/
+            mapped_file file_;
+            /** number of entries **/
+            std::size_t n_entry_ = 0;
+            /** first entry;  within .file_ **/
+            const char * entry_lo_ = nullptr;
+            /** start of string table;  within .file_ **/
+            const char * string_lo_ = nullptr;
+            /** size of string table (runs to end of .file_) **/
+            std::uint64_t string_z_ = 0;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end defindex.hpp */
@@ -8,6 +8,7 @@
 #include "xo/expression/DefineExpr.hpp"
 #include "xo/expression/ConvertExpr.hpp"
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 //#include <cstdint>
 
 namespace xo {
@@ -64,13 +65,19 @@ namespace xo {
         /** @class define_xs
          *  @brief state to provide parsing of a define-expression
          **/
-        class define_xs : public exprstate {
+        class define_xs final : public exprstate {
         public:
             using DefineExprAccess = xo::ast::DefineExprAccess;
             using ConvertExprAccess = xo::ast::ConvertExprAccess;
 
         public:
             define_xs(rp<DefineExprAccess> def_expr);
+            /** copy;  partially-assembled definition is copied too,
+             *  so the copy can continue independently of @p x
+             *  (see parser::checkpoint)
+             **/
+            define_xs(const define_xs & x);
+            define_xs(define_xs && x) = default;
             virtual ~define_xs() = default;
 
             static const define_xs * from(const exprstate * x) { return dynamic_cast<const define_xs *>(x); }
@@ -102,9 +109,6 @@ namespace xo {
 
             virtual void print(std::ostream & os) const override;
 
-        private:
-            static std::unique_ptr<define_xs> make();
-
         private:
             defexprstatetype defxs_type_;
             /** scaffold a define-expression here **/
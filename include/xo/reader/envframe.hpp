@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "cowvector.hpp"
 #include "xo/expression/Variable.hpp"
 #include <vector>
 
@@ -13,17 +14,37 @@ namespace xo {
         /** @class envframe
          *  @brief names/types of formal paremeters introduced by a function
          *
-         *
+         *  Also local definitions added to a block's frame (see @ref push_back).
+         *  Contents are copy-on-write,  so copying a frame
+         *  (parser checkpoint, @ref LazyLambda) is O(1).
          **/
         class envframe {
         public:
             using Variable = xo::ast::Variable;
 
+        public:
+            using argl_type = cowvector<rp<Variable>>;
+
         public:
             envframe() = default;
-            envframe(const std::vector<rp<Variable>> & argl) : argl_(argl) {}
+            envframe(const std::vector<rp<Variable>> & argl)
+                : argl_(argl), n_formal_{argl.size()} {}
 
-            const std::vector<rp<Variable>> & argl() const { return argl_; }
+            const argl_type & argl() const { return argl_; }
+            /** number of formals given at construction;
+             *  argl() after these were added by @ref push_back
+             **/
+            std::size_t n_formal() const { return n_formal_; }
+
+            /** append @p var to this frame;  it gets slot argl().size() **/
+            void push_back(const rp<Variable> & var) { argl_.push_back(var); }
+
+            /** true iff this frame and @p x share storage and have the same contents **/
+            bool same_as(const envframe & x) const { return argl_.same_as(x.argl_); }
+            /** true if @p x is this frame before zero or more @ref push_back calls.
+             *  May report false for a prefix that doesn't share storage
+             **/
+            bool extends(const envframe & x) const;
 
             /** lookup variable by name.  If found, return it.
              *  Otherwise return nullptr
@@ -33,7 +54,9 @@ namespace xo {
             void print (std::ostream & os) const;
 
         private:
-            std::vector<rp<Variable>> argl_;
+            argl_type argl_;
+            /** formals given at construction:  argl_[0 .. n_formal_) **/
+            std::size_t n_formal_ = 0;
         };
 
         inline std::ostream &
@@ -6,11 +6,20 @@
 #pragma once
 
 #include "envframe.hpp"
+#include "symboltable.hpp"
+#include "lexaddr.hpp"
+#include <string_view>
 
 namespace xo {
     namespace scm {
         /** @class envframestack
          *  @brief A stack of envframe objects
+         *
+         *  Names are interned in a @ref symboltable.
+         *  For each symbol,  stack also keeps the chain of bindings
+         *  currently in scope, innermost last:
+         *  - lookup is one hash + one vector index,  regardless of depth
+         *  - push/pop cost is proportional to #of formals in the frame
          **/
         class envframestack {
         public:
@@ -22,15 +31,54 @@ namespace xo {
             bool empty() const { return stack_.empty(); }
             std::size_t size() const { return stack_.size(); }
 
+            /** names seen by this stack **/
+            const symboltable & symtab() const { return symtab_; }
+
+            /** take symbol ids from @p shared (nullptr: use private ids).
+             *  @pre stack is empty
+             **/
+            void attach_symtab(concurrentsymboltable * shared);
+
             /** lookup variable in environment stack.
-             *  Visit frames in fifo order,  report first match;
+             *  Report binding from innermost frame that has one;
              *  nullptr if no matches.
              **/
-            rp<Variable> lookup(const std::string & x) const;
+            rp<Variable> lookup(std::string_view x) const;
+            /** lookup variable by interned name **/
+            rp<Variable> lookup(symbolid id) const;
+
+            /** lookup variable in environment stack,  and report
+             *  its lexical address relative to top of stack.
+             *  On success,  *p_addr is the variable's address;
+             *  if no match,  return nullptr and leave *p_addr unchanged.
+             **/
+            rp<Variable> lookup_addr(std::string_view x, lexaddr * p_addr) const;
+
+            /** frames in stack order (bottom first).
+             *  Copy to reproduce this lexical context elsewhere,
+             *  see @ref LazyLambda
+             **/
+            const std::vector<envframe> & frame_v() const { return stack_; }
 
             envframe & top_envframe();
             void push_envframe(envframe x);
             void pop_envframe();
+            /** add @p var to top frame,  after existing variables.
+             *  @p var shadows any existing binding for the same name,
+             *  including one in the top frame.
+             *  Used for local definitions in a block (see @ref sequence_xs)
+             **/
+            void extend_envframe(const rp<Variable> & var);
+
+            /** make stack contents equal to @p frame_v (bottom first),
+             *  where @p frame_v is an earlier copy of frame_v().
+             *  Keeps frames that share storage with @p frame_v,
+             *  and trims a frame only extended since;  cost is O(size())
+             *  plus binding work proportional to frames pushed,
+             *  popped or extended since @p frame_v was taken.
+             *  See parser::restore
+             **/
+            void restore_frames(const std::vector<envframe> & frame_v);
 
             /** relative to top-of-stack.
              *  0 -> top (last in),  z-1 -> bottom (first in)
@@ -54,7 +102,38 @@ namespace xo {
             void print (std::ostream & os) const;
 
         private:
+            /** a variable in scope **/
+            struct binding {
+                /** the variable (a lambda formal or local definition) **/
+                rp<Variable> var_;
+                /** frame introducing .var_;  0 = bottom of stack **/
+                std::uint32_t frame_ = 0;
+                /** position of .var_ in frame's argl **/
+                std::uint32_t slot_ = 0;
+            };
+
+            /** undo the last @p n extend_envframe() calls on top frame's bindings.
+             *  Leaves top frame itself alone
+             **/
+            void unextend_envframe(std::size_t n);
+
+            /** innermost binding for @p id;  nullptr if none **/
+            const binding * lookup_binding(symbolid id) const;
+
+        private:
+            /** frames;  bottom of stack at stack_[0] **/
             std::vector<envframe> stack_;
+
+            /** interned names for all formals seen **/
+            symboltable symtab_;
+            /** binding_v_[id]: variables named symtab_.name(id)
+             *  in scope;  innermost binding last
+             **/
+            std::vector<std::vector<binding>> binding_v_;
+            /** symbol ids bound by each frame,  concatenated in stack order **/
+            std::vector<symbolid> bound_v_;
+            /** frame_lo_v_[i]: start of frame i's ids in .bound_v_ **/
+            std::vector<std::size_t> frame_lo_v_;
         };
 
         inline std::ostream &
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 
 namespace xo {
     namespace scm {
@@ -13,15 +14,21 @@ namespace xo {
         /** @class expect_expr_xs
          *  @brief state machine to expect + capture an expression
          **/
-        class expect_expr_xs : public exprstate {
+        class expect_expr_xs final : public exprstate {
         public:
             explicit expect_expr_xs(bool allow_defs,
-                                    bool cxl_on_rightbrace);
+                                    bool cxl_on_rightbrace,
+                                    bool is_operand = false);
 
             static void start(parserstatemachine * p_psm);
             static void start(bool allow_defs,
                               bool cxl_on_rightbrace,
                               parserstatemachine * p_psm);
+            /** expect right-hand operand of an infix operator.
+             *  A literal or variable is reported directly to the enclosing
+             *  @ref progress_xs,  instead of starting a nested one
+             **/
+            static void start_operand(parserstatemachine * p_psm);
 
             virtual void on_lambda_token(const token_type & tk,
                                          parserstatemachine * p_psm) override;
@@ -54,10 +61,6 @@ namespace xo {
                                                 parserstatemachine * p_psm) override;
 
 
-        private:
-            static std::unique_ptr<expect_expr_xs> make(bool allow_defs,
-                                                        bool cxl_on_rightbrace);
-
         private:
             /* if true: allow a define-expression here */
             bool allow_defs_ = false;
@@ -68,6 +71,10 @@ namespace xo {
              *   - expression
              */
             bool cxl_on_rightbrace_ = false;
+            /* if true: expression is an operand of an infix operator;
+             * parent progress_xs takes care of any operators that follow
+             */
+            bool is_operand_ = false;
         };
 
     } /*namespace scm*/
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 #include "formal_arg.hpp"
 #include <vector>
 
@@ -46,7 +47,7 @@ namespace xo {
         /** @class expect_formal_arglist
          *  @brief parser state-machine for a formal parameter list
          **/
-        class expect_formal_arglist_xs : public exprstate {
+        class expect_formal_arglist_xs final : public exprstate {
         public:
             using Variable = xo::ast::Variable;
 
@@ -65,9 +66,6 @@ namespace xo {
                                              parserstatemachine * p_psm) override;
             virtual void print(std::ostream & os) const override;
 
-        private:
-            static std::unique_ptr<expect_formal_arglist_xs> make();
-
         private:
             /** parsing state-machine state **/
             formalarglstatetype farglxs_type_ = formalarglstatetype::argl_0;
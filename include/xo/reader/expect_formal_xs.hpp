@@ -6,6 +6,7 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 #include "formal_arg.hpp"
 
 namespace xo {
@@ -43,7 +44,7 @@ namespace xo {
         /** @class expect_formal_xs
          *  @brief parser state-machine for a typed formal parameter
          **/
-        class expect_formal_xs : public exprstate {
+        class expect_formal_xs final : public exprstate {
         public:
             expect_formal_xs();
 
@@ -68,9 +69,6 @@ namespace xo {
 
             virtual void print(std::ostream & os) const override;
 
-        private:
-            static std::unique_ptr<expect_formal_xs> make();
-
         private:
             /** parsing state-machine state **/
             formalstatetype formalxs_type_ = formalstatetype::formal_0;
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 
 namespace xo {
     namespace scm {
@@ -14,11 +15,10 @@ namespace xo {
          *
          *  For example,  lhs in a define-expression
          **/
-        class expect_symbol_xs : public exprstate {
+        class expect_symbol_xs final : public exprstate {
         public:
             expect_symbol_xs();
 
-            static std::unique_ptr<expect_symbol_xs> make();
 
             static void start(parserstatemachine * p_psm);
 
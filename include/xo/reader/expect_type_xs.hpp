@@ -6,13 +6,14 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 
 namespace xo {
     namespace scm {
         /** @class expect_type_xs
          *  @brief state-machine for accepting a typename-expression
          **/
-        class expect_type_xs : public exprstate {
+        class expect_type_xs final : public exprstate {
         public:
             expect_type_xs();
 
@@ -20,9 +21,6 @@ namespace xo {
 
             virtual void on_symbol_token(const token_type & tk,
                                          parserstatemachine * p_psm) override;
-
-        private:
-            static std::unique_ptr<expect_type_xs> make();
         };
     } /*namespace scm*/
 } /*namespace xo*/
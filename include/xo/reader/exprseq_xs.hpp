@@ -6,6 +6,7 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 //#include <cstdint>
 
 namespace xo {
@@ -14,7 +15,7 @@ namespace xo {
          *  @brief parsing state-machine for top-level expression sequence
          *
          **/
-        class exprseq_xs : public exprstate {
+        class exprseq_xs final : public exprstate {
         public:
             exprseq_xs();
 
@@ -34,9 +35,6 @@ namespace xo {
                                       parserstatemachine * p_psm) override;
             virtual void on_expr(ref::brw<Expression> expr,
                                  parserstatemachine * p_psm) override;
-
-        private:
-            static std::unique_ptr<exprseq_xs> make();
         };
     } /*namespace scm*/
 } /*namespace xo*/
@@ -7,7 +7,10 @@
 
 #include "xo/expression/Expression.hpp"
 #include "xo/tokenizer/token.hpp"
+#include "xo/tokenizer/span.hpp"
+#include "logpolicy.hpp"
 #include <stack>
+#include <cassert>
 //#include <cstdint>
 
 namespace xo {
@@ -38,11 +41,6 @@ namespace xo {
              **/
             sequenceexpr,
 
-            /** handle let1 (single local variable)
-             *  see @ref let1_xs
-             **/
-            let1expr,
-
             expect_rhs_expression,
             expect_symbol,
             expect_type,
@@ -103,6 +101,15 @@ namespace xo {
             void on_input(const token_type & tk,
                           parserstatemachine * p_psm);
 
+            /** deliver token @p tk to the matching on_xxx_token() handler of @p xs.
+             *  With @p Xs a final exprstate subtype,  handler calls are direct.
+             *  See also parserstatemachine::on_input
+             **/
+            template <typename Xs>
+            static void dispatch_input(Xs & xs,
+                                       const token_type & tk,
+                                       parserstatemachine * p_psm);
+
             /** update exprstate in response to a successfully-parsed subexpression **/
             virtual void on_expr(ref::brw<Expression> expr,
                                  parserstatemachine * p_psm);
@@ -127,6 +134,14 @@ namespace xo {
             virtual void on_formal_arglist(const std::vector<rp<Variable>> & argl,
                                            parserstatemachine * p_psm);
 
+            /** update exprstate with source text for a lambda body,
+             *  after parserstatemachine::request_lazy_body().
+             *  @p body is empty if driver declined to supply text;
+             *  in that case body tokens follow as usual
+             **/
+            virtual void on_lazy_body(const span<const char> & body,
+                                      parserstatemachine * p_psm);
+
             /** print human-readable representation on @p os **/
             virtual void print(std::ostream & os) const;
 
@@ -188,6 +203,113 @@ namespace xo {
             exprstatetype exs_type_;
         }; /*exprstate*/
 
+        template <typename Xs>
+        void
+        exprstate::dispatch_input(Xs & xs,
+                                  const token_type & tk,
+                                  parserstatemachine * p_psm)
+        {
+            switch (tk.tk_type()) {
+
+            case tokentype::tk_def:
+                xs.on_def_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_lambda:
+                xs.on_lambda_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_i64:
+                assert(false);
+                return;
+
+            case tokentype::tk_f64:
+                xs.on_f64_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_string:
+                assert(false);
+                return;
+
+            case tokentype::tk_symbol:
+                xs.on_symbol_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_leftparen:
+                xs.on_leftparen_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_rightparen:
+                xs.on_rightparen_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_leftbracket:
+            case tokentype::tk_rightbracket:
+                assert(false);
+                break;
+
+            case tokentype::tk_leftbrace:
+                xs.on_leftbrace_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_rightbrace:
+                xs.on_rightbrace_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_dot:
+                assert(false);
+                return;
+
+            case tokentype::tk_comma:
+                xs.on_comma_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_colon:
+                xs.on_colon_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_doublecolon:
+                assert(false);
+                return;
+
+            case tokentype::tk_semicolon:
+                xs.on_semicolon_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_singleassign:
+                xs.on_singleassign_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_assign:
+            case tokentype::tk_yields:
+
+            case tokentype::tk_leftangle:
+            case tokentype::tk_rightangle:
+            case tokentype::tk_plus:
+            case tokentype::tk_minus:
+            case tokentype::tk_star:
+            case tokentype::tk_slash:
+                xs.on_operator_token(tk, p_psm);
+                return;
+
+            case tokentype::tk_type:
+            case tokentype::tk_if:
+            case tokentype::tk_let:
+
+            case tokentype::tk_in:
+            case tokentype::tk_end:
+                assert(false);
+                return;
+
+            case tokentype::tk_invalid:
+            case tokentype::n_tokentype:
+                assert(false);
+                return;
+            }
+
+            assert(false);
+        } /*dispatch_input*/
+
         inline std::ostream &
         operator<< (std::ostream & os, const exprstate & x) {
             x.print(os);
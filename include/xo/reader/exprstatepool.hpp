@@ -0,0 +1,164 @@
+/* file exprstatepool.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "exprstate.hpp"
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class exprstatepool_stats
+         *  @brief allocation counters for an @ref exprstatepool
+         **/
+        struct exprstatepool_stats {
+            /** number of exprstate allocations served **/
+            std::size_t n_alloc_ = 0;
+            /** number of exprstate allocations returned **/
+            std::size_t n_release_ = 0;
+            /** number of slabs obtained from the system allocator **/
+            std::size_t n_slab_ = 0;
+            /** number of allocations too large for a size class;
+             *  these go to the system allocator
+             **/
+            std::size_t n_oversize_ = 0;
+
+            void print(std::ostream & os) const;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const exprstatepool_stats & x) {
+            x.print(os);
+            return os;
+        }
+
+        /** @class exprstatepool
+         *  @brief size-class free lists for exprstate objects
+         *
+         *  Parser states are short-lived and strictly nested;
+         *  a parser typically frees a state within a few tokens of creating it.
+         *  Pool recycles their memory instead of going back to malloc.
+         *
+         *  Memory is carved from fixed-size slabs.
+         *  Released blocks go on a per-size-class free list,
+         *  and are never returned to the system until the pool is destroyed.
+         *  In steady state parsing allocates no memory for exprstates.
+         *
+         *  Slabs and oversize blocks come from an upstream memory_resource
+         *  (default: new/delete),  see @ref set_upstream.
+         *
+         *  Pool is itself a memory_resource,  so per-state allocations
+         *  can be routed through a @ref countingresource on their way here
+         *  (see exprstatestack::attach_allocaccount).
+         *
+         *  Not thread-safe;  owned by a single @ref exprstatestack.
+         **/
+        class exprstatepool : public std::pmr::memory_resource {
+        public:
+            /** size-class granularity.  Also alignment of each block **/
+            static constexpr std::size_t c_granule = alignof(std::max_align_t);
+            /** number of size classes. class k serves sizes up to (k+1) * c_granule **/
+            static constexpr std::size_t c_n_sizeclass = 16;
+            /** largest block served from a size class **/
+            static constexpr std::size_t c_max_size = c_n_sizeclass * c_granule;
+            /** slab size **/
+            static constexpr std::size_t c_slab_size = 4096;
+
+        public:
+            exprstatepool() = default;
+            exprstatepool(const exprstatepool &) = delete;
+            exprstatepool & operator=(const exprstatepool &) = delete;
+            ~exprstatepool();
+
+            const exprstatepool_stats & stats() const { return stats_; }
+
+            /** take future slabs and oversize blocks from @p upstream
+             *  (nullptr: new/delete).  Slabs already held stay with the
+             *  resource they came from.  Slabs are returned when the pool
+             *  is destroyed,  so @p upstream must outlive this pool.
+             *  @pre no live allocations
+             **/
+            void set_upstream(std::pmr::memory_resource * upstream);
+
+            /** allocate uninitialized memory for an object of size @p z **/
+            void * alloc(std::size_t z);
+            /** return memory at @p mem, obtained from alloc(z), to this pool **/
+            void release(void * mem, std::size_t z);
+
+        private:
+            void * do_allocate(std::size_t z, std::size_t align) override;
+            void do_deallocate(void * p, std::size_t z, std::size_t align) override;
+            bool do_is_equal(const std::pmr::memory_resource & x) const noexcept override;
+
+        private:
+            struct freenode {
+                freenode * next_ = nullptr;
+            };
+
+            /** slab,  and resource to return it to **/
+            struct slab {
+                std::byte * lo_ = nullptr;
+                std::pmr::memory_resource * upstream_ = nullptr;
+            };
+
+            static std::size_t sizeclass(std::size_t z) {
+                return (z + c_granule - 1) / c_granule - 1;
+            }
+
+            /** carve a block for size class @p k from current slab **/
+            void * carve(std::size_t k);
+
+        private:
+            /** free_v_[k]: free list for blocks of size (k+1) * c_granule **/
+            std::array<freenode *, c_n_sizeclass> free_v_ = {};
+            /** source for slabs and oversize blocks **/
+            std::pmr::memory_resource * upstream_ = std::pmr::new_delete_resource();
+            /** slabs owned by this pool **/
+            std::vector<slab> slab_v_;
+            /** unused portion of last slab: [lo, hi) **/
+            std::byte * slab_lo_ = nullptr;
+            std::byte * slab_hi_ = nullptr;
+            /** allocation counters **/
+            exprstatepool_stats stats_;
+        };
+
+        /** @class xs_deleter
+         *  @brief deleter for exprstates constructed in an @ref exprstatepool
+         **/
+        class xs_deleter {
+        public:
+            xs_deleter() = default;
+            xs_deleter(exprstatepool * pool, std::uint32_t z) : pool_{pool}, z_{z} {}
+
+            void operator()(exprstate * x) const {
+                /* start of allocated block (most-derived object) */
+                void * mem = dynamic_cast<void *>(x);
+
+                x->~exprstate();
+
+                assert(pool_);
+
+                pool_->release(mem, z_);
+            }
+
+        private:
+            /** pool that owns memory for the exprstate **/
+            exprstatepool * pool_ = nullptr;
+            /** size of most-derived exprstate type **/
+            std::uint32_t z_ = 0;
+        };
+
+        /** owning pointer to an exprstate allocated from an @ref exprstatepool **/
+        template <typename T>
+        using xs_uptr = std::unique_ptr<T, xs_deleter>;
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end exprstatepool.hpp */
@@ -6,12 +6,18 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
+#include "allocaccount.hpp"
 #include "xo/indentlog/print/vector.hpp"
+#include <new>
 
 namespace xo {
     namespace scm {
         /** @class exprstatestack
          *  @brief A stack of exprstate objects
+         *
+         *  Stack also owns memory for its exprstates;
+         *  see @ref make_exprstate
          **/
         class exprstatestack {
         public:
@@ -20,14 +26,40 @@ namespace xo {
             bool empty() const { return stack_.empty(); }
             std::size_t size() const { return stack_.size(); }
 
+            /** allocation counters for exprstates created via @ref make_exprstate **/
+            const exprstatepool_stats & pool_stats() const { return pool_.stats(); }
+            /** source for pool slabs,  see exprstatepool::set_upstream **/
+            void set_upstream(std::pmr::memory_resource * x) { pool_.set_upstream(x); }
+            /** charge each exprstate created from now on to @p account
+             *  (nullptr to detach),  under alloccategory::exprstate
+             **/
+            void attach_allocaccount(allocaccount * account) { counter_.set_account(account); }
+
+            /** create exprstate of type @p T,  with memory from this stack's pool.
+             *  Memory returns to the pool when the exprstate is destroyed.
+             **/
+            template <typename T, typename... Args>
+            xs_uptr<T> make_exprstate(Args && ... args) {
+                void * mem = counter_.allocate(sizeof(T), alignof(T));
+
+                try {
+                    T * x = new (mem) T(std::forward<Args>(args)...);
+
+                    return xs_uptr<T>(x, xs_deleter(&pool_, sizeof(T)));
+                } catch (...) {
+                    pool_.release(mem, sizeof(T));
+                    throw;
+                }
+            }
+
             exprstate & top_exprstate();
-            void push_exprstate(std::unique_ptr<exprstate> exs);
-            std::unique_ptr<exprstate> pop_exprstate();
+            void push_exprstate(xs_uptr<exprstate> exs);
+            xs_uptr<exprstate> pop_exprstate();
 
             /** relative to top-of-stack.
              *  0 -> top (last in),  z-1 -> bottom (first in)
              **/
-            std::unique_ptr<exprstate> & operator[](std::size_t i) {
+            xs_uptr<exprstate> & operator[](std::size_t i) {
                 std::size_t z = stack_.size();
 
                 assert(i < z);
@@ -35,7 +67,7 @@ namespace xo {
                 return stack_[z - i - 1];
             }
 
-            const std::unique_ptr<exprstate> & operator[](std::size_t i) const {
+            const xs_uptr<exprstate> & operator[](std::size_t i) const {
                 std::size_t z = stack_.size();
 
                 assert(i < z);
@@ -46,7 +78,16 @@ namespace xo {
             void print (std::ostream & os) const;
 
         private:
-            std::vector<std::unique_ptr<exprstate>> stack_;
+            /** memory for exprstates in .stack_.
+             *  Declared first so it outlives them
+             **/
+            exprstatepool pool_;
+            /** exprstate allocations pass through here on their way to .pool_,
+             *  so they can be counted.  Release goes straight to .pool_
+             **/
+            countingresource counter_{nullptr, alloccategory::exprstate, &pool_};
+            /** stack contents;  bottom of stack at stack_[0] **/
+            std::vector<xs_uptr<exprstate>> stack_;
         };
 
         inline std::ostream &
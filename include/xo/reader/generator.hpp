@@ -0,0 +1,134 @@
+/* file generator.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+namespace xo {
+    namespace scm {
+        /** @class generator
+         *  @brief lazily-evaluated sequence of T,  produced by a coroutine
+         *
+         *  Minimal stand-in for C++23 std::generator:
+         *  - single pass, input iterator
+         *  - coroutine body runs only when iterator is advanced
+         *  - each co_yield'd value is moved into the promise,
+         *    so it outlives the suspension point
+         *  - exception thrown from body propagates from begin() / operator++
+         *
+         *  Use:
+         *  @code
+         *    generator<int> iota(int n) {
+         *        for (int i = 0; i < n; ++i)
+         *            co_yield i;
+         *    }
+         *
+         *    for (int i : iota(10)) { .. }
+         *  @endcode
+         **/
+        template <typename T>
+        class generator {
+        public:
+            struct promise_type;
+            using handle_type = std::coroutine_handle<promise_type>;
+
+            struct promise_type {
+                generator get_return_object() {
+                    return generator(handle_type::from_promise(*this));
+                }
+
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_always final_suspend() noexcept { return {}; }
+
+                std::suspend_always yield_value(T x) {
+                    value_ = std::move(x);
+                    return {};
+                }
+
+                void return_void() {}
+
+                void unhandled_exception() { error_ = std::current_exception(); }
+
+                /** resume coroutine until next co_yield or completion **/
+                void advance(handle_type h) {
+                    value_.reset();
+                    h.resume();
+
+                    if (error_)
+                        std::rethrow_exception(std::exchange(error_, nullptr));
+                }
+
+                /** most recently yielded value **/
+                std::optional<T> value_;
+                /** exception escaping coroutine body,  until rethrown **/
+                std::exception_ptr error_;
+            };
+
+            class iterator {
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using difference_type = std::ptrdiff_t;
+                using value_type = T;
+
+            public:
+                iterator() = default;
+                explicit iterator(handle_type h) : h_{h} {}
+
+                T & operator*() const { return *(h_.promise().value_); }
+                T * operator->() const { return &*(h_.promise().value_); }
+
+                iterator & operator++() {
+                    h_.promise().advance(h_);
+                    return *this;
+                }
+                void operator++(int) { ++(*this); }
+
+                bool operator==(std::default_sentinel_t) const { return !h_ || h_.done(); }
+
+            private:
+                handle_type h_;
+            };
+
+        public:
+            generator() = default;
+            generator(const generator &) = delete;
+            generator(generator && x) : h_{std::exchange(x.h_, nullptr)} {}
+            ~generator() { if (h_) h_.destroy(); }
+
+            generator & operator=(const generator &) = delete;
+            generator & operator=(generator && x) {
+                if (this != &x) {
+                    if (h_)
+                        h_.destroy();
+                    h_ = std::exchange(x.h_, nullptr);
+                }
+                return *this;
+            }
+
+            /** runs coroutine up to first co_yield **/
+            iterator begin() {
+                if (h_)
+                    h_.promise().advance(h_);
+                return iterator(h_);
+            }
+
+            std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        private:
+            explicit generator(handle_type h) : h_{h} {}
+
+        private:
+            /** coroutine producing values;  owned by this generator **/
+            handle_type h_;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end generator.hpp */
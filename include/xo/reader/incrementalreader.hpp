@@ -0,0 +1,136 @@
+/* file incrementalreader.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "reader.hpp"
+#include "structindex.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class incremental_stats
+         *  @brief counters from one incrementalreader::read() call
+         **/
+        struct incremental_stats {
+            /** number of toplevel forms in input **/
+            std::size_t n_form_ = 0;
+            /** number of forms whose expressions came from cache **/
+            std::size_t n_reused_ = 0;
+            /** number of forms parsed because their text changed (or is new) **/
+            std::size_t n_changed_ = 0;
+            /** number of unchanged forms parsed because a definition
+             *  they may refer to changed
+             **/
+            std::size_t n_invalidated_ = 0;
+
+            void print(std::ostream & os) const;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const incremental_stats & x) {
+            x.print(os);
+            return os;
+        }
+
+        /** @class incrementalreader
+         *  @brief re-read a translation unit,  reparsing only toplevel forms
+         *         that changed since the previous read
+         *
+         *  Input is cut into toplevel forms at toplevel ';' (see segmenter::boundaries).
+         *  Each form is keyed by a hash of its text,  with leading/trailing
+         *  whitespace dropped and each other run of whitespace counted as
+         *  one space;  whitespace inside string literals counts as-is.
+         *  Expressions for a form whose key matches a form from the previous read
+         *  are reused as-is (same rp<Expression>),  once the form's whitespace-normalized
+         *  text is confirmed equal to the cached form's (so a hash collision
+         *  is treated as a change).  That same pass maps each reused expression's
+         *  span onto the new text,  so spans are right after reindenting.
+         *  Unchanged leading and trailing runs of forms match by position;
+         *  only forms in between are looked up by key,  so the common
+         *  single-edit case costs one hash and one compare per form.
+         *
+         *  Dependencies are tracked conservatively by name:  when a form
+         *  defining @c x is added, removed or changed,  every form containing
+         *  the identifier @c x is reparsed too,  transitively.
+         *
+         *  Every form is parsed as if at the start of a translation unit,
+         *  so results are the same as reader::read_all() over the whole input.
+         **/
+        class incrementalreader {
+        public:
+            using Expression = xo::ast::Expression;
+            using span_type = reader::span_type;
+
+        public:
+            explicit incrementalreader(parserengine engine = parserengine::virtual_dispatch);
+
+            /** counters from last .read() call **/
+            const incremental_stats & last_stats() const { return stats_; }
+
+            /** Read complete translation unit @p input.
+             *  Result spans point into @p input.
+             *  Throws on parse error;  cache then holds forms from
+             *  the last successful read.
+             **/
+            std::vector<reader_result> read(const span_type & input);
+
+            /** forget all cached forms **/
+            void clear() { hash_v_.clear(); form_v_.clear(); }
+
+            /** key for toplevel form @p form,  as described above **/
+            static std::uint64_t form_hash(const span_type & form);
+
+        private:
+            /** expression from a cached form,  with its span given as
+             *  offsets into the form's normalized text (@ref form_entry::norm_),
+             *  so it can be mapped onto any text with the same normalized form
+             **/
+            struct cached_expr {
+                rp<Expression> expr_;
+                std::size_t lo_ = 0;
+                std::size_t hi_ = 0;
+                std::vector<varref> varref_v_;
+            };
+
+            /** cached parse of one toplevel form **/
+            struct form_entry {
+                /** form text,  normalized as for form_hash() **/
+                std::string norm_;
+                /** expressions parsed from this form (usually one) **/
+                std::vector<cached_expr> expr_v_;
+                /** names defined by this form **/
+                std::vector<std::string> def_v_;
+                /** identifiers appearing in this form,  sorted,  unique **/
+                std::vector<std::string> word_v_;
+            };
+
+            /** parse @p form from scratch **/
+            form_entry parse_form(const span_type & form);
+
+            /** true iff @p form has the same normalized text as @p entry.
+             *  If so,  replace *p_span_v with the span,  within @p form,
+             *  of each of @p entry's expressions
+             **/
+            static bool match_form(const span_type & form,
+                                   const form_entry & entry,
+                                   std::vector<span_type> * p_span_v);
+
+        private:
+            /** reader for changed forms **/
+            reader reader_;
+            /** form_hash() of each form from last successful read,  in input order **/
+            std::vector<std::uint64_t> hash_v_;
+            /** parse of each form from last successful read;  parallel to .hash_v_ **/
+            std::vector<form_entry> form_v_;
+
+            incremental_stats stats_;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end incrementalreader.hpp */
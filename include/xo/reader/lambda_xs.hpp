@@ -6,6 +6,8 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
+#include "lazylambda.hpp"
 //#include <cstdint>
 
 namespace xo {
@@ -20,6 +22,12 @@ namespace xo {
          *  lm_1 --on_formal_arglist()--> lm_2
          *  lm_2 --on_expr()--> lm_3
          *  lm_3 --on_semicolon_token()--> (done)
+         *
+         *  With lazy lambda bodies enabled (see parser::enable_lazy_lambda):
+         *
+         *  lm_1 --on_formal_arglist()--> lm_2z
+         *  lm_2z --on_lazy_body(text)--> lm_3  (body kept as text)
+         *  lm_2z --on_lazy_body(empty)--> lm_2 (body parsed as usual)
          **/
         enum class lambdastatetype {
             invalid = -1,
@@ -27,6 +35,7 @@ namespace xo {
             lm_0,
             lm_1,
             lm_2,
+            lm_2z,
             lm_3,
 
             n_lambdastatetype
@@ -45,7 +54,7 @@ namespace xo {
          *  @brief parsing state-machine for a lambda-expression
          *
          **/
-        class lambda_xs : public exprstate {
+        class lambda_xs final : public exprstate {
         public:
             lambda_xs();
 
@@ -55,6 +64,8 @@ namespace xo {
                                          parserstatemachine * p_psm) override;
             virtual void on_formal_arglist(const std::vector<rp<Variable>> & argl,
                                            parserstatemachine * p_psm) override;
+            virtual void on_lazy_body(const span<const char> & body,
+                                      parserstatemachine * p_psm) override;
             virtual void on_expr(ref::brw<Expression> expr,
                                  parserstatemachine * p_psm) override;
             virtual void on_expr_with_semicolon(ref::brw<Expression> expr,
@@ -64,9 +75,6 @@ namespace xo {
 
             virtual void print(std::ostream & os) const override;
 
-        private:
-            static std::unique_ptr<lambda_xs> make();
-
         private:
             /** parsing state-machine state **/
             lambdastatetype lmxs_type_ = lambdastatetype::lm_0;
@@ -76,6 +84,9 @@ namespace xo {
 
             /** body expression **/
             rp<Expression> body_;
+
+            /** replaces .body_ when body kept as text **/
+            rp<LazyLambda> lazy_;
         };
     } /*namespace scm*/
 } /*namespace xo*/
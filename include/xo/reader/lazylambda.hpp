@@ -0,0 +1,121 @@
+/* file lazylambda.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "parserengine.hpp"
+#include "envframe.hpp"
+#include "lexaddr.hpp"
+#include "xo/expression/Lambda.hpp"
+#include <string>
+#include <vector>
+
+namespace xo {
+    namespace scm {
+        /** @class lazylambda_options
+         *  @brief settings of the parser that deferred a lambda body;
+         *         LazyLambda::force parses the body with the same settings
+         **/
+        struct lazylambda_options {
+            /** parser engine **/
+            parserengine engine_ = parserengine::virtual_dispatch;
+            /** true: parse-time constant folding enabled **/
+            bool constant_folding_ = false;
+            /** true: nested lambda bodies are also deferred **/
+            bool lazy_lambda_ = false;
+        };
+
+        /** @class LazyLambda
+         *  @brief lambda expression whose body has not been parsed yet
+         *
+         *  Produced by lambda_xs when lazy lambda bodies are enabled
+         *  (see parser::enable_lazy_lambda).
+         *  Holds formals,  body source text,  and a copy of the
+         *  lexical context (envframes) in which the body appears.
+         *  @ref force parses the body in that context,  and with the
+         *  same parser settings (see @ref lazylambda_options),  giving the same
+         *  Lambda (and the same lexical addresses) as an eager parse would.
+         *  Folds done by force() are not counted in parser::n_folded.
+         *
+         *  Until forced,  extype() is exprtype::invalid and valuetype() is nullptr:
+         *  the body's type isn't known.  Consumers must force() first.
+         *
+         *  Variable references in the body are not reported in
+         *  reader_result::varref_v_;  see @ref varref_v after forcing.
+         *
+         *  Not thread-safe:  force() from one thread at a time.
+         **/
+        class LazyLambda : public xo::ast::Expression {
+        public:
+            using Lambda = xo::ast::Lambda;
+            using Variable = xo::ast::Variable;
+
+        public:
+            /** @p frame_v:  lexical context for body,  bottom of stack first;
+             *  last frame holds the formals @p argl.
+             *  @p body_text:  brace-delimited block.
+             *  @p options:  settings of the parser that read the lambda
+             **/
+            static rp<LazyLambda> make(const std::string & name,
+                                       const std::vector<rp<Variable>> & argl,
+                                       std::vector<envframe> frame_v,
+                                       std::string body_text,
+                                       const lazylambda_options & options);
+
+            /** downcast from @p x;  nullptr if @p x isn't a LazyLambda **/
+            static ref::brw<LazyLambda> from(ref::brw<Expression> x) {
+                return ref::brw<LazyLambda>(dynamic_cast<LazyLambda *>(x.get()));
+            }
+
+            const std::string & name() const { return name_; }
+            const std::vector<rp<Variable>> & argl() const { return argl_; }
+            /** body source,  '{' through '}' **/
+            const std::string & body_text() const { return body_text_; }
+            /** parser settings used by @ref force **/
+            const lazylambda_options & options() const { return options_; }
+
+            /** true once body has been parsed **/
+            bool is_forced() const { return lambda_.get() != nullptr; }
+
+            /** Parse body (first call only),  and return equivalent Lambda.
+             *  Throws if body doesn't parse.
+             **/
+            rp<Lambda> force();
+
+            /** variable references in body,  with lexical addresses
+             *  relative to the body's innermost frame.  Empty until forced
+             **/
+            const std::vector<varref> & varref_v() const { return varref_v_; }
+
+            virtual void display(std::ostream & os) const override;
+
+        private:
+            LazyLambda(const std::string & name,
+                       const std::vector<rp<Variable>> & argl,
+                       std::vector<envframe> frame_v,
+                       std::string body_text,
+                       const lazylambda_options & options);
+
+        private:
+            /** lambda name **/
+            std::string name_;
+            /** formal parameters **/
+            std::vector<rp<Variable>> argl_;
+            /** lexical context for body;  released by force() **/
+            std::vector<envframe> frame_v_;
+            /** body source text **/
+            std::string body_text_;
+            /** parser settings for body **/
+            lazylambda_options options_;
+
+            /** result of force() **/
+            rp<Lambda> lambda_;
+            /** variable references found by force() **/
+            std::vector<varref> varref_v_;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end lazylambda.hpp */
@@ -0,0 +1,81 @@
+/* file lexaddr.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "xo/expression/Variable.hpp"
+#include <ostream>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class lexaddr
+         *  @brief lexical address of a variable reference
+         *
+         *  Locates a lambda formal or block-local definition
+         *  relative to the point of reference:
+         *  - depth_: number of enclosing frames to skip;
+         *            0 -> innermost enclosing frame.
+         *            Counts every enclosing frame,  lambda or block
+         *  - slot_:  position in that frame's @ref envframe::argl
+         *
+         *  A block gets a frame only from its first local def onward,
+         *  so the same name can have different depths before and after
+         *  that def within one block.
+         *
+         *  Lets an evaluator reach a variable by index instead of by name.
+         **/
+        struct lexaddr {
+            lexaddr() = default;
+            lexaddr(std::uint32_t depth, std::uint32_t slot) : depth_{depth}, slot_{slot} {}
+
+            bool operator==(const lexaddr & x) const = default;
+
+            void print(std::ostream & os) const;
+
+            std::uint32_t depth_ = 0;
+            std::uint32_t slot_ = 0;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const lexaddr & x) {
+            x.print(os);
+            return os;
+        }
+
+        /** @class varref
+         *  @brief a variable reference,  along with its lexical address
+         *
+         *  Parser emits a fresh Variable for each reference,
+         *  so that each reference site can carry its own address.
+         *
+         *  Note: this means a reference is never pointer-identical to
+         *  the lambda formal (or local definition) it refers to.
+         *  Consumers that matched a use to its binding by Variable identity
+         *  must instead match by name,  or by lexical address via @ref addr_.
+         **/
+        struct varref {
+            using Variable = xo::ast::Variable;
+
+            varref() = default;
+            varref(rp<Variable> var, lexaddr addr) : var_{std::move(var)}, addr_{addr} {}
+
+            void print(std::ostream & os) const;
+
+            /** variable reference appearing in parsed expression **/
+            rp<Variable> var_;
+            /** location of binding for @ref var_ **/
+            lexaddr addr_;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const varref & x) {
+            x.print(os);
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end lexaddr.hpp */
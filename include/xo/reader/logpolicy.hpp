@@ -0,0 +1,146 @@
+/* file logpolicy.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "xo/indentlog/scope.hpp"
+#include <array>
+#include <atomic>
+#include <ostream>
+
+/** XO_READER_LOGGING: compile-time switch for debug logging in xo_reader.
+ *  Controlled from cmake option XO_READER_ENABLE_LOGGING.
+ *
+ *  - 1: handlers set up a scope for logging;  whether it prints
+ *       is decided at runtime by @ref xo::scm::logpolicy::verbosity
+ *       (and beyond that by indentlog's own log level)
+ *  - 0: XO_READER_SCOPE() expands to a @ref xo::scm::null_scope;
+ *       no scope setup, and arguments to log() are never evaluated.
+ **/
+#ifndef XO_READER_LOGGING
+#  define XO_READER_LOGGING 1
+#endif
+
+namespace xo {
+    namespace scm {
+        /** identifies a group of reader sources that share
+         *  a runtime verbosity level.
+         **/
+        enum class logmodule {
+            /** reader::read_expr() **/
+            reader,
+            /** parser::include_token() **/
+            parser,
+            /** parserstatemachine forwarders **/
+            psm,
+            /** exprstatestack + envframestack push/pop **/
+            stack,
+            /** exprstate default handlers + dispatch **/
+            exprstate,
+            /** expect_expr_xs, expect_symbol_xs **/
+            expect_expr,
+            /** define_xs **/
+            define,
+            /** lambda_xs **/
+            lambda,
+            /** paren_xs **/
+            paren,
+            /** progress_xs **/
+            progress,
+            /** sequence_xs, exprseq_xs **/
+            sequence,
+
+            n_logmodule
+        };
+
+        extern const char *
+        logmodule_descr(logmodule x);
+
+        inline std::ostream &
+        operator<< (std::ostream & os, logmodule x) {
+            os << logmodule_descr(x);
+            return os;
+        }
+
+        /** @class logpolicy
+         *  @brief runtime per-module verbosity for reader logging
+         *
+         *  Verbosity levels:
+         *  - 0: silent
+         *  - 1: log handler entry/exit + state (default)
+         *
+         *  When built with XO_READER_LOGGING=0,  @ref enabled
+         *  is constant-false and verbosity settings have no effect.
+         *
+         *  Verbosity may be changed while reader threads are running
+         *  (e.g. @ref pipelinereader, @ref parallelreader):  settings are
+         *  relaxed atomics,  so a concurrent reader sees either old or new level.
+         **/
+        class logpolicy {
+        public:
+            static constexpr bool c_logging_enabled = XO_READER_LOGGING;
+            static constexpr std::size_t c_n_module
+                = static_cast<std::size_t>(logmodule::n_logmodule);
+
+        public:
+            static int verbosity(logmodule m) {
+                return s_verbosity_v[static_cast<std::size_t>(m)].load(std::memory_order_relaxed);
+            }
+
+            /** true iff logging for module @p m is enabled at level @p level **/
+            static bool enabled(logmodule m, int level = 1) {
+                if constexpr (c_logging_enabled) {
+                    return verbosity(m) >= level;
+                } else {
+                    return false;
+                }
+            }
+
+            /** set verbosity for module @p m **/
+            static void set_verbosity(logmodule m, int level);
+            /** set verbosity for all modules at once **/
+            static void set_verbosity_all(int level);
+
+        private:
+            /** verbosity level, indexed by logmodule **/
+            static std::array<std::atomic<int>, c_n_module> s_verbosity_v;
+        };
+
+        /** @class null_scope
+         *  @brief stand-in for indentlog scope when logging compiled out.
+         *
+         *  Supports the
+         *  @code
+         *    log && log(xtag(..), ..);
+         *  @endcode
+         *  idiom;  since null_scope is always false,  arguments to log()
+         *  are never evaluated.
+         **/
+        struct null_scope {
+            explicit constexpr operator bool() const { return false; }
+
+            template <typename... Tn>
+            constexpr bool operator()(Tn && ...) const { return false; }
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/** declare a logging scope @p name for reader module @p module.
+ *  Remaining arguments (if any) are forwarded to the scope ctor,
+ *  e.g.
+ *  @code
+ *    XO_READER_SCOPE(log, logmodule::parser, xtag("tk", tk));
+ *    log && log(xtag("retval", retval));
+ *  @endcode
+ **/
+#if XO_READER_LOGGING
+#  define XO_READER_SCOPE(name, module, ...) \
+    scope name(XO_DEBUG(::xo::scm::logpolicy::enabled(module)) __VA_OPT__(,) __VA_ARGS__)
+#else
+#  define XO_READER_SCOPE(name, module, ...) \
+    [[maybe_unused]] ::xo::scm::null_scope name
+#endif
+
+/* end logpolicy.hpp */
@@ -0,0 +1,62 @@
+/* file mapped_file.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "xo/tokenizer/span.hpp"
+#include <string>
+#include <cstddef>
+
+namespace xo {
+    namespace scm {
+        /** @class mapped_file
+         *  @brief read-only memory mapping of an entire file
+         *
+         *  Contents are read straight from the page cache;  no copy into
+         *  a user-space buffer.  Mapping is advised for sequential access.
+         *
+         *  Spans into @ref contents remain valid until the mapped_file
+         *  is destroyed.
+         **/
+        class mapped_file {
+        public:
+            using span_type = span<const char>;
+
+        public:
+            /** map file at @p path.  Throws std::runtime_error on failure **/
+            static mapped_file open(const std::string & path);
+
+            mapped_file() = default;
+            mapped_file(const mapped_file &) = delete;
+            mapped_file(mapped_file && x);
+            ~mapped_file();
+
+            mapped_file & operator=(const mapped_file &) = delete;
+            mapped_file & operator=(mapped_file && x);
+
+            const std::string & path() const { return path_; }
+            std::size_t size() const { return size_; }
+            /** entire file contents **/
+            span_type contents() const { return span_type(lo_, lo_ + size_); }
+
+        private:
+            mapped_file(std::string path, const char * lo, std::size_t z)
+                : path_{std::move(path)}, lo_{lo}, size_{z} {}
+
+            /** release mapping,  if any **/
+            void unmap();
+
+        private:
+            /** path given to @ref open **/
+            std::string path_;
+            /** start of mapping;  nullptr for empty file **/
+            const char * lo_ = nullptr;
+            /** file size in bytes **/
+            std::size_t size_ = 0;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end mapped_file.hpp */
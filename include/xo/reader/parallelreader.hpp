@@ -0,0 +1,126 @@
+/* file parallelreader.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "reader.hpp"
+#include "concurrentsymboltable.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xo {
+    namespace scm {
+        /** @class parallel_result
+         *  @brief outcome of reading one input with @ref parallelreader
+         **/
+        struct parallel_result {
+            /** file contents,  when input was a file.
+             *  Spans in .result_v_ point into this mapping
+             **/
+            mapped_file file_;
+            /** toplevel expressions,  in input order **/
+            std::vector<reader_result> result_v_;
+            /** empty on success;  otherwise reason input could not be read.
+             *  .result_v_ holds expressions preceding the error
+             **/
+            std::string error_;
+        };
+
+        /** @class split_stats
+         *  @brief counters from parallelreader::read_split
+         **/
+        struct split_stats {
+            /** number of segments parsed speculatively **/
+            std::size_t n_segment_ = 0;
+            /** number of segments re-read serially,  after a bad cut (or parse error) **/
+            std::size_t n_reparse_ = 0;
+        };
+
+        /** @class parallelreader
+         *  @brief read many independent translation units concurrently
+         *
+         *  Each input is one task.  Worker threads take the next
+         *  unstarted task from a shared atomic cursor,  so a thread that
+         *  finishes early takes on more work.
+         *
+         *  Each worker owns one @ref reader,  reused across tasks and
+         *  across calls,  so parser stacks keep their capacity.
+         *  All workers' readers share one @ref concurrentsymboltable.
+         *
+         *  Results are returned in input order.
+         *
+         *  Can also split one large input at guessed toplevel boundaries
+         *  (see @ref segmenter),  and parse the pieces concurrently,
+         *  see @ref read_split
+         **/
+        class parallelreader {
+        public:
+            using span_type = reader::span_type;
+
+        public:
+            /** @p n_thread: number of worker threads;  0 -> hardware concurrency **/
+            explicit parallelreader(std::size_t n_thread = 0,
+                                    parserengine engine = parserengine::virtual_dispatch);
+            ~parallelreader();
+
+            std::size_t n_thread() const { return reader_v_.size(); }
+
+            /** symbols interned by all workers **/
+            const concurrentsymboltable & symtab() const { return symtab_; }
+
+            /** read each of @p input_v as a separate translation unit.
+             *  Input text must outlive results' spans
+             **/
+            std::vector<parallel_result> read_buffers(const std::vector<span_type> & input_v);
+
+            /** read (memory-mapped) files in @p path_v,  each as a separate translation unit **/
+            std::vector<parallel_result> read_files(const std::vector<std::string> & path_v);
+
+            /** read one translation unit @p input,  split into about @p n_segment
+             *  pieces at toplevel boundaries found by @ref segmenter.
+             *  @p n_segment = 0 -> 4 per thread.
+             *
+             *  Result is the same as reading @p input serially.
+             **/
+            parallel_result read_split(const span_type & input, std::size_t n_segment = 0);
+
+            /** read one translation unit @p input,  cut at offsets @p cut_v
+             *  (strictly increasing,  each in (0, input.size())).
+             *  Pieces are parsed concurrently by independent readers.
+             *
+             *  A piece that fails to parse means its cut (either end) is wrong,
+             *  or the input has an error:  re-read from start of that piece,
+             *  serially,  until reaching a cut at which the reader is between
+             *  toplevel expressions;  speculative results resume from there.
+             **/
+            parallel_result read_split(const span_type & input,
+                                       const std::vector<std::size_t> & cut_v);
+
+            /** counters from last .read_split() call **/
+            const split_stats & last_split_stats() const { return split_stats_; }
+
+        private:
+            /** run @p task(reader *, i) for i in [0, n),  on worker threads **/
+            template <typename Task>
+            void run(std::size_t n, Task && task);
+
+            /** read @p input into @p *p_result using @p p_reader **/
+            static void read_one(reader * p_reader,
+                                 const span_type & input,
+                                 parallel_result * p_result);
+
+        private:
+            /** intern table shared by all workers **/
+            concurrentsymboltable symtab_;
+            /** reader_v_[k]: reader for worker k **/
+            std::vector<std::unique_ptr<reader>> reader_v_;
+            /** counters from last .read_split() call **/
+            split_stats split_stats_;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end parallelreader.hpp */
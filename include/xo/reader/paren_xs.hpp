@@ -6,6 +6,7 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
 //#include <cstdint>
 
 namespace xo {
@@ -31,7 +32,7 @@ namespace xo {
         /** @class paren_xs
          *  @brief state machine for handling parentheses in expressions
          **/
-        class paren_xs : public exprstate {
+        class paren_xs final : public exprstate {
         public:
             paren_xs();
             virtual ~paren_xs() = default;
@@ -69,9 +70,6 @@ namespace xo {
 
             virtual void print(std::ostream & os) const override;
 
-        private:
-            static std::unique_ptr<paren_xs> make();
-
         private:
             /**
              *  ( foo ... )
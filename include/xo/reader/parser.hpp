@@ -6,11 +6,57 @@
 #pragma once
 
 #include "exprstatestack.hpp"
+#include "variantstatestack.hpp"
 #include "envframestack.hpp"
+#include "constfolder.hpp"
+#include "parserengine.hpp"
+#include "parserstatemachine.hpp"
 #include <stdexcept>
 
 namespace xo {
     namespace scm {
+        class parserstatemachine;
+
+        /** @class parser_checkpoint
+         *  @brief saved parser state,  see parser::checkpoint
+         *
+         *  Holds a copy of each exprstate and environment frame.
+         *  Their bulky contents -- expressions already collected by an open
+         *  block,  pending operands and operators of an infix expression,
+         *  every frame's formals and local definitions -- are copy-on-write
+         *  (see @ref cowvector) and shared with the parser:
+         *  - taking a checkpoint is O(stack depth + frame depth);
+         *  - after it,  the parser's next change to each such container
+         *    copies at most one chunk of it;
+         *  - restoring is O(depth),  plus rebinding names for frames
+         *    pushed,  popped or extended since the checkpoint.
+         *  So repeated checkpoints inside a long block stay cheap.
+         *
+         *  A checkpoint may be restored any number of times,
+         *  and works with either parserengine.
+         *  It shares memory from its parser's resources,
+         *  so must not outlive that parser.
+         **/
+        class parser_checkpoint {
+        public:
+            parser_checkpoint() = default;
+
+            /** number of exprstates saved **/
+            std::size_t stack_size() const { return xs_v_.size(); }
+
+        private:
+            friend class parser;
+
+            /** copy of each exprstate,  bottom of stack first **/
+            std::vector<exprstatevariant> xs_v_;
+            /** copy of environment frames,  bottom of stack first **/
+            std::vector<envframe> frame_v_;
+            /** size of parser::varref_v() when saved **/
+            std::size_t n_varref_ = 0;
+            /** lazy lambda-body request pending when saved **/
+            bool lazy_pending_ = false;
+        };
+
         /** schematica parser
          *
          *  Examples:
@@ -148,37 +194,115 @@ namespace xo {
             /** create parser in initial state;
              *  parser is ready to receive tokens via @ref include_token
              **/
-            parser() = default;
+            explicit parser(parserengine engine = parserengine::virtual_dispatch)
+                : engine_{engine} {}
+
+            parserengine engine() const { return engine_; }
 
             /** for diagnostics: number of entries in parser stack **/
-            std::size_t stack_size() const { return xs_stack_.size(); }
+            std::size_t stack_size() const {
+                if (engine_ == parserengine::variant_dispatch)
+                    return vxs_stack_.size();
+                else
+                    return xs_stack_.size();
+            }
+
             /** for diagnostics: exprstatetype at level @p i
              *  (taken relative to top of stack)
              *
              *  @pre 0 <= i < stack_size
              **/
             exprstatetype i_exstype(std::size_t i) const {
-                std::size_t z = xs_stack_.size();
+                exprstate const * xs = this->i_exstate(i);
 
-                if (i < z) {
-                    return xs_stack_[i]->exs_type();
-                }
+                if (xs)
+                    return xs->exs_type();
 
                 /* out of bounds */
                 return exprstatetype::invalid;
             }
 
-            exprstate const * i_exstate(std::size_t i) const {
-                std::size_t z = xs_stack_.size();
+            /** for diagnostics: allocation counters for parser states.
+             *  Only counts states for parserengine::virtual_dispatch
+             **/
+            const exprstatepool_stats & xs_pool_stats() const { return xs_stack_.pool_stats(); }
+
+            /** enable/disable collecting @ref stats (disabled by default).
+             *  No effect when built with XO_READER_STATS=0
+             **/
+            void enable_stats(bool x) { stats_enabled_ = x && parserstats::c_stats_enabled; }
+            /** true iff parser is collecting @ref stats **/
+            bool stats_enabled() const { return stats_enabled_; }
+            /** counters collected while stats enabled;  see @ref parserstats **/
+            const parserstats & stats() const { return stats_; }
+            /** reset @ref stats **/
+            void clear_stats() { stats_.clear(); }
 
-                if (i < z) {
-                    return xs_stack_[i].get();
+            /** charge allocations to @p account (nullptr to detach).
+             *  Exprstates (virtual_dispatch),  stack segments (variant_dispatch)
+             *  and exprstate-owned vectors are counted as they are allocated;
+             *  other categories are estimates,  see @ref alloccategory.
+             *  May be called at any time.  @p account must outlive parsing
+             *  done while attached;  it may be destroyed before the parser
+             **/
+            void attach_allocaccount(allocaccount * account);
+
+            exprstate const * i_exstate(std::size_t i) const {
+                if (i < this->stack_size()) {
+                    if (engine_ == parserengine::variant_dispatch)
+                        return &vxs_stack_[i];
+                    else
+                        return xs_stack_[i].get();
                 }
 
                 /* out of bounds */
                 return nullptr;
             }
 
+            /** variable references (with lexical addresses) in expressions
+             *  parsed since last call to @ref clear_varrefs,  in input order
+             **/
+            const std::vector<varref> & varref_v() const { return varref_v_; }
+            /** discard contents of @ref varref_v **/
+            void clear_varrefs() { varref_v_.clear(); }
+            /** remove and return contents of @ref varref_v;
+             *  leaves @ref varref_v empty.  Avoids copying references
+             *  for each emitted expression
+             **/
+            std::vector<varref> take_varrefs() {
+                std::vector<varref> retval;
+                retval.swap(varref_v_);
+                return retval;
+            }
+
+            /** enable/disable parse-time constant folding,
+             *  see @ref constfolder
+             **/
+            void enable_constant_folding(bool x) { folder_.set_enabled(x); }
+            /** true iff parse-time constant folding enabled **/
+            bool constant_folding_enabled() const { return folder_.enabled(); }
+            /** number of operator nodes removed by constant folding **/
+            std::size_t n_folded() const { return folder_.n_folded(); }
+
+            /** enable/disable lazy lambda bodies.
+             *  When enabled,  a lambda whose body is a brace-delimited block
+             *  asks its driver for the body as source text (see @ref lazy_body_pending),
+             *  and becomes a @ref LazyLambda,  parsed on first use.
+             *  Driver may decline by sending the next token instead.
+             **/
+            void enable_lazy_lambda(bool x) { lazy_.enabled_ = x; }
+            /** true iff lazy lambda bodies enabled **/
+            bool lazy_lambda_enabled() const { return lazy_.enabled_; }
+            /** true iff parser wants next lambda body as text,
+             *  via @ref include_lazy_body
+             **/
+            bool lazy_body_pending() const { return lazy_.pending_; }
+
+            /** share symbol ids with other parsers via @p shared (nullptr to detach).
+             *  Call between translation units
+             **/
+            void attach_symtab(concurrentsymboltable * shared) { env_stack_.attach_symtab(shared); }
+
             /** true iff parser contains state for an incomplete expression.
              *  For this to be true,  parser must have consumed at least one token
              *  since end of last toplevel expression
@@ -198,10 +322,74 @@ namespace xo {
              **/
             rp<Expression> include_token(const token_type & tk);
 
+            /** supply source text @p body for lambda body,
+             *  after lazy_body_pending() reports true.
+             *  @p body is a complete brace-delimited block,
+             *  or empty to decline (body tokens then follow as usual).
+             *
+             *  @return parsed expression, if any (currently always nullptr)
+             **/
+            rp<Expression> include_lazy_body(const span<const char> & body);
+
+            /** put parser into state for parsing one lambda body out of line,
+             *  in lexical context @p frame_v (bottom of stack first,
+             *  innermost frame holding the lambda's formals).
+             *  Body expression is returned from include_token(),
+             *  like a toplevel expression.
+             *  See LazyLambda::force
+             **/
+            void begin_lambda_body(const std::vector<envframe> & frame_v);
+
+            /** save parser state,  for later @ref restore.
+             *  Copies every exprstate and envframe,  sharing their contents:
+             *  cost is O(depth),  see @ref parser_checkpoint.
+             *
+             *  Use to try a continuation and roll back on error:
+             *  @code
+             *    parser_checkpoint cp = parser.checkpoint();
+             *    try {
+             *      for (const auto & tk : line)
+             *        parser.include_token(tk);
+             *    } catch (std::exception & ex) {
+             *      parser.restore(cp);
+             *    }
+             *  @endcode
+             *  or to look ahead speculatively and rewind without replaying tokens.
+             **/
+            parser_checkpoint checkpoint() const;
+
+            /** put parser back into state saved in @p cp,
+             *  taken from this parser.
+             *  Copies @p cp's exprstates back onto parser stack (contents shared),
+             *  keeps envframes unchanged since @p cp,  and rebinds names
+             *  only for frames that changed:  see @ref parser_checkpoint.
+             *  Not counted in @ref stats.
+             *  Expressions emitted since @p cp was taken are unaffected;
+             *  varref_v() is truncated to its size when @p cp was taken.
+             *  Constant-folding counter is not rolled back.
+             **/
+            void restore(const parser_checkpoint & cp);
+
             /** print human-readable representation on stream @p os **/
             void print(std::ostream & os) const;
 
         private:
+            /** psm operating on this parser's stacks.
+             *  Complete toplevel expressions go to @p p_emit_expr
+             **/
+            parserstatemachine make_psm(rp<Expression> * p_emit_expr);
+
+        private:
+            /** exprstate storage + dispatch strategy **/
+            parserengine engine_ = parserengine::virtual_dispatch;
+
+            /** memory for exprstate-owned containers,  counted when
+             *  an allocaccount is attached.  Exprstates hold pointers to this:
+             *  declared before both stacks so it outlives them
+             **/
+            countingresource xs_resource_{nullptr, alloccategory::exprstate,
+                                          std::pmr::new_delete_resource()};
+
             /** state recording state associated with enclosing expressions.
              *
              *  Note: at least asof c++23, the std::stack api doesn't support access
@@ -212,6 +400,8 @@ namespace xo {
              *  - top of stack is stack_[N-1]
              **/
             exprstatestack xs_stack_;
+            /** replaces @ref xs_stack_ when engine is parserengine::variant_dispatch **/
+            variantstatestack vxs_stack_;
 
             /** environment frames for lexical context.
              *  push a frame on each nested lambda;
@@ -219,6 +409,23 @@ namespace xo {
              **/
             envframestack env_stack_;
 
+            /** variable references + lexical addresses, see @ref varref_v **/
+            std::vector<varref> varref_v_;
+
+            /** parse-time constant folding (disabled by default) **/
+            constfolder folder_;
+
+            /** lazy lambda-body setting (disabled by default) + pending request **/
+            lazybody_state lazy_;
+
+            /** true: update .stats_ (never true when built with XO_READER_STATS=0) **/
+            bool stats_enabled_ = false;
+            /** parser counters,  see @ref enable_stats **/
+            parserstats stats_;
+
+            /** if non-null,  allocation accounting,  see @ref attach_allocaccount **/
+            allocaccount * alloc_ = nullptr;
+
         }; /*parser*/
 
         inline std::ostream &
@@ -0,0 +1,38 @@
+/* file parserengine.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include <ostream>
+
+namespace xo {
+    namespace scm {
+        /** selects how parser stores and dispatches to its exprstates
+         **/
+        enum class parserengine {
+            /** exprstates are pooled heap objects in an @ref exprstatestack;
+             *  events delivered by virtual call
+             **/
+            virtual_dispatch,
+            /** exprstates stored inline in a @ref variantstatestack;
+             *  events delivered by std::visit
+             **/
+            variant_dispatch,
+
+            n_parserengine
+        };
+
+        extern const char *
+        parserengine_descr(parserengine x);
+
+        inline std::ostream &
+        operator<< (std::ostream & os, parserengine x) {
+            os << parserengine_descr(x);
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end parserengine.hpp */
@@ -5,68 +5,225 @@
 
 #pragma once
 
+#include "parserengine.hpp"
 #include "exprstate.hpp"
+#include "exprstatestack.hpp"
+#include "variantstatestack.hpp"
 #include "envframestack.hpp"
+#include "constfolder.hpp"
+#include "parserstats.hpp"
+#include "allocaccount.hpp"
 
 namespace xo {
     namespace scm {
+        /** @class lazybody_state
+         *  @brief lazy lambda-body setting,  and handshake between
+         *         lambda_xs and the driver supplying tokens (e.g. @ref reader)
+         **/
+        struct lazybody_state {
+            /** true: lambda_xs may ask for a brace-delimited body as text,
+             *  and produce a @ref LazyLambda
+             **/
+            bool enabled_ = false;
+            /** true: top exprstate waits for on_lazy_body(),
+             *  which must precede the next token
+             **/
+            bool pending_ = false;
+        };
+
         /** @class parserstatemachine
          *  @brief public parser state.
          *
          *  Schematica parser state; sent to subsidiary single-feature state machines.
          *  For example entry points for the lambda feature (@ref lambda_xs)
          *  will accept a non-const parserstatemachine pointer argument
+         *
+         *  Exprstates live on exactly one of two stacks,  depending on parser engine:
+         *  - @ref exprstatestack: pooled heap objects, virtual dispatch
+         *  - @ref variantstatestack: inline std::variant storage, dispatch by std::visit
+         *
+         *  Exprstates should send all events through parserstatemachine
+         *  (e.g. @ref on_expr, @ref on_semicolon_token),  not through @ref top_exprstate,
+         *  so they work with either engine.
          **/
         class parserstatemachine {
         public:
             using Expression = xo::ast::Expression;
             using Variable = xo::ast::Variable;
+            using TypeDescr = xo::reflect::TypeDescr;
             using token_type = token<char>;
 
         public:
             parserstatemachine(exprstatestack * p_stack,
+                               variantstatestack * p_vstack,
                                envframestack * p_env_stack,
+                               std::vector<varref> * p_varref_v,
+                               constfolder * p_folder,
+                               lazybody_state * p_lazy,
+                               parserstats * p_stats,
+                               allocaccount * p_alloc,
+                               std::pmr::memory_resource * p_xs_resource,
                                rp<Expression> * p_emit_expr)
                 : p_stack_{p_stack},
+                  p_vstack_{p_vstack},
                   p_env_stack_{p_env_stack},
+                  p_varref_v_{p_varref_v},
+                  p_folder_{p_folder},
+                  p_lazy_{p_lazy},
+                  p_stats_{p_stats},
+                  p_alloc_{p_alloc},
+                  p_xs_resource_{p_xs_resource},
                   p_emit_expr_{p_emit_expr} {}
 
-            std::unique_ptr<exprstate> pop_exprstate();
+            /** true iff stack of incomplete parser work is empty **/
+            bool empty_exprstate() const;
+
+            /** push new exprstate of type @p T,  constructed from @p args **/
+            template <typename T, typename... Args>
+            void push_new_exprstate(Args && ... args) {
+                if (p_vstack_) {
+                    p_vstack_->emplace_exprstate<T>(std::forward<Args>(args)...);
+                } else {
+                    p_stack_->push_exprstate
+                        (p_stack_->make_exprstate<T>(std::forward<Args>(args)...));
+                }
+
+                if (parserstats * stats = this->stats())
+                    stats->on_push(this->top_exprstate().exs_type(),
+                                   p_vstack_ ? p_vstack_->size() : p_stack_->size());
+            }
+
+            /** remove and destroy top exprstate.
+             *
+             *  When called from a handler on the top exprstate,
+             *  that handler must not touch its own members afterwards.
+             **/
+            void pop_exprstate();
+
+            /** top exprstate.  For diagnostics;  to deliver events use forwarders below **/
             exprstate & top_exprstate();
-            void push_exprstate(std::unique_ptr<exprstate> x);
 
             /** lookup variable name in lexical context represented by
              *  this psm.  nullptr if not found
              **/
-            rp<Variable> lookup_var(const std::string & x) const;
+            rp<Variable> lookup_var(std::string_view x) const;
+
+            /** resolve a reference to variable @p x.
+             *  Return a new Variable for this reference site,  and record
+             *  its lexical address in *p_varref_v_.
+             *  nullptr if @p x not found
+             **/
+            rp<Variable> make_varref(std::string_view x);
 
             void push_envframe(envframe x);
             void pop_envframe();
+            /** add local definition @p var to innermost envframe **/
+            void extend_envframe(const rp<Variable> & var);
+
+            /** engine of the parser driving this state machine **/
+            parserengine engine() const {
+                return (p_vstack_
+                        ? parserengine::variant_dispatch
+                        : parserengine::virtual_dispatch);
+            }
+            /** true iff parse-time constant folding enabled **/
+            bool constant_folding_enabled() const { return p_folder_ && p_folder_->enabled(); }
+
+            /** true iff lambda bodies may be deferred,  see @ref LazyLambda **/
+            bool lazy_lambda_enabled() const { return p_lazy_ && p_lazy_->enabled_; }
+            /** ask driver to deliver next lambda body as text,  via on_lazy_body().
+             *  @pre lazy_lambda_enabled()
+             **/
+            void request_lazy_body() { p_lazy_->pending_ = true; }
+
+            /** counters to update;  nullptr if not collecting.
+             *  Constant nullptr when built with XO_READER_STATS=0
+             **/
+            parserstats * stats() const {
+                if constexpr (parserstats::c_stats_enabled)
+                    return p_stats_;
+                else
+                    return nullptr;
+            }
+
+            /** charge allocation of @p z bytes to category @p c,
+             *  if parser has an @ref allocaccount
+             **/
+            void note_alloc(alloccategory c, std::size_t z) {
+                if (p_alloc_)
+                    p_alloc_->note(c, z);
+            }
+
+            /** memory for containers owned by exprstates (e.g. @ref progress_xs);
+             *  counted under alloccategory::exprstate when parser has an allocaccount
+             **/
+            std::pmr::memory_resource * xs_resource() const {
+                return p_xs_resource_ ? p_xs_resource_ : std::pmr::new_delete_resource();
+            }
 
             // ----- parsing outputs -----
 
             void on_expr(ref::brw<Expression> expr);
             void on_expr_with_semicolon(ref::brw<Expression> expr);
             void on_symbol(const std::string & symbol);
+            void on_typedescr(TypeDescr td);
+            void on_formal(const rp<Variable> & formal);
+            void on_formal_arglist(const std::vector<rp<Variable>> & argl);
+            void on_lazy_body(const span<const char> & body);
 
             // ---- parsing inputs -----
 
+            /** deliver token @p tk to top exprstate **/
+            void on_input(const token_type & tk);
+
+            void on_def_token(const token_type & tk);
+            void on_lambda_token(const token_type & tk);
             void on_semicolon_token(const token_type & tk);
             void on_operator_token(const token_type & tk);
             void on_leftbrace_token(const token_type & tk);
             void on_rightbrace_token(const token_type & tk);
+            void on_rightparen_token(const token_type & tk);
 
             /** write human-readable representation on @p os **/
             void print(std::ostream & os) const;
 
+        private:
+            /** invoke @p fn on top exprstate (with concrete type, for variant engine) **/
+            template <typename Fn>
+            void visit_top(Fn && fn) {
+                if (p_vstack_)
+                    p_vstack_->visit_top(std::forward<Fn>(fn));
+                else
+                    fn(p_stack_->top_exprstate());
+            }
+
         public:
             /** stack of incomplete parser work.
              *  generally speaking, push when to start new work for nested content;
-             *  pop when work complete
+             *  pop when work complete.
+             *  nullptr when parser uses variant engine
              **/
             exprstatestack * p_stack_;
-            /** stack of environment frames, one for each enclosing lambda **/
+            /** stack of incomplete parser work,  for variant engine.
+             *  nullptr when parser uses virtual engine
+             **/
+            variantstatestack * p_vstack_;
+            /** stack of environment frames, one for each enclosing lambda
+             *  or block with local definitions
+             **/
             envframestack * p_env_stack_;
+            /** if non-null,  append variable references + their lexical addresses here **/
+            std::vector<varref> * p_varref_v_;
+            /** if non-null,  parse-time constant folding for infix expressions **/
+            constfolder * p_folder_;
+            /** if non-null,  lazy lambda-body setting + pending request **/
+            lazybody_state * p_lazy_;
+            /** if non-null,  parser counters **/
+            parserstats * p_stats_;
+            /** if non-null,  allocation accounting **/
+            allocaccount * p_alloc_;
+            /** if non-null,  memory for exprstate-owned containers,  see @ref xs_resource **/
+            std::pmr::memory_resource * p_xs_resource_;
             /** if non-null,  store next non-nested complete expressions in
              *  *p_emit_expr
              **/
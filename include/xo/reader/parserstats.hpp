@@ -0,0 +1,138 @@
+/* file parserstats.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "exprstate.hpp"
+#include <array>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+/** XO_READER_STATS: compile-time switch for parser counters.
+ *  Controlled from cmake option XO_READER_ENABLE_STATS.
+ *
+ *  - 1: parser collects @ref xo::scm::parserstats when
+ *       enabled at runtime,  see parser::enable_stats
+ *  - 0: counting code is compiled out;  parser::stats() stays zero
+ **/
+#ifndef XO_READER_STATS
+#  define XO_READER_STATS 0
+#endif
+
+namespace xo {
+    namespace scm {
+        /** @class parserstats
+         *  @brief counters describing parser work,  by construct
+         *
+         *  Collected by a parser with stats enabled,
+         *  through its @ref parserstatemachine.
+         **/
+        struct parserstats {
+            static constexpr bool c_stats_enabled = XO_READER_STATS;
+            static constexpr std::size_t c_n_exstype
+                = static_cast<std::size_t>(exprstatetype::n_exprstatetype);
+            /** histogram size.  last bucket counts everything at or above it **/
+            static constexpr std::size_t c_n_bucket = 32;
+
+            using histogram_type = std::array<std::uint64_t, c_n_bucket>;
+
+            /** exprstates pushed,  by exprstatetype **/
+            std::array<std::uint64_t, c_n_exstype> push_v_ = {};
+            /** exprstates popped,  by exprstatetype **/
+            std::array<std::uint64_t, c_n_exstype> pop_v_ = {};
+
+            /** max exprstate stack depth **/
+            std::size_t max_xs_depth_ = 0;
+            /** xs_depth_hist_[k]: #of pushes leaving exprstate stack with depth k **/
+            histogram_type xs_depth_hist_ = {};
+
+            /** max environment frame stack depth **/
+            std::size_t max_env_depth_ = 0;
+
+            /** #of variable lookups **/
+            std::uint64_t n_lookup_ = 0;
+            /** #of variable lookups that found no binding **/
+            std::uint64_t n_lookup_miss_ = 0;
+            /** lookup_depth_hist_[k]: #of resolved variable references
+             *  whose binding is k frames out from innermost.
+             *  Lookup itself is constant-time (see @ref envframestack);
+             *  this is the #of frames a chained search would probe
+             **/
+            histogram_type lookup_depth_hist_ = {};
+
+            /** #of toplevel expressions emitted **/
+            std::uint64_t n_toplevel_ = 0;
+            /** #of expressions delivered between parser states (psm on_expr),
+             *  over all toplevel forms
+             **/
+            std::uint64_t n_expr_ = 0;
+            /** max expressions delivered for one toplevel form **/
+            std::uint64_t max_expr_per_toplevel_ = 0;
+            /** expressions delivered so far for current toplevel form **/
+            std::uint64_t expr_in_toplevel_ = 0;
+
+            static std::size_t bucket(std::size_t k) {
+                return (k < c_n_bucket) ? k : c_n_bucket - 1;
+            }
+
+            void on_push(exprstatetype t, std::size_t depth) {
+                std::size_t i = static_cast<std::size_t>(t);
+                if (i < c_n_exstype)
+                    ++(push_v_[i]);
+                if (depth > max_xs_depth_)
+                    max_xs_depth_ = depth;
+                ++(xs_depth_hist_[bucket(depth)]);
+            }
+
+            void on_pop(exprstatetype t) {
+                std::size_t i = static_cast<std::size_t>(t);
+                if (i < c_n_exstype)
+                    ++(pop_v_[i]);
+            }
+
+            void on_push_envframe(std::size_t depth) {
+                if (depth > max_env_depth_)
+                    max_env_depth_ = depth;
+            }
+
+            void on_lookup_miss() {
+                ++n_lookup_;
+                ++n_lookup_miss_;
+            }
+
+            /** found binding @p depth frames out **/
+            void on_lookup_hit(std::size_t depth) {
+                ++n_lookup_;
+                ++(lookup_depth_hist_[bucket(depth)]);
+            }
+
+            void on_expr() {
+                ++n_expr_;
+                ++expr_in_toplevel_;
+            }
+
+            void on_toplevel() {
+                ++n_toplevel_;
+                if (expr_in_toplevel_ > max_expr_per_toplevel_)
+                    max_expr_per_toplevel_ = expr_in_toplevel_;
+                expr_in_toplevel_ = 0;
+            }
+
+            /** reset all counters **/
+            void clear() { *this = parserstats(); }
+
+            void print(std::ostream & os) const;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const parserstats & x) {
+            x.print(os);
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end parserstats.hpp */
@@ -0,0 +1,182 @@
+/* file pipelinereader.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "reader.hpp"
+#include "spscring.hpp"
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class pipeline_stats
+         *  @brief counters from one pipelinereader::read_all() call
+         **/
+        struct pipeline_stats {
+            /** number of tokens passed from tokenizer to parser **/
+            std::size_t n_token_ = 0;
+            /** tokenizer stage elapsed time,  excluding time blocked on full ring **/
+            std::uint64_t tokenize_busy_ns_ = 0;
+            /** parser stage elapsed time,  excluding time blocked on empty ring **/
+            std::uint64_t parse_busy_ns_ = 0;
+            /** number of times tokenizer found ring full **/
+            std::size_t n_producer_stall_ = 0;
+            /** number of times parser found ring empty **/
+            std::size_t n_consumer_stall_ = 0;
+            /** sum of ring occupancy,  sampled by parser at each token **/
+            std::uint64_t occupancy_sum_ = 0;
+            /** max ring occupancy seen by parser **/
+            std::size_t occupancy_max_ = 0;
+
+            /** mean ring occupancy seen by parser **/
+            double mean_occupancy() const {
+                return n_token_ ? double(occupancy_sum_) / n_token_ : 0.0;
+            }
+
+            void print(std::ostream & os) const;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const pipeline_stats & x) {
+            x.print(os);
+            return os;
+        }
+
+        /** @class pipelinereader
+         *  @brief reader that tokenizes and parses on separate threads
+         *
+         *  Tokenizer runs on a helper thread,  and sends tokens
+         *  to the calling thread through a bounded @ref spscring;
+         *  parser runs on the calling thread.
+         *  Stages share nothing but the token stream.
+         *
+         *  Intended for large,  complete inputs.
+         *  Results are identical to reader::read_all() with eof=true.
+         **/
+        class pipelinereader {
+        public:
+            using tokenizer_type = reader::tokenizer_type;
+            using span_type = reader::span_type;
+            using token_type = token<char>;
+
+            /** default ring capacity (#of tokens) **/
+            static constexpr std::size_t c_default_capacity = 4096;
+
+        public:
+            explicit pipelinereader(std::size_t capacity = c_default_capacity,
+                                    parserengine engine = parserengine::virtual_dispatch);
+
+            /** counters from last .read_all() call **/
+            const pipeline_stats & stats() const { return stats_; }
+
+            /** Read all expressions in @p input,  which must be a complete
+             *  translation unit (i.e. eof follows @p input).
+             *  Invoke @p sink(reader_result &&) on each,  in input order,
+             *  on the calling thread.
+             *
+             *  Throws on parse/tokenize error,  after stopping tokenizer thread.
+             *
+             *  @return number of expressions delivered to @p sink
+             **/
+            template <typename Sink>
+            std::size_t read_all(const span_type & input, Sink && sink);
+
+        private:
+            /** ring entry: token along with the input it consumed **/
+            struct tokenslot {
+                token_type tk_;
+                span_type used_;
+                /** true for the last entry from tokenizer **/
+                bool end_ = false;
+            };
+
+            /** prepare for new input;  launch tokenizer thread on @p input **/
+            void start(const span_type & input);
+            /** tokenizer thread body **/
+            void produce(span_type input);
+            /** next entry from tokenizer;  blocks while ring is empty **/
+            tokenslot pop_slot();
+            /** join tokenizer thread,  collect its stats **/
+            void join();
+            /** end of input reached:  report incomplete expr or tokenizer error **/
+            void finish();
+
+        private:
+            /** tokens from tokenizer thread to parser **/
+            spscring<tokenslot> ring_;
+            /** tokenizer stage;  used only by tokenizer thread **/
+            tokenizer_type tokenizer_;
+            /** parser stage;  used only by calling thread **/
+            parser parser_;
+
+            /** tokenizer thread,  while read_all() in progress **/
+            std::thread producer_;
+            /** set by parser to stop tokenizer early **/
+            std::atomic<bool> cancel_{false};
+            /** error raised on tokenizer thread **/
+            std::exception_ptr producer_error_;
+            /** tokenizer-side counters;  merged into .stats_ by join() **/
+            pipeline_stats producer_stats_;
+
+            /** start time for current .read_all() **/
+            std::chrono::steady_clock::time_point t0_;
+            /** time parser spent blocked on empty ring **/
+            std::uint64_t consumer_wait_ns_ = 0;
+
+            pipeline_stats stats_;
+        };
+
+        template <typename Sink>
+        std::size_t
+        pipelinereader::read_all(const span_type & input, Sink && sink)
+        {
+            this->start(input);
+
+            std::size_t n_expr = 0;
+
+            try {
+                span_type expr_span = input.prefix(0ul);
+
+                for (;;) {
+                    tokenslot slot = this->pop_slot();
+
+                    if (slot.end_)
+                        break;
+
+                    expr_span += slot.used_;
+
+                    if (!slot.tk_.is_valid())
+                        continue;
+
+                    auto expr = this->parser_.include_token(slot.tk_);
+
+                    if (expr) {
+                        reader_result rr(expr, expr_span, parser_.take_varrefs());
+
+                        expr_span = span_type(expr_span.hi(), expr_span.hi());
+
+                        sink(std::move(rr));
+                        ++n_expr;
+                    }
+                }
+            } catch (...) {
+                this->cancel_.store(true, std::memory_order_relaxed);
+                this->join();
+                throw;
+            }
+
+            this->join();
+            this->finish();
+
+            return n_expr;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end pipelinereader.hpp */
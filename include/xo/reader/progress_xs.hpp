@@ -6,7 +6,11 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
+#include "cowvector.hpp"
 #include <iostream>
+#include <vector>
+#include <memory_resource>
 //#include <cstdint>
 
 namespace xo {
@@ -19,12 +23,38 @@ namespace xo {
         enum class optype {
             invalid = -1,
 
+            /** := **/
             op_assign,
 
+            /** | **/
+            op_bitor,
+            /** ^ **/
+            op_bitxor,
+            /** & **/
+            op_bitand,
+
+            /** == **/
+            op_equal,
+            /** != **/
+            op_not_equal,
+
+            /** < **/
+            op_less,
+            /** <= **/
+            op_less_equal,
+            /** > **/
+            op_greater,
+            /** >= **/
+            op_greater_equal,
+
+            /** + **/
             op_add,
+            /** - **/
             op_subtract,
 
+            /** * **/
             op_multiply,
+            /** / **/
             op_divide,
 
             n_optype
@@ -33,40 +63,75 @@ namespace xo {
         extern const char *
         optype_descr(optype x);
 
-        /** report operator precedence.
-         *  lowest operator precedence is 1
-         **/
-        extern int
-        precedence(optype x);
-
         inline std::ostream &
         operator<< (std::ostream & os, optype x) {
             os << optype_descr(x);
             return os;
         }
 
+        /** associativity of an infix operator **/
+        enum class opassoc {
+            /** a . b . c = (a . b) . c **/
+            left,
+            /** a . b . c = a . (b . c) **/
+            right,
+        };
+
+        /** report operator precedence.
+         *  lowest operator precedence is 1.
+         *  See @ref s_opinfo_v in progress_xs.cpp
+         **/
+        extern int
+        precedence(optype x);
+
+        /** report operator associativity **/
+        extern opassoc
+        associativity(optype x);
+
+        /** infix operator for token type @p tktype;
+         *  optype::invalid if @p tktype isn't an infix operator
+         **/
+        extern optype
+        tk2op(tokentype tktype);
+
         /** @class progress_xs
          *  @brief state machine for parsing a schematica runtime-value-expression
+         *
+         *  Handles a complete infix expression,  e.g.
+         *  @code
+         *    a + b * c - d
+         *  @endcode
+         *  by operator-precedence (shunting-yard) parsing in a single state:
+         *  progress_xs keeps its own operand + operator stacks,
+         *  and reduces when an incoming operator binds no tighter than the one on top.
+         *
+         *  Each operand is parsed by an @ref expect_expr_xs in operand mode,
+         *  which reports back via @ref on_expr.  Parser stack depth doesn't
+         *  grow with length of an operator chain.
          **/
-        class progress_xs : public exprstate {
+        class progress_xs final : public exprstate {
         public:
-            progress_xs(rp<Expression> valex, optype op);
+            /** operand + operator stacks get memory from @p mr;  copies share it **/
+            progress_xs(rp<Expression> valex, std::pmr::memory_resource * mr);
             virtual ~progress_xs() = default;
 
             static const progress_xs * from(const exprstate * x) {
                 return dynamic_cast<const progress_xs *>(x);
             }
 
-            static void start(rp<Expression> valex,
-                              optype optype,
-                              parserstatemachine * p_psm);
+            /** start infix expression with first operand @p valex **/
             static void start(rp<Expression> valex,
                               parserstatemachine * p_psm);
 
             bool admits_f64() const;
 
+            /** true iff last input was an operator **/
+            bool expecting_operand() const { return operand_v_.size() == op_v_.size(); }
+
             virtual void on_expr(ref::brw<Expression> expr,
                                  parserstatemachine * p_psm) override;
+            virtual void on_expr_with_semicolon(ref::brw<Expression> expr,
+                                                parserstatemachine * p_psm) override;
             virtual void on_symbol_token(const token_type & tk,
                                          parserstatemachine * p_psm) override;
             virtual void on_typedescr(TypeDescr td,
@@ -94,30 +159,43 @@ namespace xo {
 
             virtual void print(std::ostream & os) const override;
 
-        private:
-            static std::unique_ptr<progress_xs> make(rp<Expression> valex,
-                                                     optype optype = optype::invalid);
-
         private:
             /** assemble expression representing
-             *  value of
+             *  value of the complete infix expression;
+             *  reduces all pending operators.
+             **/
+            rp<Expression> assemble_expr(parserstatemachine * p_psm);
+
+            /** replace top two operands x, y with single operand for
              *  @code
-             *    f(lhs_, rhs_)
+             *    x op y
              *  @endcode
-             *
-             *  where f determined by @ref op_type_
+             *  where op is top of @ref op_v_.
+             *  Folds constants if enabled in @p p_psm.
+             *  Charges an estimate of the new node's size to alloccategory::expression
              **/
-            rp<Expression> assemble_expr();
+            void reduce_top(parserstatemachine * p_psm);
 
-        private:
-            /** populate an expression here, may be followed by an operator **/
-            rp<Expression> lhs_;
+            /** expression for
+             *  @code
+             *    lhs op rhs
+             *  @endcode
+             **/
+            static rp<Expression> make_binop(optype op,
+                                             rp<Expression> lhs,
+                                             rp<Expression> rhs);
 
-            /** infix operator,  if supplied **/
-            optype op_type_ = optype::invalid;
+        private:
+            /** operands not yet consumed by an operator.
+             *  operand_v_[i+1] follows op_v_[i] in input.
+             *  Copy-on-write (as is .op_v_),  so copying this state is O(1)
+             **/
+            cowvector<rp<Expression>> operand_v_;
 
-            /** populate an expression here, following infix operator */
-            rp<Expression> rhs_;
+            /** pending infix operators,  in strictly increasing binding order
+             *  (except for runs of right-associative operators)
+             **/
+            cowvector<optype> op_v_;
         };
     } /*namespace scm*/
 } /*namespace xo*/
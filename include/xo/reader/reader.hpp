@@ -6,11 +6,17 @@
 #pragma once
 
 #include "parser.hpp"
+#include "mapped_file.hpp"
+#include "generator.hpp"
 #include "xo/expression/Expression.hpp"
 #include "xo/tokenizer/tokenizer.hpp"
 
 namespace xo {
     namespace scm {
+        class astcache; /* see astcache.hpp */
+        class tokenrecorder; /* see tokenrecord.hpp */
+        class readerperf; /* see readerperf.hpp */
+
         /** @class parse_result
          *  @brief Result object returned from reader::read_expr
          **/
@@ -20,14 +26,49 @@ namespace xo {
 
             reader_result(rp<Expression> expr, span_type rem)
                 : expr_{std::move(expr)}, rem_{rem} {}
+            reader_result(rp<Expression> expr, span_type rem, std::vector<varref> varref_v)
+                : expr_{std::move(expr)}, rem_{rem}, varref_v_{std::move(varref_v)} {}
 
-            /** parsed schematica expression **/
+            /** parsed schematica expression.
+             *  If a DefineExpr,  a toplevel definition;
+             *  DefineExprs nested in a Sequence are block-local,
+             *  see @ref sequence_xs
+             **/
             rp<Expression> expr_;
             /** span giving text input consumed to construct expr,
              *  including any leading whitespace.
              *  This is the span returned in result of tokenizer<char>::scan()
              **/
             span_type rem_;
+            /** variable references appearing in expr_,  in input order,
+             *  with their lexical addresses.
+             *  Each reference is a distinct Variable instance:
+             *  not the same object as the formal it refers to,
+             *  even though name and type agree.  See @ref varref
+             **/
+            std::vector<varref> varref_v_;
+        };
+
+        /** @class read_file_result
+         *  @brief Result object returned from reader::read_file
+         **/
+        struct read_file_result {
+            /** file contents.  Spans in .result_v_ point into this mapping **/
+            mapped_file file_;
+            /** toplevel expressions in file,  in order **/
+            std::vector<reader_result> result_v_;
+        };
+
+        /** @class reader_chunk
+         *  @brief a piece of input text,  as supplied to reader::read_lazy
+         **/
+        struct reader_chunk {
+            using span_type = span<const char>;
+
+            /** input text.  Must remain valid until the next chunk is requested **/
+            span_type text_;
+            /** true iff no input follows .text_ **/
+            bool eof_ = false;
         };
 
         /**
@@ -58,6 +99,14 @@ namespace xo {
          *    // expect !rdr.has_prefix()
          *
          *  @endcode
+         *
+         *  Or,  to drain each input buffer in one call:
+         *  @code
+         *    std::vector<reader_result> result_v;
+         *    result_v.reserve(..);
+         *
+         *    rdr.read_all(input, eof, &result_v);
+         *  @endcode
          **/
         class reader {
         public:
@@ -65,11 +114,62 @@ namespace xo {
             using span_type = tokenizer_type::span_type;
 
         public:
-            reader() = default;
+            explicit reader(parserengine engine = parserengine::virtual_dispatch)
+                : parser_{engine} {}
+
+            /** enable/disable parse-time constant folding **/
+            void enable_constant_folding(bool x) { parser_.enable_constant_folding(x); }
+            /** number of operator nodes removed by constant folding **/
+            std::size_t n_folded() const { return parser_.n_folded(); }
+            /** enable/disable lazy lambda bodies.
+             *  When enabled,  a lambda body written as a {..} block
+             *  is skipped by brace matching (no tokens, no AST),
+             *  and the lambda is read as a @ref LazyLambda.
+             *  A body not complete within the current input span
+             *  is parsed eagerly instead.
+             **/
+            void enable_lazy_lambda(bool x) { parser_.enable_lazy_lambda(x); }
+            /** share symbol ids with other readers via @p shared,
+             *  see parser::attach_symtab
+             **/
+            void attach_symtab(concurrentsymboltable * shared) { parser_.attach_symtab(shared); }
+            /** use @p cache (nullptr to detach) in @ref read_file:
+             *  a file whose text has a cached image is not tokenized or parsed;
+             *  other files are parsed as usual,  then stored in @p cache.
+             *  Images are kept separately for each combination of
+             *  constant-folding and lazy-lambda settings
+             **/
+            void attach_astcache(astcache * cache) { astcache_ = cache; }
+            /** record parser input to @p recorder (nullptr to detach):
+             *  each token,  and each lazy lambda body,  given to the parser
+             *  from now on.  See @ref tokenreplay
+             **/
+            void attach_tokenrecorder(tokenrecorder * recorder) { recorder_ = recorder; }
+            /** charge hardware counters to @p perf (nullptr to detach),
+             *  split between tokenizer and parser work in @ref read_expr.
+             *  @p perf must belong to the thread calling read_expr
+             **/
+            void attach_readerperf(readerperf * perf) { perf_ = perf; }
+            /** charge reader allocations to @p account (nullptr to detach),
+             *  counting each translation unit separately.
+             *  See @ref allocaccount.  Call before begin_translation_unit
+             *  so the first translation unit is counted from its start.
+             *  @p account must outlive reading done while attached;
+             *  it may be destroyed before this reader
+             **/
+            void attach_allocaccount(allocaccount * account);
+
+            /** true iff reader holds input for an expression (or token)
+             *  not yet complete
+             **/
+            bool has_incomplete_expr() const {
+                return parser_.has_incomplete_expr() || tokenizer_.has_prefix();
+            }
 
             /** call once before calling .read_expr():
              *  1. with new reader
              *  2. if last read_expr() call had eof=true
+             *  3. after an error;  discards tokenizer and parser state
              **/
             void begin_translation_unit();
 
@@ -94,13 +194,167 @@ namespace xo {
              **/
             reader_result read_expr(const span_type & input, bool eof);
 
+            /** Read all complete expressions from @p input.
+             *  Invoke @p sink(reader_result &&) on each,  in input order.
+             *  Each result's @c rem_ covers that expression's tokens,
+             *  along with leading whitespace;  together they partition
+             *  the consumed prefix of @p input.
+             *
+             *  Trailing input that does not complete an expression
+             *  is retained by the reader,  to be completed by a later call
+             *  (same as @ref read_expr).
+             *
+             *  @return number of expressions delivered to @p sink
+             **/
+            template <typename Sink>
+            std::size_t read_all(const span_type & input, bool eof, Sink && sink);
+
+            /** Read all complete expressions from @p input,
+             *  appending them to @p *p_result_v.
+             *  Caller may reserve space in @p *p_result_v up front.
+             *
+             *  @return number of expressions appended
+             **/
+            std::size_t read_all(const span_type & input, bool eof,
+                                 std::vector<reader_result> * p_result_v);
+
+            /** Read translation unit from file at @p path.
+             *  File is memory-mapped read-only,  and presented to the tokenizer
+             *  as a single span with eof=true:  no copy, no chunk boundaries.
+             *  Starts a new translation unit.
+             *  Uses attached @ref astcache,  if any.
+             *
+             *  Source spans in result are valid while result's .file_ is.
+             **/
+            read_file_result read_file(const std::string & path);
+
+            /** Read translation unit from file at @p path,
+             *  invoking @p sink(reader_result &&) on each toplevel expression.
+             *  Mapping is released before return;  source spans given to @p sink
+             *  are valid only during that call.
+             *
+             *  @return number of expressions delivered to @p sink
+             **/
+            template <typename Sink>
+            std::size_t read_file(const std::string & path, Sink && sink);
+
+            /** Lazily read a translation unit.
+             *  Input comes from @p source:  a callable returning @ref reader_chunk.
+             *  @p source is invoked whenever the reader has used all of
+             *  the previous chunk,  and not after a chunk with eof.
+             *
+             *  Coroutine frame owns reader (tokenizer + parser state),
+             *  so each stream costs one frame, not one thread.
+             *  Coroutine suspends after each expression.
+             *
+             *  Use:
+             *  @code
+             *    for (reader_result & rr : reader::read_lazy(source)) {
+             *        ..
+             *    }
+             *  @endcode
+             **/
+            template <typename Source>
+            static generator<reader_result> read_lazy(Source source,
+                                                      parserengine engine = parserengine::virtual_dispatch);
+
+        private:
+            /** reader settings that change expressions produced for the same text;
+             *  part of astcache key
+             **/
+            std::uint32_t astcache_flags() const;
+
         private:
             /** tokenizer: text -> tokens **/
             tokenizer_type tokenizer_;
 
             /** parser: tokens -> expressions **/
             parser parser_;
+
+            /** if non-null,  cache of parsed files for @ref read_file **/
+            astcache * astcache_ = nullptr;
+
+            /** if non-null,  receives a copy of parser input **/
+            tokenrecorder * recorder_ = nullptr;
+
+            /** if non-null,  hardware counters by reader phase **/
+            readerperf * perf_ = nullptr;
+
+            /** if non-null,  allocation accounting **/
+            allocaccount * alloc_ = nullptr;
         };
+
+        template <typename Sink>
+        std::size_t
+        reader::read_all(const span_type & input, bool eof, Sink && sink)
+        {
+            std::size_t n_expr = 0;
+
+            for (span_type rem = input; ; ) {
+                reader_result rr = this->read_expr(rem, eof);
+
+                /* no expr -> rem exhausted;  at eof, read_expr also verified
+                 * nothing incomplete remains
+                 */
+                if (!rr.expr_)
+                    break;
+
+                rem = rem.after_prefix(rr.rem_);
+
+                sink(std::move(rr));
+                ++n_expr;
+            }
+
+            return n_expr;
+        }
+
+        template <typename Source>
+        generator<reader_result>
+        reader::read_lazy(Source source, parserengine engine)
+        {
+            reader rdr(engine);
+            rdr.begin_translation_unit();
+
+            for (;;) {
+                reader_chunk chunk = source();
+
+                for (span_type rem = chunk.text_; ; ) {
+                    reader_result rr = rdr.read_expr(rem, chunk.eof_);
+
+                    /* no expr -> need more input */
+                    if (!rr.expr_)
+                        break;
+
+                    rem = rem.after_prefix(rr.rem_);
+
+                    co_yield std::move(rr);
+                }
+
+                if (chunk.eof_)
+                    co_return;
+            }
+        }
+
+        template <typename Sink>
+        std::size_t
+        reader::read_file(const std::string & path, Sink && sink)
+        {
+            if (astcache_) {
+                read_file_result result = this->read_file(path);
+
+                for (reader_result & rr : result.result_v_)
+                    sink(std::move(rr));
+
+                return result.result_v_.size();
+            }
+
+            mapped_file file = mapped_file::open(path);
+
+            this->begin_translation_unit();
+
+            return this->read_all(file.contents(), true /*eof*/,
+                                  std::forward<Sink>(sink));
+        }
     } /*namespace scm*/
 } /*namespace xo*/
 
@@ -0,0 +1,197 @@
+/* file readerperf.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include <array>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** hardware events counted by @ref perfcounters **/
+        enum class perfevent {
+            cycles,
+            instructions,
+            branch_misses,
+            /** L1 data cache read misses **/
+            l1d_misses,
+            /** last-level cache read misses **/
+            llc_misses,
+
+            n_perfevent
+        };
+
+        extern const char *
+        perfevent_descr(perfevent x);
+
+        inline std::ostream &
+        operator<< (std::ostream & os, perfevent x) {
+            os << perfevent_descr(x);
+            return os;
+        }
+
+        /** @class perfsample
+         *  @brief one value per @ref perfevent
+         **/
+        struct perfsample {
+            static constexpr std::size_t c_n_event
+                = static_cast<std::size_t>(perfevent::n_perfevent);
+
+            std::uint64_t operator[](perfevent x) const { return v_[static_cast<std::size_t>(x)]; }
+
+            perfsample & operator+= (const perfsample & x) {
+                for (std::size_t i = 0; i < c_n_event; ++i)
+                    v_[i] += x.v_[i];
+                return *this;
+            }
+
+            perfsample operator- (const perfsample & x) const {
+                perfsample retval;
+                for (std::size_t i = 0; i < c_n_event; ++i)
+                    retval.v_[i] = v_[i] - x.v_[i];
+                return retval;
+            }
+
+            /** instructions per cycle;  0 if no cycles counted **/
+            double ipc() const {
+                std::uint64_t n = (*this)[perfevent::cycles];
+                return n ? double((*this)[perfevent::instructions]) / double(n) : 0.0;
+            }
+
+            void print(std::ostream & os) const;
+
+            std::array<std::uint64_t, c_n_event> v_ = {};
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const perfsample & x) {
+            x.print(os);
+            return os;
+        }
+
+        /** @class perfcounters
+         *  @brief group of hardware counters for the calling thread
+         *         (Linux perf_event_open)
+         *
+         *  Counts user-space events only.  Counters form one group
+         *  (led by cycles),  so the kernel schedules them together.
+         *
+         *  Never throws for lack of counters:  if perf_event_open is
+         *  unavailable (non-Linux, container, perf_event_paranoid,
+         *  no PMU) @ref available is false and @ref read returns zeros.
+         *  Individual events the hardware lacks read as zero;
+         *  see @ref has.
+         **/
+        class perfcounters {
+        public:
+            perfcounters();
+            perfcounters(const perfcounters &) = delete;
+            perfcounters & operator=(const perfcounters &) = delete;
+            ~perfcounters();
+
+            /** true iff at least cycles are being counted **/
+            bool available() const { return fd_v_[0] >= 0; }
+            /** true iff event @p x is being counted **/
+            bool has(perfevent x) const { return fd_v_[static_cast<std::size_t>(x)] >= 0; }
+
+            /** current counter values (running totals since construction) **/
+            perfsample read() const;
+
+        private:
+            /** fd_v_[i]: perf fd for event i,  -1 if not counted.
+             *  fd_v_[0] (cycles) is group leader
+             **/
+            std::array<int, perfsample::c_n_event> fd_v_;
+            /** #of events in group,  = #of non-negative fds **/
+            std::size_t n_open_ = 0;
+        };
+
+        /** reader work that @ref readerperf attributes counters to **/
+        enum class readerphase {
+            /** outside reader::read_expr **/
+            idle,
+            /** tokenizer (scan2),  or brace matching for a lazy lambda body **/
+            tokenize,
+            /** parser (include_token / include_lazy_body) **/
+            parse,
+
+            n_readerphase
+        };
+
+        /** @class readerperf
+         *  @brief hardware counters for a @ref reader,  split by @ref readerphase
+         *
+         *  Attach with reader::attach_readerperf.
+         *  Reader marks each phase change;  counters are read at each mark,
+         *  so every token costs two extra read(2) calls.
+         *  Use for attribution,  not for timing the reader itself.
+         *
+         *  Counts the thread that constructed this readerperf.
+         **/
+        class readerperf {
+        public:
+            /** restores idle phase on scope exit **/
+            class scope {
+            public:
+                explicit scope(readerperf * p) : p_{p} {}
+                ~scope() { if (p_) p_->enter(readerphase::idle); }
+
+            private:
+                readerperf * p_;
+            };
+
+        public:
+            readerperf() = default;
+
+            /** true iff hardware counters are available **/
+            bool available() const { return counters_.available(); }
+            bool has(perfevent x) const { return counters_.has(x); }
+
+            /** switch to phase @p x,  charging counts since last switch
+             *  to the previous phase
+             **/
+            void enter(readerphase x);
+
+            /** count one token delivered to parser **/
+            void count_token() { ++n_token_; }
+
+            /** counts accumulated in phase @p x **/
+            const perfsample & phase(readerphase x) const {
+                return phase_v_[static_cast<std::size_t>(x)];
+            }
+            /** #of tokens counted **/
+            std::uint64_t n_token() const { return n_token_; }
+
+            /** reset accumulated counts **/
+            void clear();
+
+            void print(std::ostream & os) const;
+
+        private:
+            static constexpr std::size_t c_n_phase
+                = static_cast<std::size_t>(readerphase::n_readerphase);
+
+            perfcounters counters_;
+            /** phase that began at .last_ **/
+            readerphase current_ = readerphase::idle;
+            /** counter values at last phase switch **/
+            perfsample last_;
+            /** accumulated counts,  indexed by readerphase **/
+            std::array<perfsample, c_n_phase> phase_v_;
+            /** tokens delivered to parser **/
+            std::uint64_t n_token_ = 0;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const readerperf & x) {
+            x.print(os);
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end readerperf.hpp */
@@ -0,0 +1,63 @@
+/* file segmenter.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "structindex.hpp"
+#include "xo/tokenizer/span.hpp"
+#include <vector>
+#include <cstddef>
+
+namespace xo {
+    namespace scm {
+        /** @class segmenter
+         *  @brief find cut points between toplevel forms,  without tokenizing
+         *
+         *  A toplevel boundary is the position just after a ';'
+         *  at paren/brace/bracket depth zero,  outside a string literal.
+         *  Boundaries come from a @ref structscanner pass over the input.
+         *
+         *  This is a guess:  the scan doesn't know the full grammar
+         *  (e.g. a ';' inside a comment would fool it).
+         *  Callers must verify a cut by parsing either side of it,
+         *  see parallelreader::read_split
+         **/
+        class segmenter {
+        public:
+            using span_type = span<const char>;
+
+        public:
+            /** Choose cut points dividing @p input into about @p n_segment
+             *  pieces of similar size.
+             *  Each cut is the first toplevel boundary at or after
+             *  an evenly-spaced target offset.
+             *
+             *  @return strictly increasing offsets into @p input,
+             *          each in (0, input.size());  at most n_segment - 1 of them
+             **/
+            static std::vector<std::size_t> split(const span_type & input,
+                                                  std::size_t n_segment,
+                                                  simdlevel level = structscanner::best_simdlevel());
+
+            /** All toplevel boundaries in @p input.
+             *
+             *  @return strictly increasing offsets into @p input,  each in (0, input.size()]
+             **/
+            static std::vector<std::size_t> boundaries(const span_type & input,
+                                                       simdlevel level = structscanner::best_simdlevel());
+
+            /** Find brace-delimited block at the start of @p input,
+             *  after any whitespace.  Braces inside string literals don't count.
+             *
+             *  @return span from '{' to its matching '}' inclusive;
+             *          empty if @p input doesn't begin with '{',
+             *          or the block isn't closed within @p input
+             **/
+            static span_type leading_block(const span_type & input);
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end segmenter.hpp */
@@ -6,19 +6,49 @@
 #pragma once
 
 #include "exprstate.hpp"
+#include "exprstatepool.hpp"
+#include "cowvector.hpp"
 #include <vector>
 
 namespace xo {
     namespace ast { class Sequence; }
-    namespace ast { class Lambda; }
 
     namespace scm {
-        class sequence_xs : public exprstate {
+        /** @class sequence_xs
+         *  @brief parse a block  { expr1; expr2; ... }
+         *
+         *  Local definitions stay in the block as DefineExpr elements:
+         *
+         *    { def x = e1; def y = e2; body... }
+         *
+         *  becomes one flat
+         *
+         *    Sequence(DefineExpr(x, e1), DefineExpr(y, e2), body...)
+         *
+         *  with sequential scoping:  each definition is visible
+         *  to expressions after it (e2 may refer to x),  but not to its own rhs.
+         *  On first local definition,  block pushes an envframe;
+         *  locals occupy slots in that frame in definition order.
+         *
+         *  Contract for AST consumers:  there is no separate node type
+         *  for a local binding,  so locality is given by position.
+         *  - A DefineExpr returned directly by the reader
+         *    (reader_result::expr_) is a toplevel (global) definition.
+         *  - A DefineExpr appearing as an element of a Sequence is local
+         *    to that Sequence:  it is in scope for the Sequence elements
+         *    after it,  and nowhere else.  References to it carry a
+         *    lexical address (see @ref varref),  never a global name.
+         *  A consumer that handles DefineExpr must not install
+         *  Sequence-element definitions as globals.
+         **/
+        class sequence_xs final : public exprstate {
         public:
             using Sequence = xo::ast::Sequence;
-            using Lambda = xo::ast::Lambda;
 
         public:
+            /** block contents get memory from @p mr;  copies share it **/
+            explicit sequence_xs(std::pmr::memory_resource * mr);
+
             /** start parsing a sequence-expr.
              *  input begins with first expression in the sequence.
              **/
@@ -26,19 +56,20 @@ namespace xo {
 
             virtual void on_expr(ref::brw<Expression> expr,
                                  parserstatemachine * p_psm) override;
+            /** expression terminated by ';',  e.g. the y in  { def y = 1.0; y; } **/
+            virtual void on_expr_with_semicolon(ref::brw<Expression> expr,
+                                                parserstatemachine * p_psm) override;
 
             virtual void on_rightbrace_token(const token_type & tk,
                                              parserstatemachine * p_psm) override;
 
         private:
-            sequence_xs();
-
-            /** named ctor idiom **/
-            static std::unique_ptr<sequence_xs> make();
-
-        private:
-            /** will build SequenceExpr from in-order contents of this vector **/
-            std::vector<rp<Expression>> expr_v_;
+            /** will build SequenceExpr from in-order contents of this vector.
+             *  Copy-on-write,  so copying this state (parser::checkpoint) is O(1)
+             **/
+            cowvector<rp<Expression>> expr_v_;
+            /** true once this block has pushed an envframe for its local definitions **/
+            bool has_envframe_ = false;
         };
     } /*namespace scm*/
 } /*namespace xo*/
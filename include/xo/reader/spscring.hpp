@@ -0,0 +1,109 @@
+/* file spscring.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+namespace xo {
+    namespace scm {
+        /** @class spscring
+         *  @brief bounded lock-free single-producer / single-consumer queue
+         *
+         *  Exactly one thread may call @ref try_push,  and exactly one
+         *  (possibly different) thread may call @ref try_pop.
+         *
+         *  Capacity is rounded up to a power of 2.
+         *  Producer and consumer indices live on separate cache lines;
+         *  each side caches the other's index,  and only re-reads
+         *  the shared atomic when the cached value says full/empty.
+         **/
+        template <typename T>
+        class spscring {
+        public:
+            /** assumed cache line size **/
+            static constexpr std::size_t c_cacheline = 64;
+
+        public:
+            explicit spscring(std::size_t capacity)
+                : buf_v_(round_up_pow2(capacity)),
+                  mask_{buf_v_.size() - 1}
+                {}
+
+            spscring(const spscring &) = delete;
+            spscring & operator=(const spscring &) = delete;
+
+            std::size_t capacity() const { return buf_v_.size(); }
+
+            /** #of elements in ring.  Exact only when neither side is active **/
+            std::size_t size_approx() const {
+                return (tail_.load(std::memory_order_acquire)
+                        - head_.load(std::memory_order_acquire));
+            }
+
+            /** producer only.  Move @p x into ring;  false if ring full **/
+            bool try_push(T && x) {
+                std::size_t tail = tail_.load(std::memory_order_relaxed);
+
+                if (tail - head_cache_ == buf_v_.size()) {
+                    head_cache_ = head_.load(std::memory_order_acquire);
+
+                    if (tail - head_cache_ == buf_v_.size())
+                        return false;
+                }
+
+                buf_v_[tail & mask_] = std::move(x);
+                tail_.store(tail + 1, std::memory_order_release);
+
+                return true;
+            }
+
+            /** consumer only.  Move front element into @p *p_x;  false if ring empty **/
+            bool try_pop(T * p_x) {
+                std::size_t head = head_.load(std::memory_order_relaxed);
+
+                if (head == tail_cache_) {
+                    tail_cache_ = tail_.load(std::memory_order_acquire);
+
+                    if (head == tail_cache_)
+                        return false;
+                }
+
+                *p_x = std::move(buf_v_[head & mask_]);
+                head_.store(head + 1, std::memory_order_release);
+
+                return true;
+            }
+
+        private:
+            static std::size_t round_up_pow2(std::size_t n) {
+                std::size_t z = 1;
+                while (z < n)
+                    z *= 2;
+                return z;
+            }
+
+        private:
+            /** element storage **/
+            std::vector<T> buf_v_;
+            /** buf_v_.size() - 1 **/
+            std::size_t mask_ = 0;
+
+            /** next slot to pop.  written by consumer **/
+            alignas(c_cacheline) std::atomic<std::size_t> head_{0};
+            /** consumer's copy of .tail_ **/
+            std::size_t tail_cache_ = 0;
+
+            /** next slot to push.  written by producer **/
+            alignas(c_cacheline) std::atomic<std::size_t> tail_{0};
+            /** producer's copy of .head_ **/
+            std::size_t head_cache_ = 0;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end spscring.hpp */
@@ -0,0 +1,132 @@
+/* file structindex.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "xo/tokenizer/span.hpp"
+#include <ostream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace xo {
+    namespace scm {
+        /** instruction set used by @ref structscanner **/
+        enum class simdlevel {
+            /** one byte at a time;  reference implementation **/
+            scalar,
+            /** 16-byte compares;  baseline on x86_64 **/
+            sse2,
+            /** 32-byte compares;  chosen at runtime when cpu supports it **/
+            avx2,
+
+            n_simdlevel
+        };
+
+        extern const char *
+        simdlevel_descr(simdlevel x);
+
+        inline std::ostream &
+        operator<< (std::ostream & os, simdlevel x) {
+            os << simdlevel_descr(x);
+            return os;
+        }
+
+        /** @class structindex
+         *  @brief offsets of structural characters in some input,
+         *         along with nesting depth at each
+         *
+         *  Structural characters are
+         *  - ( ) { } [ ] ;  outside string literals
+         *  - " that opens or closes a string literal
+         *
+         *  A character preceded by an odd-length run of backslashes is escaped,
+         *  and never structural.
+         **/
+        struct structindex {
+            std::size_t size() const { return pos_v_.size(); }
+
+            void clear() {
+                pos_v_.clear();
+                depth_v_.clear();
+            }
+
+            /** offset of each structural character,  in increasing order **/
+            std::vector<std::uint32_t> pos_v_;
+            /** depth_v_[k]: paren+brace+bracket depth just after
+             *  the character at pos_v_[k].  Negative on stray closers
+             **/
+            std::vector<std::int32_t> depth_v_;
+        };
+
+        /** @class structscanner
+         *  @brief build a @ref structindex without tokenizing,
+         *         64 input bytes per step
+         *
+         *  Each 64-byte block becomes a set of 64-bit masks
+         *  (one bit per byte:  quote, backslash, structural);
+         *  escape and string-literal masks are derived from them with
+         *  carry/prefix-xor arithmetic,  then set bits are
+         *  extracted with count-trailing-zeros.
+         *  Only the compare step depends on @ref simdlevel.
+         *
+         *  Input may be presented in pieces;  scanner carries
+         *  in-string / escape / depth state from one call to the next.
+         *  Offsets count from the start of the first piece after reset().
+         *  Total input per reset must be < 4GB.
+         **/
+        class structscanner {
+        public:
+            using span_type = span<const char>;
+
+            /** bytes per block **/
+            static constexpr std::size_t c_block_size = 64;
+
+        public:
+            /** best level supported by running cpu **/
+            static simdlevel best_simdlevel();
+
+            /** Convenience: index all of @p input in one call **/
+            static structindex index(const span_type & input,
+                                     simdlevel level = best_simdlevel());
+
+            explicit structscanner(simdlevel level = best_simdlevel());
+
+            simdlevel level() const { return level_; }
+            /** true while scanner is inside a string literal **/
+            bool in_string() const { return prev_in_string_ != 0; }
+            /** nesting depth at end of input seen so far **/
+            std::int32_t depth() const { return depth_; }
+            /** #of input bytes seen since reset **/
+            std::uint64_t offset() const { return offset_; }
+
+            /** forget carried state;  next scan() starts a new input at offset 0 **/
+            void reset();
+
+            /** Append structurals in @p input to @p *p_index.
+             *  @p input.size() must be a multiple of c_block_size,
+             *  except on the last piece of an input.
+             **/
+            void scan(const span_type & input, structindex * p_index);
+
+        private:
+            /** scan exactly one block at @p p **/
+            void scan_block(const char * p, structindex * p_index);
+
+        private:
+            simdlevel level_;
+            /** bit 0 set if first byte of next block is escaped **/
+            std::uint64_t prev_escaped_ = 0;
+            /** all ones if next block begins inside a string literal **/
+            std::uint64_t prev_in_string_ = 0;
+            /** nesting depth at end of last block **/
+            std::int32_t depth_ = 0;
+            /** offset of next block **/
+            std::uint64_t offset_ = 0;
+        };
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end structindex.hpp */
@@ -0,0 +1,95 @@
+/* file symboltable.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <string_view>
+#include <string>
+#include <deque>
+#include <ostream>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        class concurrentsymboltable;
+
+        /** compact identifier for an interned name.
+         *  Ids are dense: assigned 0, 1, 2, .. in order of first appearance
+         **/
+        using symbolid = std::uint32_t;
+
+        /** sentinel: no such symbol **/
+        static constexpr symbolid c_invalid_symbolid = ~symbolid(0);
+
+        /** @class symboltable
+         *  @brief intern table: name <-> symbolid
+         *
+         *  Each distinct name is hashed and copied once (on first @ref intern);
+         *  afterwards it's identified by a small integer,
+         *  suitable for indexing a vector.
+         *
+         *  Not thread-safe.
+         *  Several threads can agree on ids by attaching their symboltables
+         *  to one @ref concurrentsymboltable,  see @ref attach_shared
+         **/
+        class symboltable {
+        public:
+            symboltable() = default;
+            symboltable(const symboltable &) = delete;
+            symboltable & operator=(const symboltable &) = delete;
+
+            /** number of distinct names interned
+             *  (when attached:  interned in shared table,  by any thread)
+             **/
+            std::size_t size() const;
+
+            /** shared table,  if attached **/
+            concurrentsymboltable * shared() const { return shared_; }
+
+            /** take ids from @p shared (or from this table, if nullptr).
+             *  This table then only caches lookups,  so that
+             *  the shared table is consulted once per distinct name.
+             *  Forgets names already interned here.
+             **/
+            void attach_shared(concurrentsymboltable * shared);
+
+            /** id for @p name,  assigning a new one if not already interned **/
+            symbolid intern(std::string_view name);
+
+            /** id for @p name if already interned;  c_invalid_symbolid otherwise.
+             *  When attached,  an id found in the shared table is cached here
+             **/
+            symbolid find(std::string_view name) const;
+
+            /** name with id @p id.
+             *  @pre @p id obtained from this symboltable
+             **/
+            const std::string & name(symbolid id) const;
+
+            void print(std::ostream & os) const;
+
+        private:
+            /** if non-null: authoritative table.  ids come from here **/
+            concurrentsymboltable * shared_ = nullptr;
+            /** name_v_[id]: name with symbol id @p id.
+             *  deque so names don't move; .id_map_ keys refer to them
+             **/
+            std::deque<std::string> name_v_;
+            /** name -> id.  When attached,  keys refer to names in .shared_,
+             *  and map caches lookups (hence mutable)
+             **/
+            mutable std::unordered_map<std::string_view, symbolid> id_map_;
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const symboltable & x) {
+            x.print(os);
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end symboltable.hpp */
@@ -0,0 +1,165 @@
+/* file tokenrecord.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "parser.hpp"
+#include "mapped_file.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace xo {
+    namespace scm {
+        /** @class tokenrecorder
+         *  @brief record parser input (tokens and lazy lambda bodies),
+         *         in the order a @ref reader delivers it
+         *
+         *  Attach to a reader with reader::attach_tokenrecorder;
+         *  replay with @ref tokenreplay.
+         *
+         *  Record file layout:
+         *  @code
+         *    header    { char magic[8]; }
+         *    record*   { u8 kind; varint len; char text[len]; }
+         *  @endcode
+         *  kind is a tokentype for a token,  or @c c_lazy_body for text given
+         *  to parser::include_lazy_body.  len is unsigned LEB128.
+         *  Records run to end of file.
+         **/
+        class tokenrecorder {
+        public:
+            using token_type = parser::token_type;
+            using span_type = span<const char>;
+
+            /** record kind for parser::include_lazy_body input **/
+            static constexpr std::uint8_t c_lazy_body = 0xff;
+
+        public:
+            tokenrecorder();
+
+            /** record token @p tk **/
+            void record_token(const token_type & tk);
+            /** record lazy lambda body @p body (possibly empty) **/
+            void record_lazy_body(const span_type & body);
+
+            /** #of records so far **/
+            std::size_t size() const { return n_record_; }
+
+            /** recording so far,  in file format **/
+            const std::string & image() const { return image_; }
+
+            /** write recording so far to @p path **/
+            void write(const std::string & path) const;
+
+            /** discard recording **/
+            void clear();
+
+        private:
+            void append_record(std::uint8_t kind, const char * text, std::size_t len);
+
+        private:
+            /** magic + records **/
+            std::string image_;
+            /** #of records in .image_ **/
+            std::size_t n_record_ = 0;
+        };
+
+        /** @class tokenreplay
+         *  @brief feed recorded parser input (see @ref tokenrecorder)
+         *         straight to a parser,  bypassing the tokenizer
+         *
+         *  Records are decoded once,  when the recording is loaded;
+         *  @ref replay costs only parser work.
+         **/
+        class tokenreplay {
+        public:
+            using Expression = xo::ast::Expression;
+            using token_type = parser::token_type;
+            using span_type = span<const char>;
+
+        public:
+            /** replay recording in file @p path.
+             *  Throws std::runtime_error if file is not a valid recording
+             **/
+            static tokenreplay open(const std::string & path);
+            /** replay recording @p image,  e.g. from tokenrecorder::image() **/
+            static tokenreplay from_image(std::string image);
+
+            /** #of records **/
+            std::size_t size() const { return record_v_.size(); }
+
+            /** Start a new translation unit in @p *p_parser,
+             *  then feed it every record in order.
+             *  Invoke @p sink(rp<Expression>) on each completed expression.
+             *  Clears parser's varrefs after each expression.
+             *
+             *  Lazy lambda bodies refer to text owned by this tokenreplay,
+             *  which must outlive them.
+             *
+             *  @return number of expressions delivered to @p sink
+             **/
+            template <typename Sink>
+            std::size_t replay(parser * p_parser, Sink && sink) const;
+
+        private:
+            /** one decoded record **/
+            struct record {
+                /** token;  unused for a lazy body **/
+                token_type tk_;
+                /** true for lazy lambda body **/
+                bool lazy_body_ = false;
+                /** lazy body text:  offsets into .bytes() **/
+                std::size_t lo_ = 0;
+                std::size_t hi_ = 0;
+            };
+
+            tokenreplay() = default;
+
+            /** recording text:  .file_ if mapped,  else .image_ **/
+            span_type bytes() const;
+
+            /** decode .bytes() into .record_v_ **/
+            void decode(const std::string & what);
+
+        private:
+            /** recording,  when loaded from file **/
+            mapped_file file_;
+            /** recording,  when loaded from memory **/
+            std::string image_;
+            /** decoded records,  in order **/
+            std::vector<record> record_v_;
+        };
+
+        template <typename Sink>
+        std::size_t
+        tokenreplay::replay(parser * p_parser, Sink && sink) const
+        {
+            span_type text = this->bytes();
+            std::size_t n_expr = 0;
+
+            p_parser->begin_translation_unit();
+
+            for (const record & rec : record_v_) {
+                rp<Expression> expr
+                    = (rec.lazy_body_
+                       ? p_parser->include_lazy_body(span_type(text.lo() + rec.lo_,
+                                                               text.lo() + rec.hi_))
+                       : p_parser->include_token(rec.tk_));
+
+                if (expr) {
+                    p_parser->clear_varrefs();
+
+                    sink(std::move(expr));
+                    ++n_expr;
+                }
+            }
+
+            return n_expr;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end tokenrecord.hpp */
@@ -0,0 +1,155 @@
+/* file variantstatestack.hpp
+ *
+ * author: Roland Conybeare
+ */
+
+#pragma once
+
+#include "exprseq_xs.hpp"
+#include "define_xs.hpp"
+#include "lambda_xs.hpp"
+#include "paren_xs.hpp"
+#include "sequence_xs.hpp"
+#include "expect_expr_xs.hpp"
+#include "expect_symbol_xs.hpp"
+#include "expect_type_xs.hpp"
+#include "expect_formal_arglist_xs.hpp"
+#include "expect_formal_xs.hpp"
+#include "progress_xs.hpp"
+#include "allocaccount.hpp"
+#include "xo/expression/Variable.hpp"
+#include <variant>
+#include <optional>
+#include <memory>
+#include <vector>
+#include <memory_resource>
+
+namespace xo {
+    namespace scm {
+        /** closed set of parser states.
+         *  Alternatives appear in the same order as @ref exprstatetype
+         **/
+        using exprstatevariant = std::variant<exprseq_xs,
+                                              define_xs,
+                                              lambda_xs,
+                                              paren_xs,
+                                              sequence_xs,
+                                              expect_expr_xs,
+                                              expect_symbol_xs,
+                                              expect_type_xs,
+                                              expect_formal_arglist_xs,
+                                              expect_formal_xs,
+                                              progress_xs>;
+
+        static_assert(std::variant_size_v<exprstatevariant>
+                      == static_cast<std::size_t>(exprstatetype::n_exprstatetype));
+
+        /** @class variantstatestack
+         *  @brief A stack of exprstates stored inline as @ref exprstatevariant
+         *
+         *  Alternative to @ref exprstatestack.
+         *  States are stored by value, and events are dispatched with std::visit
+         *  to the concrete (final) exprstate type,  so no virtual call
+         *  or pointer chase per transition.
+         *
+         *  Storage is a list of fixed-size segments,  retained until stack is destroyed:
+         *  - push/pop never move existing states,  so a handler running on a state
+         *    may safely push new states
+         *  - steady-state push/pop does not allocate
+         *
+         *  Segments come from a counting resource;  see @ref attach_allocaccount
+         **/
+        class variantstatestack {
+        public:
+            /** number of states per segment **/
+            static constexpr std::size_t c_segment_size = 32;
+
+        public:
+            variantstatestack() = default;
+            variantstatestack(const variantstatestack &) = delete;
+            variantstatestack & operator=(const variantstatestack &) = delete;
+            ~variantstatestack();
+
+            bool empty() const { return size_ == 0; }
+            std::size_t size() const { return size_; }
+
+            /** charge segments allocated from now on to @p account
+             *  (nullptr to detach),  under alloccategory::exprstate.
+             *  States themselves are stored inline and don't allocate
+             **/
+            void attach_allocaccount(allocaccount * account) { counter_.set_account(account); }
+
+            /** construct exprstate of type @p T in place at top of stack **/
+            template <typename T, typename... Args>
+            void emplace_exprstate(Args && ... args) {
+                if (size_ == segment_v_.size() * c_segment_size)
+                    this->add_segment();
+
+                this->slot(size_).emplace(std::in_place_type<T>,
+                                          std::forward<Args>(args)...);
+                ++size_;
+            }
+
+            /** destroy top exprstate **/
+            void pop_exprstate();
+
+            exprstate & top_exprstate();
+
+            /** invoke @p fn on top exprstate,  with its concrete type **/
+            template <typename Fn>
+            void visit_top(Fn && fn) {
+                std::visit(std::forward<Fn>(fn), this->top_slot());
+            }
+
+            /** relative to top-of-stack.
+             *  0 -> top (last in),  z-1 -> bottom (first in)
+             **/
+            exprstate & operator[](std::size_t i);
+            const exprstate & operator[](std::size_t i) const;
+
+            void print(std::ostream & os) const;
+
+        private:
+            using slot_type = std::optional<exprstatevariant>;
+
+            slot_type & slot(std::size_t i) {
+                return segment_v_[i / c_segment_size][i % c_segment_size];
+            }
+            const slot_type & slot(std::size_t i) const {
+                return segment_v_[i / c_segment_size][i % c_segment_size];
+            }
+
+            exprstatevariant & top_slot();
+
+            void add_segment();
+
+        private:
+            /** source for segments (and .segment_v_);  counts allocations.
+             *  Declared first so it outlives them
+             **/
+            countingresource counter_{nullptr, alloccategory::exprstate,
+                                      std::pmr::new_delete_resource()};
+            /** number of live states.  Bottom of stack is slot(0) **/
+            std::size_t size_ = 0;
+            /** storage for states:  each segment holds c_segment_size slots **/
+            std::pmr::vector<slot_type *> segment_v_{&counter_};
+        };
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const variantstatestack & x) {
+            x.print(os);
+            return os;
+        }
+
+        inline std::ostream &
+        operator<< (std::ostream & os, const variantstatestack * x) {
+            if (x)
+                x->print(os);
+            else
+                os << "nullptr";
+            return os;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end variantstatestack.hpp */
@@ -0,0 +1,120 @@
+/* file allocaccount.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "allocaccount.hpp"
+#include "xo/indentlog/print/tag.hpp"
+
+namespace xo {
+    namespace scm {
+        const char *
+        alloccategory_descr(alloccategory x) {
+            switch (x) {
+            case alloccategory::token_text: return "token_text";
+            case alloccategory::exprstate: return "exprstate";
+            case alloccategory::envframe: return "envframe";
+            case alloccategory::lambda_argl: return "lambda_argl";
+            case alloccategory::expression: return "expression";
+            case alloccategory::n_alloccategory: break;
+            }
+
+            return "???alloccategory";
+        }
+
+        // ----- allocstats -----
+
+        bool
+        allocstats::empty() const {
+            for (std::size_t i = 0; i < c_n_category; ++i) {
+                if (n_alloc_v_[i] != 0)
+                    return false;
+            }
+
+            return true;
+        }
+
+        void
+        allocstats::print(std::ostream & os) const {
+            os << "<allocstats";
+            for (std::size_t i = 0; i < c_n_category; ++i) {
+                os << " " << static_cast<alloccategory>(i)
+                   << ":" << n_alloc_v_[i] << "/" << n_byte_v_[i];
+            }
+            os << ">";
+        }
+
+        // ----- countingresource -----
+
+        void *
+        countingresource::do_allocate(std::size_t z, std::size_t align) {
+            void * retval = upstream_->allocate(z, align);
+
+            if (account_)
+                account_->note(category_, z);
+
+            return retval;
+        }
+
+        void
+        countingresource::do_deallocate(void * p, std::size_t z, std::size_t align) {
+            upstream_->deallocate(p, z, align);
+        }
+
+        bool
+        countingresource::do_is_equal(const std::pmr::memory_resource & x) const noexcept {
+            return this == &x;
+        }
+
+        // ----- allocaccount -----
+
+        const std::size_t allocaccount::c_sso_capacity = std::string().capacity();
+
+        allocaccount::allocaccount(std::pmr::memory_resource * upstream)
+        {
+            resource_v_.reserve(allocstats::c_n_category);
+
+            for (std::size_t i = 0; i < allocstats::c_n_category; ++i)
+                resource_v_.emplace_back(this, static_cast<alloccategory>(i), upstream);
+
+            tu_v_.emplace_back();
+        }
+
+        void
+        allocaccount::begin_translation_unit() {
+            /* nothing counted yet:  reuse current record */
+            if (!tu_v_.back().empty())
+                tu_v_.emplace_back();
+        }
+
+        allocstats
+        allocaccount::total() const {
+            allocstats retval;
+
+            for (const allocstats & s : tu_v_) {
+                for (std::size_t i = 0; i < allocstats::c_n_category; ++i) {
+                    retval.n_alloc_v_[i] += s.n_alloc_v_[i];
+                    retval.n_byte_v_[i] += s.n_byte_v_[i];
+                }
+            }
+
+            return retval;
+        }
+
+        void
+        allocaccount::clear() {
+            tu_v_.clear();
+            tu_v_.emplace_back();
+        }
+
+        void
+        allocaccount::print(std::ostream & os) const {
+            os << "<allocaccount"
+               << xtag("n_tu", tu_v_.size())
+               << xtag("total", this->total())
+               << ">";
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end allocaccount.cpp */
@@ -0,0 +1,117 @@
+/* file astcache.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "astcache.hpp"
+#include "astimage.hpp"
+#include "mapped_file.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+
+namespace xo {
+    namespace scm {
+        void
+        astcache_stats::print(std::ostream & os) const {
+            os << "<astcache_stats"
+               << xtag("n_hit", n_hit_)
+               << xtag("n_miss", n_miss_)
+               << xtag("n_store", n_store_)
+               << xtag("n_unencodable", n_unencodable_)
+               << ">";
+        }
+
+        astcache::astcache(std::string dir)
+            : dir_{std::move(dir)}
+        {}
+
+        std::string
+        astcache::image_path(std::uint64_t source_hash, std::uint32_t flags) const
+        {
+            char buf[64];
+
+            std::snprintf(buf, sizeof(buf), "%016llx-v%u-f%x.xoast",
+                          static_cast<unsigned long long>(source_hash),
+                          static_cast<unsigned>(astimage::c_version),
+                          static_cast<unsigned>(flags));
+
+            return (std::filesystem::path(dir_) / buf).string();
+        }
+
+        bool
+        astcache::lookup(const span_type & source,
+                         std::uint32_t flags,
+                         std::vector<reader_result> * p_result_v)
+        {
+            std::uint64_t h = astimage::content_hash(source);
+            std::string path = this->image_path(h, flags);
+
+            std::error_code ec;
+
+            if (std::filesystem::exists(path, ec)) {
+                try {
+                    mapped_file image = mapped_file::open(path);
+
+                    if (astimage::matches(image.contents(), source, h, flags)) {
+                        *p_result_v = astimage::decode(image.contents(), source);
+                        ++stats_.n_hit_;
+                        return true;
+                    }
+                } catch (std::exception &) {
+                    /* unreadable or damaged image:  same as no image;
+                     * next store replaces it
+                     */
+                }
+            }
+
+            ++stats_.n_miss_;
+            return false;
+        }
+
+        bool
+        astcache::store(const span_type & source,
+                        std::uint32_t flags,
+                        const std::vector<reader_result> & result_v)
+        {
+            std::string image;
+
+            if (!astimage::encode(source, flags, result_v, &image)) {
+                ++stats_.n_unencodable_;
+                return false;
+            }
+
+            std::string path = this->image_path(astimage::content_hash(source), flags);
+            std::string tmp_path = path + ".tmp" + std::to_string(::getpid());
+
+            std::error_code ec;
+
+            std::filesystem::create_directories(dir_, ec);
+
+            {
+                std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+
+                ofs.write(image.data(), image.size());
+
+                if (!ofs) {
+                    std::filesystem::remove(tmp_path, ec);
+                    return false;
+                }
+            }
+
+            std::filesystem::rename(tmp_path, path, ec);
+
+            if (ec) {
+                std::filesystem::remove(tmp_path, ec);
+                return false;
+            }
+
+            ++stats_.n_store_;
+            return true;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end astcache.cpp */
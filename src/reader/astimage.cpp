@@ -0,0 +1,681 @@
+/* file astimage.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "astimage.hpp"
+#include "xo/expression/Constant.hpp"
+#include "xo/expression/Variable.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include "xo/expression/ConvertExpr.hpp"
+#include "xo/expression/Lambda.hpp"
+#include "xo/expression/Sequence.hpp"
+#include "xo/expression/Apply.hpp"
+#include "xo/expression/PrimitiveInterface.hpp"
+#include "xo/reflect/Reflect.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstring>
+
+namespace xo {
+    using xo::ast::Expression;
+    using xo::ast::Constant;
+    using xo::ast::Variable;
+    using xo::ast::DefineExpr;
+    using xo::ast::DefineExprAccess;
+    using xo::ast::ConvertExpr;
+    using xo::ast::ConvertExprAccess;
+    using xo::ast::Lambda;
+    using xo::ast::Sequence;
+    using xo::ast::Apply;
+    using xo::ast::PrimitiveInterface;
+    using xo::ast::exprtype;
+    using xo::reflect::Reflect;
+    using xo::reflect::TypeDescr;
+
+    namespace scm {
+        namespace {
+            constexpr char c_magic[8] = {'x', 'o', 'a', 's', 't', 'i', 'm', 'g'};
+
+            /* no name / no child */
+            constexpr std::uint32_t c_none = 0xffffffff;
+
+            enum class nodetype : std::uint8_t {
+                constant_f64,
+                variable,
+                define,
+                convert,
+                lambda,
+                sequence,
+                /* apply f64 arithmetic primitive;  .name_ is primitive name */
+                apply_primitive,
+
+                n_nodetype
+            };
+
+            struct raw_header {
+                char magic_[8];
+                std::uint32_t version_;
+                std::uint32_t flags_;
+                std::uint64_t source_hash_;
+                std::uint64_t source_size_;
+                std::uint64_t n_node_;
+                std::uint64_t n_const_;
+                std::uint64_t n_toplevel_;
+                std::uint64_t n_varref_;
+                std::uint64_t n_string_;
+                std::uint64_t string_bytes_;
+            };
+
+            struct raw_node {
+                std::uint8_t type_;
+                std::uint8_t td_;
+                std::uint16_t n_child_;
+                /* string index (name),  or constant index (constant_f64) */
+                std::uint32_t arg_;
+            };
+
+            struct raw_toplevel {
+                std::uint32_t node_;
+                std::uint32_t varref_lo_;
+                std::uint32_t n_varref_;
+                std::uint32_t pad_;
+                std::uint64_t lo_;
+                std::uint64_t hi_;
+            };
+
+            struct raw_varref {
+                std::uint32_t node_;
+                std::uint32_t depth_;
+                std::uint32_t slot_;
+                std::uint32_t pad_;
+            };
+
+            struct raw_string {
+                std::uint32_t off_;
+                std::uint32_t len_;
+            };
+
+            static_assert(sizeof(raw_header) == 80);
+            static_assert(sizeof(raw_node) == 8);
+            static_assert(sizeof(raw_toplevel) == 32);
+            static_assert(sizeof(raw_varref) == 16);
+            static_assert(sizeof(raw_string) == 8);
+
+            /* types reader can produce;  index is on-disk code.
+             * Append only
+             */
+            const std::vector<TypeDescr> &
+            td_table() {
+                static std::vector<TypeDescr> s_td_v = {
+                    nullptr,
+                    Reflect::require<double>(),
+                    Reflect::require<float>(),
+                    Reflect::require<std::int16_t>(),
+                    Reflect::require<std::int32_t>(),
+                    Reflect::require<std::int64_t>(),
+                };
+
+                return s_td_v;
+            }
+
+            /* f64 arithmetic primitives reader can produce */
+            rp<Expression>
+            make_primitive_apply(const std::string & name,
+                                 const rp<Expression> & lhs,
+                                 const rp<Expression> & rhs)
+            {
+                if (name == "add2_f64")
+                    return Apply::make_add2_f64(lhs, rhs);
+                if (name == "sub2_f64")
+                    return Apply::make_sub2_f64(lhs, rhs);
+                if (name == "mul2_f64")
+                    return Apply::make_mul2_f64(lhs, rhs);
+                if (name == "div2_f64")
+                    return Apply::make_div2_f64(lhs, rhs);
+
+                return nullptr;
+            }
+
+            /* offsets of each image section,  given header counts */
+            struct section_layout {
+                explicit section_layout(const raw_header & h) {
+                    node_ = sizeof(raw_header);
+                    const_ = node_ + h.n_node_ * sizeof(raw_node);
+                    toplevel_ = const_ + h.n_const_ * sizeof(double);
+                    varref_ = toplevel_ + h.n_toplevel_ * sizeof(raw_toplevel);
+                    string_ = varref_ + h.n_varref_ * sizeof(raw_varref);
+                    bytes_ = string_ + h.n_string_ * sizeof(raw_string);
+                    end_ = bytes_ + h.string_bytes_;
+                }
+
+                std::size_t node_;
+                std::size_t const_;
+                std::size_t toplevel_;
+                std::size_t varref_;
+                std::size_t string_;
+                std::size_t bytes_;
+                std::size_t end_;
+            };
+
+            class encoder {
+            public:
+                /* append @p x (and its subtree) in post-order;
+                 * on success store its node index in *p_ix
+                 */
+                bool encode(const rp<Expression> & x, std::uint32_t * p_ix);
+
+                /* node index for variable @p var,  if encoded */
+                bool var_node(const Expression * var, std::uint32_t * p_ix) const {
+                    auto ix = var_node_map_.find(var);
+
+                    if (ix == var_node_map_.end())
+                        return false;
+
+                    *p_ix = ix->second;
+                    return true;
+                }
+
+                std::uint32_t intern(const std::string & s) {
+                    auto ix = string_map_.find(s);
+
+                    if (ix != string_map_.end())
+                        return ix->second;
+
+                    std::uint32_t id = string_v_.size();
+
+                    string_v_.push_back(raw_string{static_cast<std::uint32_t>(bytes_.size()),
+                                                   static_cast<std::uint32_t>(s.size())});
+                    bytes_ += s;
+                    string_map_[s] = id;
+
+                    return id;
+                }
+
+            private:
+                bool td_code(TypeDescr td, std::uint8_t * p_code) const {
+                    const auto & td_v = td_table();
+
+                    for (std::size_t i = 0; i < td_v.size(); ++i) {
+                        if (td_v[i] == td) {
+                            *p_code = i;
+                            return true;
+                        }
+                    }
+
+                    return false;
+                }
+
+                /* push node;  its @p n_child children are the nodes
+                 * most recently completed,  in order
+                 */
+                std::uint32_t push_node(nodetype type,
+                                        std::uint8_t td,
+                                        std::size_t n_child,
+                                        std::uint32_t arg)
+                {
+                    raw_node node;
+
+                    node.type_ = static_cast<std::uint8_t>(type);
+                    node.td_ = td;
+                    node.n_child_ = n_child;
+                    node.arg_ = arg;
+
+                    node_v_.push_back(node);
+
+                    return node_v_.size() - 1;
+                }
+
+            public:
+                std::vector<raw_node> node_v_;
+                std::vector<double> const_v_;
+                std::vector<raw_string> string_v_;
+                std::string bytes_;
+
+            private:
+                std::unordered_map<std::string, std::uint32_t> string_map_;
+                std::unordered_map<const Expression *, std::uint32_t> var_node_map_;
+            };
+
+            bool
+            encoder::encode(const rp<Expression> & x, std::uint32_t * p_ix)
+            {
+                if (!x)
+                    return false;
+
+                /* children encoded so far */
+                std::size_t n_child = 0;
+
+                auto encode_child = [this, &n_child](const rp<Expression> & child) {
+                    std::uint32_t ix = 0;
+
+                    if (!this->encode(child, &ix))
+                        return false;
+
+                    ++n_child;
+                    return true;
+                };
+
+                /* arity limit of raw_node */
+                constexpr std::size_t c_max_child = 0xffff;
+
+                switch (x->extype()) {
+                case exprtype::constant:
+                {
+                    auto k = dynamic_cast<const Constant<double> *>(x.get());
+
+                    if (!k)
+                        return false;
+
+                    const_v_.push_back(k->value());
+
+                    *p_ix = this->push_node(nodetype::constant_f64, 0, 0, const_v_.size() - 1);
+                    return true;
+                }
+                case exprtype::variable:
+                {
+                    auto var = Variable::from(x);
+                    std::uint8_t td = 0;
+
+                    if (!var || !this->td_code(var->valuetype(), &td))
+                        return false;
+
+                    *p_ix = this->push_node(nodetype::variable, td, 0, this->intern(var->name()));
+                    var_node_map_[x.get()] = *p_ix;
+                    return true;
+                }
+                case exprtype::define:
+                {
+                    auto def = DefineExpr::from(x);
+
+                    if (!def)
+                        return false;
+
+                    if (def->rhs() && !encode_child(def->rhs()))
+                        return false;
+
+                    *p_ix = this->push_node(nodetype::define, 0, n_child, this->intern(def->lhs_name()));
+                    return true;
+                }
+                case exprtype::convert:
+                {
+                    auto cvt = dynamic_cast<const ConvertExpr *>(x.get());
+                    std::uint8_t td = 0;
+
+                    if (!cvt || !this->td_code(cvt->valuetype(), &td))
+                        return false;
+
+                    if (!encode_child(cvt->arg()))
+                        return false;
+
+                    *p_ix = this->push_node(nodetype::convert, td, n_child, c_none);
+                    return true;
+                }
+                case exprtype::lambda:
+                {
+                    auto lm = dynamic_cast<const Lambda *>(x.get());
+
+                    if (!lm || (lm->argv().size() >= c_max_child))
+                        return false;
+
+                    /* formals,  then body */
+                    for (const auto & arg : lm->argv()) {
+                        if (!encode_child(arg))
+                            return false;
+                    }
+
+                    if (!encode_child(lm->body()))
+                        return false;
+
+                    *p_ix = this->push_node(nodetype::lambda, 0, n_child, this->intern(lm->name()));
+                    return true;
+                }
+                case exprtype::sequence:
+                {
+                    auto seq = dynamic_cast<const Sequence *>(x.get());
+
+                    if (!seq || (seq->size() > c_max_child))
+                        return false;
+
+                    for (std::size_t i = 0, n = seq->size(); i < n; ++i) {
+                        if (!encode_child((*seq)[i]))
+                            return false;
+                    }
+
+                    *p_ix = this->push_node(nodetype::sequence, 0, n_child, c_none);
+                    return true;
+                }
+                case exprtype::apply:
+                {
+                    auto app = Apply::from(x);
+
+                    if (!app || (app->argv().size() != 2))
+                        return false;
+
+                    auto prim = dynamic_cast<const PrimitiveInterface *>(app->fn().get());
+
+                    if (!prim || !make_primitive_apply(prim->name(), nullptr, nullptr))
+                        return false;
+
+                    for (const auto & arg : app->argv()) {
+                        if (!encode_child(arg))
+                            return false;
+                    }
+
+                    *p_ix = this->push_node(nodetype::apply_primitive, 0, n_child, this->intern(prim->name()));
+                    return true;
+                }
+                default:
+                    break;
+                }
+
+                /* not produced by reader,  or not yet representable */
+                return false;
+            }
+
+            template <typename T>
+            void
+            append_raw(std::string * p_image, const std::vector<T> & v) {
+                p_image->append(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+            }
+
+            template <typename T>
+            const T *
+            section(const astimage::span_type & image, std::size_t offset) {
+                return reinterpret_cast<const T *>(image.lo() + offset);
+            }
+        }
+
+        std::uint64_t
+        astimage::content_hash(const span_type & text)
+        {
+            constexpr std::uint64_t c_offset_basis = 14695981039346656037ULL;
+            constexpr std::uint64_t c_prime = 1099511628211ULL;
+
+            std::uint64_t h = c_offset_basis;
+
+            for (const char * p = text.lo(); p != text.hi(); ++p) {
+                h ^= static_cast<unsigned char>(*p);
+                h *= c_prime;
+            }
+
+            return h;
+        }
+
+        bool
+        astimage::encode(const span_type & source,
+                         std::uint32_t flags,
+                         const std::vector<reader_result> & result_v,
+                         std::string * p_image)
+        {
+            encoder enc;
+
+            std::vector<raw_toplevel> toplevel_v;
+            std::vector<raw_varref> varref_v;
+
+            toplevel_v.reserve(result_v.size());
+
+            for (const reader_result & rr : result_v) {
+                raw_toplevel tl;
+
+                if (!enc.encode(rr.expr_, &tl.node_))
+                    return false;
+
+                tl.varref_lo_ = varref_v.size();
+                tl.n_varref_ = rr.varref_v_.size();
+                tl.pad_ = 0;
+                tl.lo_ = rr.rem_.lo() - source.lo();
+                tl.hi_ = rr.rem_.hi() - source.lo();
+
+                for (const varref & ref : rr.varref_v_) {
+                    raw_varref rv;
+
+                    if (!enc.var_node(ref.var_.get(), &rv.node_))
+                        return false;
+
+                    rv.depth_ = ref.addr_.depth_;
+                    rv.slot_ = ref.addr_.slot_;
+                    rv.pad_ = 0;
+
+                    varref_v.push_back(rv);
+                }
+
+                toplevel_v.push_back(tl);
+            }
+
+            raw_header h;
+
+            std::memcpy(h.magic_, c_magic, sizeof(c_magic));
+            h.version_ = c_version;
+            h.flags_ = flags;
+            h.source_hash_ = content_hash(source);
+            h.source_size_ = source.size();
+            h.n_node_ = enc.node_v_.size();
+            h.n_const_ = enc.const_v_.size();
+            h.n_toplevel_ = toplevel_v.size();
+            h.n_varref_ = varref_v.size();
+            h.n_string_ = enc.string_v_.size();
+            h.string_bytes_ = enc.bytes_.size();
+
+            section_layout layout(h);
+
+            p_image->clear();
+            p_image->reserve(layout.end_);
+            p_image->append(reinterpret_cast<const char *>(&h), sizeof(h));
+            append_raw(p_image, enc.node_v_);
+            append_raw(p_image, enc.const_v_);
+            append_raw(p_image, toplevel_v);
+            append_raw(p_image, varref_v);
+            append_raw(p_image, enc.string_v_);
+            p_image->append(enc.bytes_);
+
+            return true;
+        }
+
+        bool
+        astimage::matches(const span_type & image,
+                          const span_type & source,
+                          std::uint64_t source_hash,
+                          std::uint32_t flags)
+        {
+            if (image.size() < sizeof(raw_header))
+                return false;
+
+            raw_header h;
+            std::memcpy(&h, image.lo(), sizeof(h));
+
+            return ((std::memcmp(h.magic_, c_magic, sizeof(c_magic)) == 0)
+                    && (h.version_ == c_version)
+                    && (h.flags_ == flags)
+                    && (h.source_hash_ == source_hash)
+                    && (h.source_size_ == source.size()));
+        }
+
+        std::vector<reader_result>
+        astimage::decode(const span_type & image, const span_type & source)
+        {
+            constexpr const char * c_self_name = "astimage::decode";
+
+            auto malformed = [c_self_name](const char * what) {
+                return std::runtime_error(tostr(c_self_name, ": malformed image", xtag("what", what)));
+            };
+
+            if (image.size() < sizeof(raw_header))
+                throw malformed("header");
+
+            raw_header h;
+            std::memcpy(&h, image.lo(), sizeof(h));
+
+            /* bound counts before computing offsets from them */
+            if ((h.n_node_ > image.size()) || (h.n_const_ > image.size())
+                || (h.n_toplevel_ > image.size()) || (h.n_varref_ > image.size())
+                || (h.n_string_ > image.size()) || (h.string_bytes_ > image.size()))
+                throw malformed("counts");
+
+            section_layout layout(h);
+
+            if (layout.end_ > image.size())
+                throw malformed("size");
+
+            const raw_node * node_v = section<raw_node>(image, layout.node_);
+            const double * const_v = section<double>(image, layout.const_);
+            const raw_toplevel * toplevel_v = section<raw_toplevel>(image, layout.toplevel_);
+            const raw_varref * varref_v = section<raw_varref>(image, layout.varref_);
+            const raw_string * string_v = section<raw_string>(image, layout.string_);
+            const char * bytes = image.lo() + layout.bytes_;
+
+            const auto & td_v = td_table();
+
+            /* interned strings,  materialized once each */
+            std::vector<std::string> str_v(h.n_string_);
+
+            for (std::size_t i = 0; i < h.n_string_; ++i) {
+                const raw_string & s = string_v[i];
+
+                if (std::uint64_t(s.off_) + s.len_ > h.string_bytes_)
+                    throw malformed("string");
+
+                str_v[i].assign(bytes + s.off_, s.len_);
+            }
+
+            std::vector<reader_result> retval;
+            retval.reserve(h.n_toplevel_);
+
+            /* completed subtrees not yet adopted by a parent;
+             * a node's children are the top .n_child_ entries
+             */
+            std::vector<rp<Expression>> stack;
+            /* (node, position in toplevel's varref list),  sorted by node */
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> ref_node_v;
+
+            /* next node to decode */
+            std::size_t i = 0;
+
+            for (std::size_t k = 0; k < h.n_toplevel_; ++k) {
+                const raw_toplevel & tl = toplevel_v[k];
+
+                /* nodes for toplevel k are [i, tl.node_] */
+                if ((tl.node_ < i) || (tl.node_ >= h.n_node_)
+                    || (tl.lo_ > tl.hi_) || (tl.hi_ > source.size())
+                    || (std::uint64_t(tl.varref_lo_) + tl.n_varref_ > h.n_varref_))
+                    throw malformed("toplevel");
+
+                ref_node_v.clear();
+                for (std::uint32_t j = 0; j < tl.n_varref_; ++j) {
+                    const raw_varref & rv = varref_v[tl.varref_lo_ + j];
+
+                    if ((rv.node_ < i) || (rv.node_ > tl.node_))
+                        throw malformed("varref");
+
+                    ref_node_v.emplace_back(rv.node_, j);
+                }
+
+                std::sort(ref_node_v.begin(), ref_node_v.end());
+
+                std::vector<varref> ref_v(tl.n_varref_);
+                auto next_ref = ref_node_v.begin();
+
+                for (; i <= tl.node_; ++i) {
+                    const raw_node & node = node_v[i];
+
+                    if ((node.td_ >= td_v.size()) || (node.n_child_ > stack.size()))
+                        throw malformed("node");
+
+                    TypeDescr td = td_v[node.td_];
+                    const std::string * name = (node.arg_ < h.n_string_) ? &str_v[node.arg_] : nullptr;
+
+                    /* children:  [child_lo, stack.end()) */
+                    auto child_lo = stack.end() - node.n_child_;
+                    std::size_t n_child = node.n_child_;
+
+                    rp<Expression> x;
+
+                    switch (static_cast<nodetype>(node.type_)) {
+                    case nodetype::constant_f64:
+                        if ((n_child == 0) && (node.arg_ < h.n_const_))
+                            x = Constant<double>::make(const_v[node.arg_]);
+                        break;
+                    case nodetype::variable:
+                        if (name && (n_child == 0))
+                            x = Variable::make(*name, td);
+                        break;
+                    case nodetype::define:
+                        if (name && (n_child <= 1)) {
+                            auto def = DefineExprAccess::make_empty();
+
+                            def->assign_lhs_name(*name);
+                            if (n_child == 1)
+                                def->assign_rhs(*child_lo);
+
+                            x = def;
+                        }
+                        break;
+                    case nodetype::convert:
+                        if (n_child == 1)
+                            x = ConvertExprAccess::make(td, *child_lo);
+                        break;
+                    case nodetype::lambda:
+                        if (name && (n_child >= 1)) {
+                            std::vector<rp<Variable>> argl;
+                            argl.reserve(n_child - 1);
+
+                            for (auto ix = child_lo; ix + 1 != stack.end(); ++ix) {
+                                auto var = Variable::from(*ix);
+
+                                if (!var)
+                                    throw malformed("lambda formal");
+
+                                argl.push_back(var.promote());
+                            }
+
+                            x = Lambda::make(*name, argl, stack.back());
+                        }
+                        break;
+                    case nodetype::sequence:
+                        x = Sequence::make(std::vector<rp<Expression>>(std::make_move_iterator(child_lo),
+                                                                       std::make_move_iterator(stack.end())));
+                        break;
+                    case nodetype::apply_primitive:
+                        if (name && (n_child == 2))
+                            x = make_primitive_apply(*name, child_lo[0], child_lo[1]);
+                        break;
+                    case nodetype::n_nodetype:
+                        break;
+                    }
+
+                    if (!x)
+                        throw malformed("node type");
+
+                    stack.erase(child_lo, stack.end());
+
+                    for (; (next_ref != ref_node_v.end()) && (next_ref->first == i); ++next_ref) {
+                        auto var = Variable::from(x);
+
+                        if (!var)
+                            throw malformed("varref");
+
+                        const raw_varref & rv = varref_v[tl.varref_lo_ + next_ref->second];
+
+                        ref_v[next_ref->second] = varref(var.promote(), lexaddr(rv.depth_, rv.slot_));
+                    }
+
+                    stack.push_back(std::move(x));
+                }
+
+                if (stack.size() != 1)
+                    throw malformed("toplevel");
+
+                retval.emplace_back(std::move(stack.back()),
+                                    span_type(source.lo() + tl.lo_, source.lo() + tl.hi_),
+                                    std::move(ref_v));
+                stack.pop_back();
+            }
+
+            return retval;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end astimage.cpp */
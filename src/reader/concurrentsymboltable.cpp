@@ -0,0 +1,74 @@
+/* file concurrentsymboltable.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "concurrentsymboltable.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <mutex>
+
+namespace xo {
+    namespace scm {
+        std::size_t
+        concurrentsymboltable::size() const {
+            std::shared_lock lock(mutex_);
+
+            return name_v_.size();
+        }
+
+        symbolid
+        concurrentsymboltable::intern(std::string_view name) {
+            {
+                std::shared_lock lock(mutex_);
+
+                auto ix = id_map_.find(name);
+
+                if (ix != id_map_.end())
+                    return ix->second;
+            }
+
+            std::unique_lock lock(mutex_);
+
+            /* another thread may have interned name since we looked */
+            auto ix = id_map_.find(name);
+
+            if (ix != id_map_.end())
+                return ix->second;
+
+            symbolid id = name_v_.size();
+
+            name_v_.emplace_back(name);
+            id_map_.emplace(std::string_view(name_v_.back()), id);
+
+            return id;
+        }
+
+        symbolid
+        concurrentsymboltable::find(std::string_view name) const {
+            std::shared_lock lock(mutex_);
+
+            auto ix = id_map_.find(name);
+
+            if (ix == id_map_.end())
+                return c_invalid_symbolid;
+
+            return ix->second;
+        }
+
+        const std::string &
+        concurrentsymboltable::name(symbolid id) const {
+            std::shared_lock lock(mutex_);
+
+            return name_v_[id];
+        }
+
+        void
+        concurrentsymboltable::print(std::ostream & os) const {
+            os << "<concurrentsymboltable"
+               << xtag("size", this->size())
+               << ">";
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end concurrentsymboltable.cpp */
@@ -0,0 +1,76 @@
+/* file constfolder.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "constfolder.hpp"
+#include "xo/expression/Constant.hpp"
+#include <limits>
+#include <cmath>
+
+namespace xo {
+    using xo::ast::Expression;
+    using xo::ast::Constant;
+
+    namespace scm {
+        static_assert(std::numeric_limits<double>::is_iec559,
+                      "constant folding relies on IEEE 754 doubles");
+
+        namespace {
+            const Constant<double> *
+            f64_constant(const rp<Expression> & x) {
+                return dynamic_cast<const Constant<double> *>(x.get());
+            }
+        }
+
+        rp<Expression>
+        constfolder::fold(optype op,
+                          const rp<Expression> & lhs,
+                          const rp<Expression> & rhs)
+        {
+            if (!enabled_)
+                return nullptr;
+
+            const Constant<double> * lhs_k = f64_constant(lhs);
+
+            if (!lhs_k)
+                return nullptr;
+
+            const Constant<double> * rhs_k = f64_constant(rhs);
+
+            if (!rhs_k)
+                return nullptr;
+
+            double x = lhs_k->value();
+            double y = rhs_k->value();
+            double z = 0.0;
+
+            switch (op) {
+            case optype::op_add:
+                z = x + y;
+                break;
+            case optype::op_subtract:
+                z = x - y;
+                break;
+            case optype::op_multiply:
+                z = x * y;
+                break;
+            case optype::op_divide:
+                z = x / y;
+                break;
+            default:
+                /* not an f64 arithmetic operator */
+                return nullptr;
+            }
+
+            if (!std::isfinite(z))
+                return nullptr;
+
+            ++n_folded_;
+
+            return Constant<double>::make(z);
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end constfolder.cpp */
@@ -0,0 +1,333 @@
+/* file defindex.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "defindex.hpp"
+#include "define_xs.hpp"
+#include "segmenter.hpp"
+#include "xo/tokenizer/tokenizer.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <cctype>
+#include <cstring>
+
+namespace xo {
+    namespace scm {
+        // ----- defindexer -----
+
+        std::vector<defindex_entry>
+        defindexer::scan(const span_type & input, simdlevel level)
+        {
+            constexpr const char * c_self_name = "defindexer::scan";
+
+            using tokenizer_type = tokenizer<char>;
+
+            std::vector<defindex_entry> retval;
+
+            /* every toplevel form ends at one of these */
+            std::vector<std::size_t> cut_v = segmenter::boundaries(input, level);
+            auto next_cut = cut_v.begin();
+
+            const char * lo = input.lo();
+            std::size_t z = input.size();
+
+            tokenizer_type tkz;
+
+            for (std::size_t pos = 0; pos < z; ) {
+                /* one toplevel form,  starting at pos */
+                span_type rem(lo + pos, lo + z);
+
+                defexprstatetype state = defexprstatetype::def_0;
+                defindex_entry entry;
+                /* offset just past last token seen */
+                std::size_t tk_hi = pos;
+                /* true: skip to next toplevel boundary */
+                bool skip = false;
+
+                for (;;) {
+                    auto sr = tkz.scan2(rem, true /*eof*/);
+                    const auto & tk = sr.first;
+                    const span_type & used = sr.second;
+
+                    rem = rem.after_prefix(used);
+
+                    if (!tk.is_valid()) {
+                        /* trailing whitespace */
+                        if (state != defexprstatetype::def_0) {
+                            throw std::runtime_error
+                                (tostr(c_self_name, ": incomplete definition at eof",
+                                       xtag("name", entry.name_)));
+                        }
+
+                        pos = z;
+                        break;
+                    }
+
+                    std::size_t tk_lo = used.lo() - lo;
+                    while (std::isspace(static_cast<unsigned char>(lo[tk_lo])))
+                        ++tk_lo;
+
+                    tk_hi = used.hi() - lo;
+
+                    tokentype tktype = tk.tk_type();
+                    bool ok = true;
+                    bool done = false;
+
+                    switch (state) {
+                    case defexprstatetype::def_0:
+                        if (tktype == tokentype::tk_def) {
+                            entry.lo_ = tk_lo;
+                            state = defexprstatetype::def_1;
+                        } else {
+                            /* not a definition */
+                            skip = true;
+                        }
+                        break;
+                    case defexprstatetype::def_1:
+                        ok = (tktype == tokentype::tk_symbol);
+                        entry.name_ = tk.text();
+                        state = defexprstatetype::def_2;
+                        break;
+                    case defexprstatetype::def_2:
+                        if (tktype == tokentype::tk_colon)
+                            state = defexprstatetype::def_3;
+                        else if (tktype == tokentype::tk_singleassign)
+                            skip = true;
+                        else if (tktype == tokentype::tk_semicolon)
+                            done = true;
+                        else
+                            ok = false;
+                        break;
+                    case defexprstatetype::def_3:
+                        ok = (tktype == tokentype::tk_symbol);
+                        entry.type_ = tk.text();
+                        state = defexprstatetype::def_4;
+                        break;
+                    case defexprstatetype::def_4:
+                        if (tktype == tokentype::tk_singleassign)
+                            skip = true;
+                        else if (tktype == tokentype::tk_semicolon)
+                            done = true;
+                        else
+                            ok = false;
+                        break;
+                    default:
+                        ok = false;
+                        break;
+                    }
+
+                    if (!ok) {
+                        throw std::runtime_error
+                            (tostr(c_self_name, ": unexpected token in definition",
+                                   xtag("state", state),
+                                   xtag("offset", tk_lo),
+                                   xtag("token", tk)));
+                    }
+
+                    if (skip) {
+                        /* rest of form:  up to next toplevel ';' */
+                        while ((next_cut != cut_v.end()) && (*next_cut < tk_hi))
+                            ++next_cut;
+
+                        if (next_cut == cut_v.end()) {
+                            throw std::runtime_error
+                                (tostr(c_self_name, ": toplevel form missing ';'",
+                                       xtag("offset", tk_lo)));
+                        }
+
+                        tk_hi = *next_cut;
+                        done = true;
+                    }
+
+                    if (done) {
+                        if (state != defexprstatetype::def_0) {
+                            entry.hi_ = tk_hi;
+                            retval.push_back(std::move(entry));
+                        }
+
+                        pos = tk_hi;
+                        break;
+                    }
+                }
+            }
+
+            return retval;
+        }
+
+        void
+        defindexer::write(const std::string & path,
+                          std::vector<defindex_entry> entry_v)
+        {
+            constexpr const char * c_self_name = "defindexer::write";
+
+            std::stable_sort(entry_v.begin(), entry_v.end(),
+                             [](const defindex_entry & x, const defindex_entry & y)
+                                 {
+                                     return x.name_ < y.name_;
+                                 });
+
+            std::vector<defindex::raw_entry> raw_v;
+            std::string strings;
+
+            raw_v.reserve(entry_v.size());
+
+            for (const auto & e : entry_v) {
+                defindex::raw_entry raw;
+
+                raw.lo_ = e.lo_;
+                raw.hi_ = e.hi_;
+                raw.name_off_ = strings.size();
+                raw.name_len_ = e.name_.size();
+                strings += e.name_;
+                raw.type_off_ = strings.size();
+                raw.type_len_ = e.type_.size();
+                strings += e.type_;
+
+                raw_v.push_back(raw);
+            }
+
+            if (strings.size() > UINT32_MAX) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": string table too large",
+                           xtag("path", path),
+                           xtag("size", strings.size())));
+            }
+
+            std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+
+            std::uint64_t n_entry = raw_v.size();
+
+            ofs.write(defindex::c_magic, sizeof(defindex::c_magic));
+            ofs.write(reinterpret_cast<const char *>(&n_entry), sizeof(n_entry));
+            ofs.write(reinterpret_cast<const char *>(raw_v.data()),
+                      raw_v.size() * sizeof(defindex::raw_entry));
+            ofs.write(strings.data(), strings.size());
+
+            if (!ofs) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": write failed",
+                           xtag("path", path)));
+            }
+        }
+
+        std::size_t
+        defindexer::index_file(const std::string & src_path,
+                               const std::string & index_path)
+        {
+            mapped_file src = mapped_file::open(src_path);
+
+            std::vector<defindex_entry> entry_v = scan(src.contents());
+            std::size_t n = entry_v.size();
+
+            write(index_path, std::move(entry_v));
+
+            return n;
+        }
+
+        // ----- defindex -----
+
+        defindex
+        defindex::open(const std::string & path)
+        {
+            constexpr const char * c_self_name = "defindex::open";
+
+            static_assert(sizeof(raw_entry) == 32);
+
+            defindex retval;
+
+            retval.file_ = mapped_file::open(path);
+
+            std::size_t z = retval.file_.size();
+            const char * lo = retval.file_.contents().lo();
+
+            if ((z < c_header_size)
+                || (std::memcmp(lo, c_magic, sizeof(c_magic)) != 0))
+            {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": not a definition index",
+                           xtag("path", path)));
+            }
+
+            std::uint64_t n_entry = 0;
+            std::memcpy(&n_entry, lo + sizeof(c_magic), sizeof(n_entry));
+
+            if (n_entry > (z - c_header_size) / sizeof(raw_entry)) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": truncated definition index",
+                           xtag("path", path),
+                           xtag("n_entry", n_entry)));
+            }
+
+            retval.n_entry_ = n_entry;
+            retval.entry_lo_ = lo + c_header_size;
+            retval.string_lo_ = retval.entry_lo_ + n_entry * sizeof(raw_entry);
+
+            /* string table runs to end of file.
+             * Entries are checked against it in entry(),  so open needn't
+             * touch the entry table
+             */
+            retval.string_z_ = z - c_header_size - n_entry * sizeof(raw_entry);
+
+            return retval;
+        }
+
+        auto
+        defindex::entry(std::size_t i) const -> entry_view
+        {
+            raw_entry raw;
+            std::memcpy(&raw, entry_lo_ + i * sizeof(raw_entry), sizeof(raw));
+
+            if ((std::uint64_t(raw.name_off_) + raw.name_len_ > string_z_)
+                || (std::uint64_t(raw.type_off_) + raw.type_len_ > string_z_))
+            {
+                throw std::runtime_error
+                    (tostr("defindex::entry: entry outside string table",
+                           xtag("i", i),
+                           xtag("string_z", string_z_)));
+            }
+
+            entry_view retval;
+            retval.name_ = std::string_view(string_lo_ + raw.name_off_, raw.name_len_);
+            retval.type_ = std::string_view(string_lo_ + raw.type_off_, raw.type_len_);
+            retval.lo_ = raw.lo_;
+            retval.hi_ = raw.hi_;
+
+            return retval;
+        }
+
+        auto
+        defindex::find(std::string_view name) const -> std::vector<entry_view>
+        {
+            /* first entry with name >= target */
+            std::size_t lo = 0;
+            std::size_t hi = n_entry_;
+
+            while (lo < hi) {
+                std::size_t mid = lo + (hi - lo) / 2;
+
+                if (this->entry(mid).name_ < name)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            std::vector<entry_view> retval;
+
+            for (std::size_t i = lo; i < n_entry_; ++i) {
+                entry_view e = this->entry(i);
+
+                if (e.name_ != name)
+                    break;
+
+                retval.push_back(e);
+            }
+
+            return retval;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end defindex.cpp */
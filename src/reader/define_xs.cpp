@@ -36,19 +36,14 @@ namespace xo {
 
         // ----- define_xs -----
 
-        std::unique_ptr<define_xs>
-        define_xs::make() {
-            return std::make_unique<define_xs>(define_xs(DefineExprAccess::make_empty()));
-        }
-
         void
         define_xs::start(parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
-            p_psm->push_exprstate(define_xs::make());
-            p_psm->top_exprstate().on_def_token(token_type::def(), p_psm);
+            p_psm->note_alloc(alloccategory::expression, sizeof(DefineExprAccess));
+            p_psm->push_new_exprstate<define_xs>(DefineExprAccess::make_empty());
+            p_psm->on_def_token(token_type::def());
         }
 
         define_xs::define_xs(rp<DefineExprAccess> def_expr)
@@ -57,12 +52,30 @@ namespace xo {
               def_expr_{std::move(def_expr)}
         {}
 
+        define_xs::define_xs(const define_xs & x)
+            : exprstate(x),
+              defxs_type_{x.defxs_type_},
+              def_expr_{DefineExprAccess::make_empty()}
+        {
+            /* .def_expr_, .cvt_expr_ are assembled in place as tokens arrive;
+             * don't share them with x
+             */
+            this->def_expr_->assign_lhs_name(x.def_expr_->lhs_name());
+
+            if (x.cvt_expr_) {
+                this->cvt_expr_ = ConvertExprAccess::make(x.cvt_expr_->valuetype(),
+                                                          x.cvt_expr_->arg());
+                this->def_expr_->assign_rhs(this->cvt_expr_);
+            } else if (x.def_expr_->rhs()) {
+                this->def_expr_->assign_rhs(x.def_expr_->rhs());
+            }
+        }
+
         void
         define_xs::on_expr(ref::brw<Expression> expr,
                            parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             log && log(xtag("defxs_type", defxs_type_));
 
@@ -102,8 +115,7 @@ namespace xo {
         define_xs::on_symbol(const std::string & symbol_name,
                              parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             log && log("defxs_type", defxs_type_);
 
@@ -120,8 +132,7 @@ namespace xo {
         define_xs::on_typedescr(TypeDescr td,
                                 parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             log && log("defxs_type", defxs_type_);
 
@@ -129,6 +140,7 @@ namespace xo {
                 this->defxs_type_ = defexprstatetype::def_4;
                 this->cvt_expr_ = ConvertExprAccess::make(td /*dest_type*/,
                                                           nullptr /*source_expr*/);
+                p_psm->note_alloc(alloccategory::expression, sizeof(ConvertExprAccess));
                 this->def_expr_->assign_rhs(this->cvt_expr_);
                 //this->def_lhs_td_ = td;
 
@@ -142,8 +154,7 @@ namespace xo {
         define_xs::on_def_token(const token_type & tk,
                                 parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             log && log("defxs_type", defxs_type_);
 
@@ -160,8 +171,7 @@ namespace xo {
         define_xs::on_colon_token(const token_type & tk,
                                   parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             log && log("defxs_type", defxs_type_);
 
@@ -180,17 +190,16 @@ namespace xo {
         {
             /* def expr consumes semicolon */
 
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             log && log("defxs_type", defxs_type_);
 
             if (this->defxs_type_ == defexprstatetype::def_6) {
                 rp<Expression> expr = this->def_expr_;
 
-                std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+                p_psm->pop_exprstate();
 
-                p_psm->top_exprstate().on_expr(expr, p_psm);
+                p_psm->on_expr(expr);
             } else {
                 exprstate::on_semicolon_token(tk, p_psm);
             }
@@ -200,8 +209,7 @@ namespace xo {
         define_xs::on_singleassign_token(const token_type & tk,
                                          parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             constexpr const char * self_name = "define_xs::on_singleassign_token";
 
@@ -237,8 +245,7 @@ namespace xo {
         define_xs::on_rightparen_token(const token_type & tk,
                                        parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             constexpr const char * self_name = "define_xs::on_rightparen";
 
@@ -249,8 +256,7 @@ namespace xo {
         define_xs::on_f64_token(const token_type & tk,
                                 parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::define);
 
             constexpr const char * self_name = "define_xs::on_f64";
 
@@ -12,18 +12,30 @@ namespace xo {
     namespace scm {
         rp<Variable>
         envframe::lookup(const std::string & x) const {
-            for (const auto & var : argl_) {
-                if (x == var->name())
-                    return var;
-            }
+            rp<Variable> retval;
 
-            return nullptr;
+            /* first match wins */
+            argl_.visit([&x, &retval](const rp<Variable> & var)
+                            {
+                                if (!retval && (x == var->name()))
+                                    retval = var;
+                            });
+
+            return retval;
+        }
+
+        bool
+        envframe::extends(const envframe & x) const {
+            return ((n_formal_ == x.n_formal_)
+                    && argl_.has_prefix(x.argl_,
+                                        [](const rp<Variable> & a, const rp<Variable> & b)
+                                            { return a.get() == b.get(); }));
         }
 
         void
         envframe::print(std::ostream & os) const {
             os << "<envframe"
-               << xtag("argl", argl_)
+               << xtag("argl", argl_.to_vector())
                << ">";
         }
 
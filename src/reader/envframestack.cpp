@@ -4,6 +4,8 @@
  */
 
 #include "envframestack.hpp"
+#include "logpolicy.hpp"
+#include <algorithm>
 
 namespace xo {
     using xo::ast::Variable;
@@ -21,49 +23,177 @@ namespace xo {
             return stack_[z-1];
         }
 
+        void
+        envframestack::attach_symtab(concurrentsymboltable * shared) {
+            if (!stack_.empty()) {
+                throw std::runtime_error
+                    ("envframestack::attach_symtab: expected empty stack");
+            }
+
+            /* ids change meaning */
+            binding_v_.clear();
+
+            symtab_.attach_shared(shared);
+        }
+
         void
         envframestack::push_envframe(envframe frame) {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag),
-                      xtag("frame", frame));
+            XO_READER_SCOPE(log, logmodule::stack,
+                            xtag("frame", frame));
 
-            std::size_t z = stack_.size();
+            frame_lo_v_.push_back(bound_v_.size());
+
+            std::vector<rp<Variable>> argl = frame.argl().to_vector();
+            std::size_t n_formal = frame.n_formal();
+            std::uint32_t i_frame = stack_.size();
+
+            auto bind = [this, &argl, i_frame](std::size_t i)
+                            {
+                                const rp<Variable> & var = argl[i];
+                                symbolid id = symtab_.intern(var->name());
+
+                                if (id >= binding_v_.size())
+                                    binding_v_.resize(id + 1);
+
+                                binding_v_[id].push_back(binding{var, i_frame,
+                                                                 static_cast<std::uint32_t>(i)});
+                                bound_v_.push_back(id);
+                            };
 
-            stack_.resize(z+1);
+            /* formals in reverse order: if a name repeats among them,
+             * first occurrence wins (ends up innermost)
+             */
+            for (std::size_t i = n_formal; i > 0; --i)
+                bind(i - 1);
 
-            stack_[z] = std::move(frame);
+            /* then anything added by envframe::push_back,  in order:
+             * same result as extend_envframe() on each
+             */
+            for (std::size_t i = n_formal, n = argl.size(); i < n; ++i)
+                bind(i);
+
+            stack_.push_back(std::move(frame));
+        }
+
+        void
+        envframestack::extend_envframe(const rp<Variable> & var) {
+            XO_READER_SCOPE(log, logmodule::stack,
+                            xtag("var", var));
+
+            envframe & frame = this->top_envframe();
+            std::uint32_t i_frame = stack_.size() - 1;
+            std::uint32_t slot = frame.argl().size();
+            symbolid id = symtab_.intern(var->name());
+
+            if (id >= binding_v_.size())
+                binding_v_.resize(id + 1);
+
+            /* top frame's ids are last in .bound_v_,  so pop_envframe() undoes this too */
+            binding_v_[id].push_back(binding{var, i_frame, slot});
+            bound_v_.push_back(id);
+
+            frame.push_back(var);
         }
 
         void
         envframestack::pop_envframe() {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::stack);
 
             std::size_t z = stack_.size();
 
             if (z > 0) {
-                //std::unique_ptr<exprstate> top = std::move(stack_[z-1]);
+                std::size_t lo = frame_lo_v_.back();
+
+                for (std::size_t i = lo, n = bound_v_.size(); i < n; ++i)
+                    binding_v_[bound_v_[i]].pop_back();
+
+                bound_v_.resize(lo);
+                frame_lo_v_.pop_back();
 
                 stack_.resize(z-1);
+            }
+        }
+
+        void
+        envframestack::unextend_envframe(std::size_t n) {
+            [[maybe_unused]] const envframe & frame = this->top_envframe();
 
-                //return top;
-            } else {
-                //return nullptr;
+            assert(frame.argl().size() - frame.n_formal() >= n);
+
+            /* top frame's extensions are last in .bound_v_ */
+            for (std::size_t i = 0; i < n; ++i) {
+                binding_v_[bound_v_.back()].pop_back();
+                bound_v_.pop_back();
             }
         }
 
+        void
+        envframestack::restore_frames(const std::vector<envframe> & frame_v) {
+            XO_READER_SCOPE(log, logmodule::stack,
+                            xtag("frame_v.size", frame_v.size()),
+                            xtag("size", stack_.size()));
+
+            /* frames unchanged since frame_v was copied from this stack */
+            std::size_t k = 0;
+            std::size_t n = std::min(stack_.size(), frame_v.size());
+
+            while ((k < n) && stack_[k].same_as(frame_v[k]))
+                ++k;
+
+            while (stack_.size() > k + 1)
+                this->pop_envframe();
+
+            if ((k < n) && (stack_.size() == k + 1) && stack_[k].extends(frame_v[k])) {
+                /* frame k only appended to since:  drop the new bindings */
+                this->unextend_envframe(stack_[k].argl().size() - frame_v[k].argl().size());
+                stack_[k] = frame_v[k];
+                ++k;
+            } else if (stack_.size() > k) {
+                this->pop_envframe();
+            }
+
+            for (; k < frame_v.size(); ++k)
+                this->push_envframe(frame_v[k]);
+        }
+
         rp<Variable>
-        envframestack::lookup(const std::string & x) const {
-            for (std::size_t i = 0, z = this->size(); i < z; ++i) {
-                const auto & frame = (*this)[i];
+        envframestack::lookup(std::string_view x) const {
+            /* no interning here: names never bound are not worth remembering */
+            return this->lookup(symtab_.find(x));
+        }
 
-                auto retval = frame.lookup(x);
+        auto
+        envframestack::lookup_binding(symbolid id) const -> const binding *
+        {
+            if (id >= binding_v_.size())
+                return nullptr;
 
-                if (retval)
-                    return retval;
-            }
+            const auto & chain = binding_v_[id];
+
+            if (chain.empty())
+                return nullptr;
+
+            return &chain.back();
+        }
+
+        rp<Variable>
+        envframestack::lookup(symbolid id) const {
+            const binding * b = this->lookup_binding(id);
+
+            return b ? b->var_ : nullptr;
+        }
+
+        rp<Variable>
+        envframestack::lookup_addr(std::string_view x, lexaddr * p_addr) const {
+            const binding * b = this->lookup_binding(symtab_.find(x));
+
+            if (!b)
+                return nullptr;
+
+            /* depth relative to top of stack */
+            *p_addr = lexaddr(stack_.size() - 1 - b->frame_, b->slot_);
 
-            return nullptr;
+            return b->var_;
         }
 
         void
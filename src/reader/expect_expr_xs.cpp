@@ -19,22 +19,21 @@ namespace xo {
 
     namespace scm {
 
-        std::unique_ptr<expect_expr_xs>
-        expect_expr_xs::make(bool allow_defs,
-                             bool cxl_on_rightbrace)
-        {
-            return std::make_unique<expect_expr_xs>(expect_expr_xs(allow_defs,
-                                                                   cxl_on_rightbrace));
-
-        }
-
         void
         expect_expr_xs::start(bool allow_defs,
                               bool cxl_on_rightbrace,
                               parserstatemachine * p_psm)
         {
-            p_psm->push_exprstate(expect_expr_xs::make(allow_defs,
-                                                       cxl_on_rightbrace));
+            p_psm->push_new_exprstate<expect_expr_xs>(allow_defs,
+                                                      cxl_on_rightbrace);
+        }
+
+        void
+        expect_expr_xs::start_operand(parserstatemachine * p_psm)
+        {
+            p_psm->push_new_exprstate<expect_expr_xs>(false /*!allow_defs*/,
+                                                      false /*!cxl_on_rightbrace*/,
+                                                      true /*is_operand*/);
         }
 
         void
@@ -45,18 +44,19 @@ namespace xo {
         }
 
         expect_expr_xs::expect_expr_xs(bool allow_defs,
-                                       bool cxl_on_rightbrace)
+                                       bool cxl_on_rightbrace,
+                                       bool is_operand)
             : exprstate(exprstatetype::expect_rhs_expression),
               allow_defs_{allow_defs},
-              cxl_on_rightbrace_{cxl_on_rightbrace}
+              cxl_on_rightbrace_{cxl_on_rightbrace},
+              is_operand_{is_operand}
         {}
 
         void
         expect_expr_xs::on_def_token(const token_type & tk,
                                      parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             if (allow_defs_) {
                 define_xs::start(p_psm);
@@ -69,8 +69,7 @@ namespace xo {
         expect_expr_xs::on_lambda_token(const token_type & /*tk*/,
                                         parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             //constexpr const char * self_name = "exprstate::on_leftparen";
 
@@ -81,8 +80,7 @@ namespace xo {
         expect_expr_xs::on_leftparen_token(const token_type & /*tk*/,
                                            parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             //constexpr const char * self_name = "exprstate::on_leftparen";
 
@@ -94,8 +92,7 @@ namespace xo {
         expect_expr_xs::on_leftbrace_token(const token_type & /*tk*/,
                                            parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             /* push lparen_0 to remember to look for subsequent rightparen. */
             sequence_xs::start(p_psm);
@@ -105,11 +102,10 @@ namespace xo {
         expect_expr_xs::on_rightbrace_token(const token_type & tk,
                                             parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             if (cxl_on_rightbrace_) {
-                auto self = p_psm->pop_exprstate();
+                p_psm->pop_exprstate();
 
                 /* do not call .on_expr(), since '}' cancelled */
 
@@ -123,8 +119,7 @@ namespace xo {
         expect_expr_xs::on_symbol_token(const token_type & tk,
                                         parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             log && log(xtag("tk", tk));
 
@@ -136,10 +131,15 @@ namespace xo {
              *
              * need lookahead token following symbol to distinguish
              * between (1) (symbol completes rhs expression)
-             * and {(2), (3)} (symbol is function call)
+             * and {(2), (3)} (symbol is function call).
+             * A driver can try one reading and rewind with
+             * parser::checkpoint() / parser::restore()
              */
 
-            rp<Variable> var = p_psm->lookup_var(tk.text());
+            /* var: new Variable for this reference,
+             * lexical address recorded in parser (see parser::varref_v)
+             */
+            rp<Variable> var = p_psm->make_varref(tk.text());
 
             if (!var) {
                 throw std::runtime_error
@@ -157,7 +157,16 @@ namespace xo {
              *   def y = foo(pi2);
              *           ^
              */
-            progress_xs::start(var, p_psm);
+            if (is_operand_) {
+                /* e.g.
+                 *   def pi2 = 2 * pi;
+                 *                 ^
+                 */
+                p_psm->pop_exprstate();
+                p_psm->on_expr(var);
+            } else {
+                progress_xs::start(var, p_psm);
+            }
 
 #ifdef NOT_YET
             p_stack->push_exprstate(exprstate(exprstatetype::expr_progress,
@@ -177,8 +186,7 @@ namespace xo {
         expect_expr_xs::on_f64_token(const token_type & tk,
                                      parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             //constexpr const char * self_name = "exprstate::on_f64_token";
 
@@ -186,22 +194,27 @@ namespace xo {
              *   def pi = 3.14159265;
              *            \---tk---/
              */
-            progress_xs::start
-                (Constant<double>::make(tk.f64_value()),
-                 p_psm);
+            rp<Expression> expr = Constant<double>::make(tk.f64_value());
+            p_psm->note_alloc(alloccategory::expression, sizeof(Constant<double>));
+
+            if (is_operand_) {
+                p_psm->pop_exprstate();
+                p_psm->on_expr(expr);
+            } else {
+                progress_xs::start(expr, p_psm);
+            }
         }
 
         void
         expect_expr_xs::on_expr(ref::brw<Expression> expr,
                                 parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             log && log(xtag("exstype", this->exs_type_),
                        xtag("expr", expr.promote()));
 
-            std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+            p_psm->pop_exprstate();
 
             p_psm->on_expr(expr);
         } /*on_expr*/
@@ -210,13 +223,12 @@ namespace xo {
         expect_expr_xs::on_expr_with_semicolon(ref::brw<Expression> expr,
                                                parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             log && log(xtag("exstype", this->exs_type_),
                        xtag("expr", expr.promote()));
 
-            std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+            p_psm->pop_exprstate();
 
             p_psm->on_expr_with_semicolon(expr);
         } /*on_expr_with_semicolon*/
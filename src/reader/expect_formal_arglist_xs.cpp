@@ -31,16 +31,10 @@ namespace xo {
             return "?formalarglstatetype";
         }
 
-        std::unique_ptr<expect_formal_arglist_xs>
-        expect_formal_arglist_xs::make() {
-            return std::make_unique<expect_formal_arglist_xs>
-                (expect_formal_arglist_xs());
-        }
-
         void
         expect_formal_arglist_xs::start(parserstatemachine * p_psm)
         {
-            p_psm->push_exprstate(expect_formal_arglist_xs::make());
+            p_psm->push_new_exprstate<expect_formal_arglist_xs>();
         }
 
         expect_formal_arglist_xs::expect_formal_arglist_xs()
@@ -90,9 +84,12 @@ namespace xo {
                                                       parserstatemachine * p_psm)
         {
             if (farglxs_type_ == formalarglstatetype::argl_1b) {
-                std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+                std::vector<rp<Variable>> argl = std::move(this->argl_);
+
+                /* note: *this destroyed here */
+                p_psm->pop_exprstate();
 
-                p_psm->top_exprstate().on_formal_arglist(this->argl_, p_psm);
+                p_psm->on_formal_arglist(argl);
             } else {
                 exprstate::on_rightparen_token(tk, p_psm);
             }
@@ -32,14 +32,9 @@ namespace xo {
             return "???formalstatetype";
         }
 
-        std::unique_ptr<expect_formal_xs>
-        expect_formal_xs::make() {
-            return std::make_unique<expect_formal_xs>(expect_formal_xs());
-        }
-
         void
         expect_formal_xs::start(parserstatemachine * p_psm) {
-            p_psm->push_exprstate(expect_formal_xs::make());
+            p_psm->push_new_exprstate<expect_formal_xs>();
 
             expect_symbol_xs::start(p_psm);
         }
@@ -81,12 +76,14 @@ namespace xo {
             if (this->formalxs_type_ == formalstatetype::formal_2) {
                 this->result_.assign_td(td);
 
-                std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
-
                 rp<Variable> var = Variable::make(result_.name(),
                                                   result_.td());
+                p_psm->note_alloc(alloccategory::expression, sizeof(Variable));
+
+                /* note: *this destroyed here */
+                p_psm->pop_exprstate();
 
-                p_psm->top_exprstate().on_formal(var, p_psm);
+                p_psm->on_formal(var);
             } else {
                 exprstate::on_typedescr(td, p_psm);
             }
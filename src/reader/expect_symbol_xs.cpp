@@ -9,15 +9,10 @@
 
 namespace xo {
     namespace scm {
-        std::unique_ptr<expect_symbol_xs>
-        expect_symbol_xs::make() {
-            return std::make_unique<expect_symbol_xs>(expect_symbol_xs());
-        }
-
         void
         expect_symbol_xs::start(parserstatemachine * p_psm)
         {
-            p_psm->push_exprstate(expect_symbol_xs::make());
+            p_psm->push_new_exprstate<expect_symbol_xs>();
         }
 
         expect_symbol_xs::expect_symbol_xs()
@@ -28,15 +23,14 @@ namespace xo {
         expect_symbol_xs::on_symbol_token(const token_type & tk,
                                           parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::expect_expr);
 
             log && log(xtag("tk", tk));
 
             /* have to do pop first, before sending symbol to
              * the o.g. symbol-requester
              */
-            std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+            p_psm->pop_exprstate();
 
             p_psm->on_symbol(tk.text());
         }
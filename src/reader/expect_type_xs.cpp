@@ -13,14 +13,9 @@ namespace xo {
 
     namespace scm {
 
-        std::unique_ptr<expect_type_xs>
-        expect_type_xs::make() {
-            return std::make_unique<expect_type_xs>(expect_type_xs());
-        }
-
         void
         expect_type_xs::start(parserstatemachine * p_psm) {
-            p_psm->push_exprstate(expect_type_xs::make());
+            p_psm->push_new_exprstate<expect_type_xs>();
         }
 
         expect_type_xs::expect_type_xs()
@@ -56,8 +51,8 @@ namespace xo {
                            xtag("typename", tk.text())));
             }
 
-            std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
-            p_psm->top_exprstate().on_typedescr(td, p_psm);
+            p_psm->pop_exprstate();
+            p_psm->on_typedescr(td);
         }
     } /*namespace scm*/
 } /*namespace xo*/
@@ -8,16 +8,10 @@
 
 namespace xo {
     namespace scm {
-        std::unique_ptr<exprseq_xs>
-        exprseq_xs::make()
-        {
-            return std::make_unique<exprseq_xs>(exprseq_xs());
-        }
-
         void
         exprseq_xs::start(parserstatemachine * p_psm)
         {
-            p_psm->push_exprstate(exprseq_xs::make());
+            p_psm->push_new_exprstate<exprseq_xs>();
         }
 
         exprseq_xs::exprseq_xs()
@@ -29,8 +23,7 @@ namespace xo {
         exprseq_xs::on_def_token(const token_type & /*tk*/,
                                  parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::sequence);
 
             //constexpr const char * c_self_name = "exprseq_xs::on_def_token";
 
@@ -35,8 +35,6 @@ namespace xo {
                 return "parenexpr";
             case exprstatetype::sequenceexpr:
                 return "sequenceexpr";
-            case exprstatetype::let1expr:
-                return "let1expr";
             case exprstatetype::expect_rhs_expression:
                 return "expect_rhs_expression";
             case exprstatetype::expect_symbol:
@@ -74,8 +72,7 @@ namespace xo {
         exprstate::on_symbol_token(const token_type & tk,
                                    parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             log && log(xtag("exstype", p_psm->top_exprstate().exs_type()));
 
@@ -90,8 +87,7 @@ namespace xo {
         {
             /* returning type description to something that wants it */
 
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             log && log(xtag("exstype",
                             p_psm->top_exprstate().exs_type()));
@@ -110,8 +106,7 @@ namespace xo {
         {
             /* returning type description to something that wants it */
 
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             log && log(xtag("exstype",
                             p_psm->top_exprstate().exs_type()));
@@ -130,8 +125,7 @@ namespace xo {
         {
             /* returning type description to something that wants it */
 
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             log && log(xtag("exstype",
                             p_psm->top_exprstate().exs_type()));
@@ -144,12 +138,23 @@ namespace xo {
                                            xtag("state", *this)));
         }
 
+        void
+        exprstate::on_lazy_body(const span<const char> & body,
+                                parserstatemachine * /*p_psm*/)
+        {
+            constexpr const char * c_self_name = "exprstate::on_lazy_body";
+
+            throw std::runtime_error(tostr(c_self_name,
+                                           ": unexpected lambda body for parsing state",
+                                           xtag("body.size", body.size()),
+                                           xtag("state", *this)));
+        }
+
         void
         exprstate::on_colon_token(const token_type & tk,
                                   parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_colon";
 
@@ -160,8 +165,7 @@ namespace xo {
         exprstate::on_comma_token(const token_type & tk,
                                   parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_comma";
 
@@ -172,8 +176,7 @@ namespace xo {
         exprstate::on_semicolon_token(const token_type & tk,
                                       parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_semicolon";
 
@@ -183,8 +186,7 @@ namespace xo {
         void
         exprstate::on_singleassign_token(const token_type & tk,
                                          parserstatemachine * /*p_psm*/) {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_singleassign_token";
 
@@ -195,8 +197,7 @@ namespace xo {
         exprstate::on_leftparen_token(const token_type & tk,
                                       parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_leftparen_token";
 
@@ -207,8 +208,7 @@ namespace xo {
         exprstate::on_rightparen_token(const token_type & tk,
                                        parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_rightparen";
 
@@ -219,8 +219,7 @@ namespace xo {
         exprstate::on_leftbrace_token(const token_type & tk,
                                       parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_leftbrace_token";
 
@@ -231,8 +230,7 @@ namespace xo {
         exprstate::on_rightbrace_token(const token_type & tk,
                                        parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_rightbrace_token";
 
@@ -243,8 +241,7 @@ namespace xo {
         exprstate::on_operator_token(const token_type & tk,
                                      parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_operator_token";
 
@@ -255,8 +252,7 @@ namespace xo {
         exprstate::on_f64_token(const token_type & tk,
                                 parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             constexpr const char * self_name = "exprstate::on_f64";
 
@@ -267,119 +263,19 @@ namespace xo {
         exprstate::on_input(const token_type & tk,
                             parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
             log && log(xtag("tk", tk));
             log && log(xtag("state", *this));
             log && log(xtag("psm", *p_psm));
 
-            switch (tk.tk_type()) {
-
-            case tokentype::tk_def:
-                this->on_def_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_lambda:
-                this->on_lambda_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_i64:
-                assert(false);
-                return;
-
-            case tokentype::tk_f64:
-                this->on_f64_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_string:
-                assert(false);
-                return;
-
-            case tokentype::tk_symbol:
-                this->on_symbol_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_leftparen:
-                this->on_leftparen_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_rightparen:
-                this->on_rightparen_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_leftbracket:
-            case tokentype::tk_rightbracket:
-                assert(false);
-                break;
-
-            case tokentype::tk_leftbrace:
-                this->on_leftbrace_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_rightbrace:
-                this->on_rightbrace_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_leftangle:
-            case tokentype::tk_rightangle:
-            case tokentype::tk_dot:
-                assert(false);
-                return;
-
-            case tokentype::tk_comma:
-                this->on_comma_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_colon:
-                this->on_colon_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_doublecolon:
-                assert(false);
-                return;
-
-            case tokentype::tk_semicolon:
-                this->on_semicolon_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_singleassign:
-                this->on_singleassign_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_assign:
-            case tokentype::tk_yields:
-
-            case tokentype::tk_plus:
-            case tokentype::tk_minus:
-            case tokentype::tk_star:
-            case tokentype::tk_slash:
-                this->on_operator_token(tk, p_psm);
-                return;
-
-            case tokentype::tk_type:
-            case tokentype::tk_if:
-            case tokentype::tk_let:
-
-            case tokentype::tk_in:
-            case tokentype::tk_end:
-                assert(false);
-                return;
-
-            case tokentype::tk_invalid:
-            case tokentype::n_tokentype:
-                assert(false);
-                return;
-            }
-
-            assert(false);
+            dispatch_input(*this, tk, p_psm);
         }
 
         void
         exprstate::on_expr(ref::brw<Expression> expr,
                            parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             log && log(xtag("exstype", this->exs_type_),
                        xtag("expr", expr));
@@ -391,8 +287,7 @@ namespace xo {
         exprstate::on_expr_with_semicolon(ref::brw<Expression> expr,
                                           parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             const char * c_self_name = "exprstate::on_expr_with_semicolon";
 
@@ -415,8 +310,7 @@ namespace xo {
             /* unreachable - derived class that can receive
              * will override this method
              */
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::exprstate);
 
             log && log(xtag("exstype", this->exs_type_),
                        xtag("symbol_name", symbol_name));
@@ -0,0 +1,123 @@
+/* file exprstatepool.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "exprstatepool.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <stdexcept>
+#include <cassert>
+
+namespace xo {
+    namespace scm {
+        void
+        exprstatepool_stats::print(std::ostream & os) const {
+            os << "<exprstatepool_stats"
+               << xtag("n_alloc", n_alloc_)
+               << xtag("n_release", n_release_)
+               << xtag("n_slab", n_slab_)
+               << xtag("n_oversize", n_oversize_)
+               << ">";
+        }
+
+        exprstatepool::~exprstatepool() {
+            for (const slab & x : slab_v_)
+                x.upstream_->deallocate(x.lo_, c_slab_size, c_granule);
+        }
+
+        void
+        exprstatepool::set_upstream(std::pmr::memory_resource * upstream) {
+            if (stats_.n_alloc_ != stats_.n_release_) {
+                throw std::runtime_error
+                    (tostr("exprstatepool::set_upstream",
+                           ": expected no live allocations",
+                           xtag("n_live", stats_.n_alloc_ - stats_.n_release_)));
+            }
+
+            upstream_ = upstream ? upstream : std::pmr::new_delete_resource();
+        }
+
+        void *
+        exprstatepool::carve(std::size_t k) {
+            std::size_t z = (k + 1) * c_granule;
+
+            if (slab_lo_ + z > slab_hi_) {
+                /* current slab exhausted.  Remainder of old slab is abandoned;
+                 * not worth threading onto free lists
+                 */
+                auto lo = static_cast<std::byte *>(upstream_->allocate(c_slab_size, c_granule));
+
+                slab_v_.push_back(slab{lo, upstream_});
+                ++(stats_.n_slab_);
+
+                slab_lo_ = lo;
+                slab_hi_ = slab_lo_ + c_slab_size;
+            }
+
+            void * retval = slab_lo_;
+
+            slab_lo_ += z;
+
+            return retval;
+        }
+
+        void *
+        exprstatepool::alloc(std::size_t z) {
+            ++(stats_.n_alloc_);
+
+            if (z > c_max_size) {
+                ++(stats_.n_oversize_);
+
+                return upstream_->allocate(z, c_granule);
+            }
+
+            std::size_t k = sizeclass(z);
+
+            freenode * node = free_v_[k];
+
+            if (node) {
+                free_v_[k] = node->next_;
+
+                return node;
+            }
+
+            return this->carve(k);
+        }
+
+        void *
+        exprstatepool::do_allocate(std::size_t z, std::size_t align) {
+            assert(align <= c_granule);
+            (void)align;
+
+            return this->alloc(z);
+        }
+
+        void
+        exprstatepool::do_deallocate(void * p, std::size_t z, std::size_t /*align*/) {
+            this->release(p, z);
+        }
+
+        bool
+        exprstatepool::do_is_equal(const std::pmr::memory_resource & x) const noexcept {
+            return this == &x;
+        }
+
+        void
+        exprstatepool::release(void * mem, std::size_t z) {
+            ++(stats_.n_release_);
+
+            if (z > c_max_size) {
+                upstream_->deallocate(mem, z, c_granule);
+                return;
+            }
+
+            std::size_t k = sizeclass(z);
+
+            freenode * node = new (mem) freenode{free_v_[k]};
+
+            free_v_[k] = node;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end exprstatepool.cpp */
@@ -20,10 +20,9 @@ namespace xo {
         }
 
         void
-        exprstatestack::push_exprstate(std::unique_ptr<exprstate> exs) {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag),
-                      xtag("exs", exs.get()));
+        exprstatestack::push_exprstate(xs_uptr<exprstate> exs) {
+            XO_READER_SCOPE(log, logmodule::stack,
+                            xtag("exs", exs.get()));
 
             std::size_t z = stack_.size();
 
@@ -32,16 +31,15 @@ namespace xo {
             stack_[z] = std::move(exs);
         }
 
-        std::unique_ptr<exprstate>
+        xs_uptr<exprstate>
         exprstatestack::pop_exprstate() {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag),
-                      xtag("top.exstype", top_exprstate().exs_type()));
+            XO_READER_SCOPE(log, logmodule::stack,
+                            xtag("top.exstype", top_exprstate().exs_type()));
 
             std::size_t z = stack_.size();
 
             if (z > 0) {
-                std::unique_ptr<exprstate> top = std::move(stack_[z-1]);
+                xs_uptr<exprstate> top = std::move(stack_[z-1]);
 
                 stack_.resize(z-1);
 
@@ -0,0 +1,440 @@
+/* file incrementalreader.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "incrementalreader.hpp"
+#include "segmenter.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <cctype>
+
+namespace xo {
+    using xo::ast::DefineExpr;
+
+    namespace scm {
+        namespace {
+            bool
+            is_space(char c) {
+                return std::isspace(static_cast<unsigned char>(c));
+            }
+
+            bool
+            is_ident_start(char c) {
+                return std::isalpha(static_cast<unsigned char>(c)) || (c == '_');
+            }
+
+            bool
+            is_ident(char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || (c == '_');
+            }
+
+            /* identifiers in @p form outside string literals;  sorted, unique */
+            std::vector<std::string>
+            form_words(const incrementalreader::span_type & form) {
+                std::vector<std::string> retval;
+
+                const char * p = form.lo();
+                const char * e = form.hi();
+
+                while (p != e) {
+                    char c = *p;
+
+                    if (c == '"') {
+                        for (++p; (p != e) && (*p != '"'); ++p) {
+                            if ((*p == '\\') && (p + 1 != e))
+                                ++p;
+                        }
+
+                        if (p != e)
+                            ++p;
+                    } else if (is_ident_start(c)) {
+                        const char * lo = p;
+
+                        while ((p != e) && is_ident(*p))
+                            ++p;
+
+                        retval.emplace_back(lo, p);
+                    } else if (is_ident(c)) {
+                        /* digits of a number;  not an identifier */
+                        while ((p != e) && is_ident(*p))
+                            ++p;
+                    } else {
+                        ++p;
+                    }
+                }
+
+                std::sort(retval.begin(), retval.end());
+                retval.erase(std::unique(retval.begin(), retval.end()), retval.end());
+
+                return retval;
+            }
+
+            /* invoke fn(c, p) on each char c of the normalized text of @p form,
+             * where p is the position in @p form that c comes from.
+             * Each interior whitespace run becomes one ' ',  given the position
+             * of the char following it;  so that 'a b' and 'ab' differ
+             * but indentation doesn't matter.  Leading and trailing whitespace
+             * is dropped;  string literals are copied as-is.
+             */
+            template <typename Fn>
+            void
+            for_each_normal(const incrementalreader::span_type & form, Fn && fn) {
+                const char * p = form.lo();
+                const char * e = form.hi();
+
+                bool in_string = false;
+                /* true: whitespace seen since last token char */
+                bool gap = false;
+                /* true: at least one token char seen */
+                bool started = false;
+
+                for (; p != e; ++p) {
+                    char c = *p;
+
+                    if (in_string) {
+                        fn(c, p);
+
+                        if ((c == '\\') && (p + 1 != e)) {
+                            ++p;
+                            fn(*p, p);
+                        } else if (c == '"') {
+                            in_string = false;
+                        }
+
+                        continue;
+                    }
+
+                    if (is_space(c)) {
+                        gap = started;
+                        continue;
+                    }
+
+                    if (gap)
+                        fn(' ', p);
+
+                    fn(c, p);
+
+                    gap = false;
+                    started = true;
+                    in_string = (c == '"');
+                }
+            }
+
+            bool
+            mentions_any(const std::vector<std::string> & word_v,
+                         const std::unordered_set<std::string> & name_set)
+            {
+                for (const auto & name : name_set) {
+                    if (std::binary_search(word_v.begin(), word_v.end(), name))
+                        return true;
+                }
+
+                return false;
+            }
+        }
+
+        void
+        incremental_stats::print(std::ostream & os) const {
+            os << "<incremental_stats"
+               << xtag("n_form", n_form_)
+               << xtag("n_reused", n_reused_)
+               << xtag("n_changed", n_changed_)
+               << xtag("n_invalidated", n_invalidated_)
+               << ">";
+        }
+
+        incrementalreader::incrementalreader(parserengine engine)
+            : reader_{engine}
+        {}
+
+        std::uint64_t
+        incrementalreader::form_hash(const span_type & form)
+        {
+            /* FNV-1a over normalized form text */
+            constexpr std::uint64_t c_offset_basis = 14695981039346656037ULL;
+            constexpr std::uint64_t c_prime = 1099511628211ULL;
+
+            std::uint64_t h = c_offset_basis;
+
+            for_each_normal(form,
+                            [&h](char c, const char * /*p*/)
+                                {
+                                    h ^= static_cast<unsigned char>(c);
+                                    h *= c_prime;
+                                });
+
+            return h;
+        }
+
+        auto
+        incrementalreader::parse_form(const span_type & form) -> form_entry
+        {
+            form_entry retval;
+
+            /* raw span boundaries:  lo,hi of each expression,  in order */
+            std::vector<const char *> raw_v;
+
+            reader_.begin_translation_unit();
+            reader_.read_all(form, true /*eof*/,
+                             [&retval, &raw_v](reader_result && rr)
+                                 {
+                                     cached_expr x;
+                                     x.expr_ = rr.expr_;
+                                     x.varref_v_ = std::move(rr.varref_v_);
+
+                                     raw_v.push_back(rr.rem_.lo());
+                                     raw_v.push_back(rr.rem_.hi());
+
+                                     auto def = DefineExpr::from(rr.expr_);
+
+                                     if (def)
+                                         retval.def_v_.push_back(def->lhs_name());
+
+                                     retval.expr_v_.push_back(std::move(x));
+                                 });
+
+            /* normalized text,  and offset into it of each raw boundary:
+             * number of normalized chars coming from positions before it
+             */
+            std::vector<std::size_t> off_v(raw_v.size());
+            std::size_t ib = 0;
+
+            for_each_normal(form,
+                            [&retval, &raw_v, &off_v, &ib](char c, const char * p)
+                                {
+                                    while ((ib < raw_v.size()) && (raw_v[ib] <= p))
+                                        off_v[ib++] = retval.norm_.size();
+
+                                    retval.norm_.push_back(c);
+                                });
+
+            for (; ib < raw_v.size(); ++ib)
+                off_v[ib] = retval.norm_.size();
+
+            for (std::size_t i = 0; i < retval.expr_v_.size(); ++i) {
+                retval.expr_v_[i].lo_ = off_v[2 * i];
+                retval.expr_v_[i].hi_ = off_v[2 * i + 1];
+            }
+
+            retval.word_v_ = form_words(form);
+
+            return retval;
+        }
+
+        bool
+        incrementalreader::match_form(const span_type & form,
+                                      const form_entry & entry,
+                                      std::vector<span_type> * p_span_v)
+        {
+            const std::string & norm = entry.norm_;
+            std::size_t n_expr = entry.expr_v_.size();
+
+            /* raw_v[k]: first position in form after k'th normalized char;
+             * only recorded for offsets some expression needs.
+             * Offset 0 is the start of the form
+             */
+            std::vector<const char *> raw_v(2 * n_expr, form.lo());
+            std::size_t k = 0;
+            bool match = true;
+
+            for_each_normal(form,
+                            [&](char c, const char * p)
+                                {
+                                    if (!match)
+                                        return;
+
+                                    if ((k == norm.size()) || (norm[k] != c)) {
+                                        match = false;
+                                        return;
+                                    }
+
+                                    ++k;
+
+                                    for (std::size_t i = 0; i < n_expr; ++i) {
+                                        if (entry.expr_v_[i].lo_ == k)
+                                            raw_v[2 * i] = p + 1;
+                                        if (entry.expr_v_[i].hi_ == k)
+                                            raw_v[2 * i + 1] = p + 1;
+                                    }
+                                });
+
+            if (!match || (k != norm.size()))
+                return false;
+
+            p_span_v->clear();
+            p_span_v->reserve(n_expr);
+
+            for (std::size_t i = 0; i < n_expr; ++i)
+                p_span_v->push_back(span_type(raw_v[2 * i], raw_v[2 * i + 1]));
+
+            return true;
+        }
+
+        std::vector<reader_result>
+        incrementalreader::read(const span_type & input)
+        {
+            stats_ = incremental_stats();
+
+            /* 1. cut into toplevel forms */
+            std::vector<span_type> form_v;
+            {
+                const char * lo = input.lo();
+                std::size_t prev = 0;
+
+                for (std::size_t cut : segmenter::boundaries(input)) {
+                    form_v.push_back(span_type(lo + prev, lo + cut));
+                    prev = cut;
+                }
+
+                /* trailing text after last ';' is a form iff not just whitespace */
+                span_type tail(lo + prev, input.hi());
+
+                if (std::any_of(tail.lo(), tail.hi(), [](char c) { return !is_space(c); }))
+                    form_v.push_back(tail);
+            }
+
+            std::size_t n_form = form_v.size();
+
+            stats_.n_form_ = n_form;
+
+            /* 2. match against previous read */
+            std::vector<std::uint64_t> hash_v(n_form);
+
+            for (std::size_t i = 0; i < n_form; ++i)
+                hash_v[i] = form_hash(form_v[i]);
+
+            std::size_t n_old = hash_v_.size();
+
+            /* unchanged leading and trailing forms match by position */
+            std::size_t n_prefix = 0;
+            while ((n_prefix < n_form) && (n_prefix < n_old)
+                   && (hash_v[n_prefix] == hash_v_[n_prefix]))
+                ++n_prefix;
+
+            std::size_t n_suffix = 0;
+            while ((n_prefix + n_suffix < n_form) && (n_prefix + n_suffix < n_old)
+                   && (hash_v[n_form - 1 - n_suffix] == hash_v_[n_old - 1 - n_suffix]))
+                ++n_suffix;
+
+            /* cached entry for each form;  nullptr -> must parse.
+             * Each cached entry is matched at most once,  and only if
+             * its normalized text is the same (not just its hash).
+             * span_v[i]: span of each expression in form i
+             */
+            std::vector<form_entry *> old_v(n_form, nullptr);
+            std::vector<std::vector<span_type>> span_v(n_form);
+            std::vector<bool> used_v(n_old, false);
+
+            auto try_match = [this, &form_v, &old_v, &span_v, &used_v](std::size_t i, std::size_t j)
+                                 {
+                                     if (!match_form(form_v[i], form_v_[j], &span_v[i]))
+                                         return false;
+
+                                     old_v[i] = &form_v_[j];
+                                     used_v[j] = true;
+
+                                     return true;
+                                 };
+
+            for (std::size_t i = 0; i < n_prefix; ++i)
+                try_match(i, i);
+            for (std::size_t j = 0; j < n_suffix; ++j)
+                try_match(n_form - 1 - j, n_old - 1 - j);
+
+            /* forms in between match by key */
+            std::unordered_multimap<std::uint64_t, std::size_t> middle;
+
+            middle.reserve(n_old - n_prefix - n_suffix);
+
+            for (std::size_t j = n_prefix; j + n_suffix < n_old; ++j)
+                middle.emplace(hash_v_[j], j);
+
+            for (std::size_t i = n_prefix; i + n_suffix < n_form; ++i) {
+                auto range = middle.equal_range(hash_v[i]);
+
+                for (auto ix = range.first; ix != range.second; ++ix) {
+                    if (try_match(i, ix->second)) {
+                        middle.erase(ix);
+                        break;
+                    }
+                }
+            }
+
+            /* names whose definition was added, removed or changed:
+             * cached forms not matched above were removed or edited
+             */
+            std::unordered_set<std::string> changed_set;
+
+            for (std::size_t j = 0; j < n_old; ++j) {
+                if (!used_v[j])
+                    changed_set.insert(form_v_[j].def_v_.begin(), form_v_[j].def_v_.end());
+            }
+
+            /* 3. parse new/edited forms */
+            std::vector<form_entry> new_v(n_form);
+            std::vector<bool> parsed_v(n_form, false);
+
+            for (std::size_t i = 0; i < n_form; ++i) {
+                if (!old_v[i]) {
+                    new_v[i] = this->parse_form(form_v[i]);
+                    match_form(form_v[i], new_v[i], &span_v[i]);
+                    parsed_v[i] = true;
+                    ++stats_.n_changed_;
+
+                    changed_set.insert(new_v[i].def_v_.begin(), new_v[i].def_v_.end());
+                }
+            }
+
+            /* 4. reparse unchanged forms that mention a changed name,
+             *    until no more names change
+             */
+            for (std::unordered_set<std::string> frontier = changed_set; !frontier.empty(); ) {
+                std::unordered_set<std::string> next;
+
+                for (std::size_t i = 0; i < n_form; ++i) {
+                    if (parsed_v[i] || !mentions_any(old_v[i]->word_v_, frontier))
+                        continue;
+
+                    new_v[i] = this->parse_form(form_v[i]);
+                    match_form(form_v[i], new_v[i], &span_v[i]);
+                    parsed_v[i] = true;
+                    ++stats_.n_invalidated_;
+
+                    for (const auto & name : new_v[i].def_v_) {
+                        if (changed_set.insert(name).second)
+                            next.insert(name);
+                    }
+                }
+
+                frontier = std::move(next);
+            }
+
+            /* 5. every parse succeeded:  assemble results,  replace cache */
+            std::vector<reader_result> retval;
+            retval.reserve(n_form);
+
+            for (std::size_t i = 0; i < n_form; ++i) {
+                if (!parsed_v[i]) {
+                    new_v[i] = std::move(*old_v[i]);
+                    ++stats_.n_reused_;
+                }
+
+                const auto & expr_v = new_v[i].expr_v_;
+
+                for (std::size_t k = 0; k < expr_v.size(); ++k)
+                    retval.emplace_back(expr_v[k].expr_, span_v[i][k], expr_v[k].varref_v_);
+            }
+
+            hash_v_ = std::move(hash_v);
+            form_v_ = std::move(new_v);
+
+            return retval;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end incrementalreader.cpp */
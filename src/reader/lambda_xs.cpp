@@ -18,6 +18,7 @@ namespace xo {
             case lambdastatetype::lm_0: return "lm_0";
             case lambdastatetype::lm_1: return "lm_1";
             case lambdastatetype::lm_2: return "lm_2";
+            case lambdastatetype::lm_2z: return "lm_2z";
             case lambdastatetype::lm_3: return "lm_3";
             default: break;
             }
@@ -27,17 +28,11 @@ namespace xo {
 
         // ----- lambda_xs - ----
 
-        std::unique_ptr<lambda_xs>
-        lambda_xs::make() {
-            return std::make_unique<lambda_xs>(lambda_xs());
-        }
-
         void
         lambda_xs::start(parserstatemachine * p_psm)
         {
-            p_psm->push_exprstate(lambda_xs::make());
-            p_psm->top_exprstate()
-                .on_lambda_token(token_type::lambda(), p_psm);
+            p_psm->push_new_exprstate<lambda_xs>();
+            p_psm->on_lambda_token(token_type::lambda());
         }
 
         lambda_xs::lambda_xs() : exprstate(exprstatetype::lambdaexpr) {}
@@ -59,17 +54,71 @@ namespace xo {
                                      parserstatemachine * p_psm)
         {
             if (lmxs_type_ == lambdastatetype::lm_1) {
-                this->lmxs_type_ = lambdastatetype::lm_2;
                 this->argl_ = argl;
+                p_psm->note_alloc(alloccategory::lambda_argl,
+                                  argl.size() * sizeof(rp<Variable>));
 
-                p_psm->push_envframe(envframe(argl));
+                if (p_psm->lazy_lambda_enabled()) {
+                    /* offer to take body as text;  see on_lazy_body() */
+                    this->lmxs_type_ = lambdastatetype::lm_2z;
 
-                expect_expr_xs::start(p_psm);
+                    p_psm->request_lazy_body();
+                } else {
+                    this->lmxs_type_ = lambdastatetype::lm_2;
+
+                    p_psm->push_envframe(envframe(argl));
+
+                    expect_expr_xs::start(p_psm);
+                }
             } else {
                 exprstate::on_formal_arglist(argl, p_psm);
             }
         }
 
+        void
+        lambda_xs::on_lazy_body(const span<const char> & body,
+                                parserstatemachine * p_psm)
+        {
+            if (lmxs_type_ != lambdastatetype::lm_2z) {
+                exprstate::on_lazy_body(body, p_psm);
+                return;
+            }
+
+            if (body.empty()) {
+                /* declined:  parse body from tokens */
+                this->lmxs_type_ = lambdastatetype::lm_2;
+
+                p_psm->push_envframe(envframe(argl_));
+
+                expect_expr_xs::start(p_psm);
+            } else {
+                this->lmxs_type_ = lambdastatetype::lm_3;
+
+                /* body will see enclosing frames as they are now,
+                 * plus formals
+                 */
+                std::vector<envframe> frame_v = p_psm->p_env_stack_->frame_v();
+                frame_v.push_back(envframe(argl_));
+
+                /* estimate: outer buffer + formals frame.
+                 * Enclosing frames' contents are shared (copy-on-write),  not copied
+                 */
+                p_psm->note_alloc(alloccategory::envframe,
+                                  frame_v.size() * sizeof(envframe)
+                                  + argl_.size() * sizeof(rp<Variable>));
+
+                lazylambda_options options;
+                options.engine_ = p_psm->engine();
+                options.constant_folding_ = p_psm->constant_folding_enabled();
+                options.lazy_lambda_ = p_psm->lazy_lambda_enabled();
+
+                this->lazy_ = LazyLambda::make("fixmename", argl_, std::move(frame_v),
+                                               std::string(body.lo(), body.hi()),
+                                               options);
+                p_psm->note_alloc(alloccategory::expression, sizeof(LazyLambda));
+            }
+        }
+
         void
         lambda_xs::on_expr(ref::brw<Expression> expr,
                            parserstatemachine * p_psm)
@@ -97,16 +146,27 @@ namespace xo {
             if (lmxs_type_ == lambdastatetype::lm_3) {
                 /* done! */
 
-                std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
-
                 std::string name = "fixmename";
 
-                rp<Lambda> lm = Lambda::make(name, argl_, body_);
+                /* lazy body never pushed an envframe */
+                bool lazy = lazy_.get();
+                rp<Expression> lm;
+
+                if (lazy)
+                    lm = lazy_;
+                else {
+                    lm = Lambda::make(name, argl_, body_);
+                    p_psm->note_alloc(alloccategory::expression, sizeof(Lambda));
+                }
+
+                /* note: *this destroyed here */
+                p_psm->pop_exprstate();
 
-                p_psm->pop_envframe();
+                if (!lazy)
+                    p_psm->pop_envframe();
 
-                p_psm->top_exprstate().on_expr(lm, p_psm);
-                p_psm->top_exprstate().on_semicolon_token(tk, p_psm);
+                p_psm->on_expr(lm);
+                p_psm->on_semicolon_token(tk);
 
                 return;
             }
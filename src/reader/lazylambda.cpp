@@ -0,0 +1,123 @@
+/* file lazylambda.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "lazylambda.hpp"
+#include "parser.hpp"
+#include "segmenter.hpp"
+#include "xo/tokenizer/tokenizer.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <stdexcept>
+
+namespace xo {
+    using xo::ast::Expression;
+    using xo::ast::exprtype;
+
+    namespace scm {
+        rp<LazyLambda>
+        LazyLambda::make(const std::string & name,
+                         const std::vector<rp<Variable>> & argl,
+                         std::vector<envframe> frame_v,
+                         std::string body_text,
+                         const lazylambda_options & options)
+        {
+            return new LazyLambda(name, argl, std::move(frame_v), std::move(body_text), options);
+        }
+
+        LazyLambda::LazyLambda(const std::string & name,
+                               const std::vector<rp<Variable>> & argl,
+                               std::vector<envframe> frame_v,
+                               std::string body_text,
+                               const lazylambda_options & options)
+            : Expression(exprtype::invalid, nullptr /*valuetype: body not seen yet*/),
+              name_{name},
+              argl_{argl},
+              frame_v_{std::move(frame_v)},
+              body_text_{std::move(body_text)},
+              options_{options}
+        {}
+
+        auto
+        LazyLambda::force() -> rp<Lambda>
+        {
+            constexpr const char * c_self_name = "LazyLambda::force";
+
+            if (lambda_)
+                return lambda_;
+
+            using tokenizer_type = tokenizer<char>;
+            using span_type = tokenizer_type::span_type;
+
+            /* same settings as parser that deferred this body */
+            parser psr(options_.engine_);
+            psr.enable_constant_folding(options_.constant_folding_);
+            psr.enable_lazy_lambda(options_.lazy_lambda_);
+            psr.begin_lambda_body(frame_v_);
+
+            tokenizer_type tkz;
+            rp<Expression> body;
+
+            span_type input(body_text_.data(), body_text_.data() + body_text_.size());
+
+            while (!input.empty() && !body) {
+                if (psr.lazy_body_pending()) {
+                    /* nested lambda body:  skip by brace matching,  as reader does */
+                    span_type block = segmenter::leading_block(input);
+                    span_type used = (block.empty()
+                                      ? input.prefix(0ul)
+                                      : span_type(input.lo(), block.hi()));
+
+                    input = input.after_prefix(used);
+                    body = psr.include_lazy_body(block);
+
+                    continue;
+                }
+
+                auto sr = tkz.scan2(input, true /*eof*/);
+
+                input = input.after_prefix(sr.second);
+
+                if (sr.first.is_valid())
+                    body = psr.include_token(sr.first);
+            }
+
+            /* block expression completes on a following token,
+             * like the ';' after a lambda
+             */
+            if (!body)
+                body = psr.include_token(parser::token_type::semicolon());
+
+            if (!body || psr.has_incomplete_expr() || !input.empty()) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": body did not parse as one expression",
+                           xtag("name", name_),
+                           xtag("body", body_text_)));
+            }
+
+            this->lambda_ = Lambda::make(name_, argl_, body);
+            this->varref_v_ = psr.take_varrefs();
+
+            /* context no longer needed */
+            this->frame_v_.clear();
+
+            return lambda_;
+        }
+
+        void
+        LazyLambda::display(std::ostream & os) const {
+            if (lambda_) {
+                lambda_->display(os);
+                return;
+            }
+
+            os << "<LazyLambda"
+               << xtag("name", name_)
+               << xtag("argl", argl_)
+               << xtag("body.size", body_text_.size())
+               << ">";
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end lazylambda.cpp */
@@ -0,0 +1,29 @@
+/* file lexaddr.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "lexaddr.hpp"
+#include "xo/indentlog/print/tag.hpp"
+
+namespace xo {
+    namespace scm {
+        void
+        lexaddr::print(std::ostream & os) const {
+            os << "<lexaddr"
+               << xtag("depth", depth_)
+               << xtag("slot", slot_)
+               << ">";
+        }
+
+        void
+        varref::print(std::ostream & os) const {
+            os << "<varref"
+               << xtag("var", var_.get())
+               << xtag("addr", addr_)
+               << ">";
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end lexaddr.cpp */
@@ -0,0 +1,62 @@
+/* file logpolicy.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "logpolicy.hpp"
+#include <utility>
+
+namespace xo {
+    namespace scm {
+        const char *
+        logmodule_descr(logmodule x) {
+            switch (x) {
+            case logmodule::reader: return "reader";
+            case logmodule::parser: return "parser";
+            case logmodule::psm: return "psm";
+            case logmodule::stack: return "stack";
+            case logmodule::exprstate: return "exprstate";
+            case logmodule::expect_expr: return "expect_expr";
+            case logmodule::define: return "define";
+            case logmodule::lambda: return "lambda";
+            case logmodule::paren: return "paren";
+            case logmodule::progress: return "progress";
+            case logmodule::sequence: return "sequence";
+            case logmodule::n_logmodule: break;
+            }
+
+            return "???logmodule";
+        }
+
+        namespace {
+            /** default verbosity 1 for each module.
+             *  (atomics can't be filled then copied,  so build in place)
+             **/
+            template <std::size_t... Ix>
+            constexpr std::array<std::atomic<int>, sizeof...(Ix)>
+            default_verbosity_v(std::index_sequence<Ix...>) {
+                return {{ ((void)Ix, 1)... }};
+            }
+        }
+
+        std::array<std::atomic<int>, logpolicy::c_n_module>
+        logpolicy::s_verbosity_v
+            = default_verbosity_v(std::make_index_sequence<logpolicy::c_n_module>());
+
+        void
+        logpolicy::set_verbosity(logmodule m, int level) {
+            std::size_t i = static_cast<std::size_t>(m);
+
+            if (i < c_n_module)
+                s_verbosity_v[i].store(level, std::memory_order_relaxed);
+        }
+
+        void
+        logpolicy::set_verbosity_all(int level) {
+            for (auto & x : s_verbosity_v)
+                x.store(level, std::memory_order_relaxed);
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end logpolicy.cpp */
@@ -0,0 +1,108 @@
+/* file mapped_file.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "mapped_file.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <stdexcept>
+#include <utility>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xo {
+    namespace scm {
+        mapped_file
+        mapped_file::open(const std::string & path)
+        {
+            constexpr const char * c_self_name = "mapped_file::open";
+
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd < 0) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": open failed",
+                           xtag("path", path),
+                           xtag("err", std::strerror(errno))));
+            }
+
+            struct stat st;
+
+            if (::fstat(fd, &st) != 0) {
+                int err = errno;
+                ::close(fd);
+
+                throw std::runtime_error
+                    (tostr(c_self_name, ": fstat failed",
+                           xtag("path", path),
+                           xtag("err", std::strerror(err))));
+            }
+
+            std::size_t z = st.st_size;
+
+            if (z == 0) {
+                /* mmap rejects zero length */
+                ::close(fd);
+
+                return mapped_file(path, nullptr, 0);
+            }
+
+            void * addr = ::mmap(nullptr, z, PROT_READ, MAP_PRIVATE, fd, 0);
+            int err = errno;
+
+            /* mapping holds its own reference to the file */
+            ::close(fd);
+
+            if (addr == MAP_FAILED) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": mmap failed",
+                           xtag("path", path),
+                           xtag("size", z),
+                           xtag("err", std::strerror(err))));
+            }
+
+            /* advisory only;  ignore failure */
+            ::madvise(addr, z, MADV_SEQUENTIAL);
+
+            return mapped_file(path, static_cast<const char *>(addr), z);
+        }
+
+        mapped_file::mapped_file(mapped_file && x)
+            : path_{std::move(x.path_)},
+              lo_{std::exchange(x.lo_, nullptr)},
+              size_{std::exchange(x.size_, 0)}
+        {}
+
+        mapped_file::~mapped_file() {
+            this->unmap();
+        }
+
+        mapped_file &
+        mapped_file::operator=(mapped_file && x) {
+            if (this != &x) {
+                this->unmap();
+
+                path_ = std::move(x.path_);
+                lo_ = std::exchange(x.lo_, nullptr);
+                size_ = std::exchange(x.size_, 0);
+            }
+
+            return *this;
+        }
+
+        void
+        mapped_file::unmap() {
+            if (lo_)
+                ::munmap(const_cast<char *>(lo_), size_);
+
+            lo_ = nullptr;
+            size_ = 0;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end mapped_file.cpp */
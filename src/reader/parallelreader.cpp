@@ -0,0 +1,223 @@
+/* file parallelreader.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "parallelreader.hpp"
+#include "segmenter.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace xo {
+    namespace scm {
+        parallelreader::parallelreader(std::size_t n_thread, parserengine engine)
+        {
+            if (n_thread == 0)
+                n_thread = std::max(1u, std::thread::hardware_concurrency());
+
+            reader_v_.reserve(n_thread);
+
+            for (std::size_t i = 0; i < n_thread; ++i) {
+                reader_v_.push_back(std::make_unique<reader>(engine));
+                reader_v_.back()->attach_symtab(&symtab_);
+            }
+        }
+
+        parallelreader::~parallelreader() = default;
+
+        template <typename Task>
+        void
+        parallelreader::run(std::size_t n, Task && task)
+        {
+            std::atomic<std::size_t> cursor{0};
+
+            auto worker = [this, n, &cursor, &task](std::size_t k)
+                              {
+                                  reader * p_reader = reader_v_[k].get();
+
+                                  for (;;) {
+                                      std::size_t i = cursor.fetch_add(1, std::memory_order_relaxed);
+
+                                      if (i >= n)
+                                          break;
+
+                                      task(p_reader, i);
+                                  }
+                              };
+
+            std::size_t n_worker = std::min(n, reader_v_.size());
+
+            if (n_worker <= 1) {
+                /* not worth a thread */
+                worker(0);
+                return;
+            }
+
+            std::vector<std::thread> thread_v;
+            thread_v.reserve(n_worker - 1);
+
+            for (std::size_t k = 1; k < n_worker; ++k)
+                thread_v.emplace_back(worker, k);
+
+            /* calling thread is worker 0 */
+            worker(0);
+
+            for (auto & th : thread_v)
+                th.join();
+        }
+
+        void
+        parallelreader::read_one(reader * p_reader,
+                                 const span_type & input,
+                                 parallel_result * p_result)
+        {
+            try {
+                p_reader->begin_translation_unit();
+                p_reader->read_all(input, true /*eof*/, &(p_result->result_v_));
+            } catch (std::exception & ex) {
+                p_result->error_ = ex.what();
+            }
+        }
+
+        std::vector<parallel_result>
+        parallelreader::read_buffers(const std::vector<span_type> & input_v)
+        {
+            std::vector<parallel_result> retval(input_v.size());
+
+            this->run(input_v.size(),
+                      [&input_v, &retval](reader * p_reader, std::size_t i)
+                          {
+                              read_one(p_reader, input_v[i], &retval[i]);
+                          });
+
+            return retval;
+        }
+
+        std::vector<parallel_result>
+        parallelreader::read_files(const std::vector<std::string> & path_v)
+        {
+            std::vector<parallel_result> retval(path_v.size());
+
+            this->run(path_v.size(),
+                      [&path_v, &retval](reader * p_reader, std::size_t i)
+                          {
+                              parallel_result * p_result = &retval[i];
+
+                              try {
+                                  p_result->file_ = mapped_file::open(path_v[i]);
+                              } catch (std::exception & ex) {
+                                  p_result->error_ = ex.what();
+                                  return;
+                              }
+
+                              read_one(p_reader, p_result->file_.contents(), p_result);
+                          });
+
+            return retval;
+        }
+        parallel_result
+        parallelreader::read_split(const span_type & input, std::size_t n_segment)
+        {
+            if (n_segment == 0)
+                n_segment = 4 * this->n_thread();
+
+            return this->read_split(input, segmenter::split(input, n_segment));
+        }
+
+        parallel_result
+        parallelreader::read_split(const span_type & input,
+                                   const std::vector<std::size_t> & cut_v)
+        {
+            std::vector<span_type> seg_v;
+            seg_v.reserve(cut_v.size() + 1);
+
+            {
+                std::size_t lo = 0;
+
+                for (std::size_t cut : cut_v) {
+                    if ((cut <= lo) || (cut >= input.size())) {
+                        throw std::runtime_error
+                            (tostr("parallelreader::read_split: expected increasing cuts within input",
+                                   xtag("cut", cut),
+                                   xtag("prev", lo),
+                                   xtag("size", input.size())));
+                    }
+
+                    seg_v.push_back(span_type(input.lo() + lo, input.lo() + cut));
+                    lo = cut;
+                }
+
+                seg_v.push_back(span_type(input.lo() + lo, input.hi()));
+            }
+
+            this->split_stats_ = split_stats();
+            this->split_stats_.n_segment_ = seg_v.size();
+
+            /* speculative:  assume each segment starts at a toplevel boundary */
+            std::vector<parallel_result> spec_v = this->read_buffers(seg_v);
+
+            parallel_result retval;
+
+            /* workers idle now;  borrow one for serial re-reads */
+            reader * serial = reader_v_[0].get();
+            /* true while serial reader is between segments,  mid-expression */
+            bool in_serial = false;
+            /* start of next expression from serial reader.
+             * Reader only reports the part of an expression's span within
+             * the current segment;  widen to whole expression
+             */
+            const char * expr_lo = nullptr;
+            auto serial_sink = [&retval, &expr_lo](reader_result && rr)
+                                   {
+                                       rr.rem_ = span_type(expr_lo, rr.rem_.hi());
+                                       expr_lo = rr.rem_.hi();
+
+                                       retval.result_v_.push_back(std::move(rr));
+                                   };
+
+            try {
+                for (std::size_t i = 0; i < seg_v.size(); ++i) {
+                    if (!in_serial) {
+                        if (spec_v[i].error_.empty()) {
+                            for (auto & rr : spec_v[i].result_v_)
+                                retval.result_v_.push_back(std::move(rr));
+
+                            continue;
+                        }
+
+                        /* bad cut at either end of segment i,  or a real error:
+                         * segment i begins at a verified boundary,  so re-read from there
+                         */
+                        serial->begin_translation_unit();
+                        in_serial = true;
+                        expr_lo = seg_v[i].lo();
+                    }
+
+                    ++(this->split_stats_.n_reparse_);
+
+                    serial->read_all(seg_v[i], false /*!eof*/, serial_sink);
+
+                    /* end of segment i verified as a toplevel boundary;
+                     * speculative result for segment i+1 is good (if it parsed)
+                     */
+                    if (!serial->has_incomplete_expr())
+                        in_serial = false;
+                }
+
+                if (in_serial) {
+                    /* reports incomplete expression at eof */
+                    serial->read_all(span_type(input.hi(), input.hi()), true /*eof*/,
+                                     serial_sink);
+                }
+            } catch (std::exception & ex) {
+                retval.error_ = ex.what();
+            }
+
+            return retval;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end parallelreader.cpp */
@@ -26,15 +26,10 @@ namespace xo {
               parenxs_type_{parenexprstatetype::lparen_0}
         {}
 
-        std::unique_ptr<paren_xs>
-        paren_xs::make() {
-            return std::make_unique<paren_xs>(paren_xs());
-        }
-
         void
         paren_xs::start(parserstatemachine * p_psm)
         {
-            p_psm->push_exprstate(paren_xs::make());
+            p_psm->push_new_exprstate<paren_xs>();
             expect_expr_xs::start(p_psm);
         }
 
@@ -91,8 +86,7 @@ namespace xo {
         paren_xs::on_symbol_token(const token_type & /*tk*/,
                                   parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::paren);
 
             log && log(xtag("exstype", p_psm->top_exprstate().exs_type()));
 
@@ -151,8 +145,7 @@ namespace xo {
         paren_xs::on_rightparen_token(const token_type & tk,
                                       parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::paren);
 
             constexpr const char * c_self_name = "paren_xs::on_rightparen";
 
@@ -164,9 +157,9 @@ namespace xo {
             if (this->parenxs_type_ == parenexprstatetype::lparen_1) {
                 rp<Expression> expr = this->gen_expr_;
 
-                std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+                p_psm->pop_exprstate();
 
-                p_psm->top_exprstate().on_expr(expr, p_psm);
+                p_psm->on_expr(expr);
             }
         }
 
@@ -174,8 +167,7 @@ namespace xo {
         paren_xs::on_f64_token(const token_type & tk,
                                parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::paren);
 
             constexpr const char * c_self_name = "paren_xs::on_f64";
 
@@ -186,8 +178,7 @@ namespace xo {
         paren_xs::on_expr(ref::brw<Expression> expr,
                           parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::paren);
 
             log && log(xtag("exstype", this->exs_type_),
                        xtag("expr", expr));
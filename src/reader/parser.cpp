@@ -7,6 +7,7 @@
 #include "parserstatemachine.hpp"
 #include "define_xs.hpp"
 #include "exprseq_xs.hpp"
+#include "expect_expr_xs.hpp"
 #include "xo/expression/DefineExpr.hpp"
 #include "xo/expression/Constant.hpp"
 #include "xo/expression/ConvertExpr.hpp"
@@ -22,30 +23,150 @@ namespace xo {
     using xo::reflect::TypeDescr;
 
     namespace scm {
+        const char *
+        parserengine_descr(parserengine x) {
+            switch (x) {
+            case parserengine::virtual_dispatch:
+                return "virtual_dispatch";
+            case parserengine::variant_dispatch:
+                return "variant_dispatch";
+            case parserengine::n_parserengine:
+                break;
+            }
+
+            return "???parserengine";
+        }
+
+        namespace {
+            template <typename T>
+            exprstatevariant
+            copy_as(const exprstate & xs) {
+                return exprstatevariant(std::in_place_type<T>, static_cast<const T &>(xs));
+            }
+
+            /* copy of @p xs,  with its concrete type */
+            exprstatevariant
+            copy_exprstate(const exprstate & xs) {
+                switch (xs.exs_type()) {
+                case exprstatetype::expect_toplevel_expression_sequence:
+                    return copy_as<exprseq_xs>(xs);
+                case exprstatetype::defexpr:
+                    return copy_as<define_xs>(xs);
+                case exprstatetype::lambdaexpr:
+                    return copy_as<lambda_xs>(xs);
+                case exprstatetype::parenexpr:
+                    return copy_as<paren_xs>(xs);
+                case exprstatetype::sequenceexpr:
+                    return copy_as<sequence_xs>(xs);
+                case exprstatetype::expect_rhs_expression:
+                    return copy_as<expect_expr_xs>(xs);
+                case exprstatetype::expect_symbol:
+                    return copy_as<expect_symbol_xs>(xs);
+                case exprstatetype::expect_type:
+                    return copy_as<expect_type_xs>(xs);
+                case exprstatetype::expect_formal_arglist:
+                    return copy_as<expect_formal_arglist_xs>(xs);
+                case exprstatetype::expect_formal:
+                    return copy_as<expect_formal_xs>(xs);
+                case exprstatetype::expr_progress:
+                    return copy_as<progress_xs>(xs);
+                case exprstatetype::invalid:
+                case exprstatetype::n_exprstatetype:
+                    break;
+                }
+
+                throw std::runtime_error(tostr("parser::checkpoint",
+                                               ": unexpected exprstate type",
+                                               xtag("type", xs.exs_type())));
+            }
+        }
+
         // ----- parser -----
 
+        parserstatemachine
+        parser::make_psm(rp<Expression> * p_emit_expr) {
+            if (engine_ == parserengine::variant_dispatch) {
+                return parserstatemachine(nullptr /*p_stack*/,
+                                          &vxs_stack_,
+                                          &env_stack_,
+                                          &varref_v_,
+                                          &folder_,
+                                          &lazy_,
+                                          (stats_enabled_ ? &stats_ : nullptr),
+                                          alloc_,
+                                          &xs_resource_,
+                                          p_emit_expr);
+            } else {
+                return parserstatemachine(&xs_stack_,
+                                          nullptr /*p_vstack*/,
+                                          &env_stack_,
+                                          &varref_v_,
+                                          &folder_,
+                                          &lazy_,
+                                          (stats_enabled_ ? &stats_ : nullptr),
+                                          alloc_,
+                                          &xs_resource_,
+                                          p_emit_expr);
+            }
+        }
+
+        void
+        parser::attach_allocaccount(allocaccount * account) {
+            /* only allocations made while attached consult the account;
+             * memory already handed out never refers back to it
+             */
+            xs_stack_.attach_allocaccount(account);
+            vxs_stack_.attach_allocaccount(account);
+            xs_resource_.set_account(account);
+
+            alloc_ = account;
+        }
+
         bool
         parser::has_incomplete_expr() const {
-            return !xs_stack_.empty();
+            /* bottom of stack is exprseq_xs,  see begin_translation_unit() */
+            return this->stack_size() > 1;
         }
 
         void
         parser::begin_translation_unit() {
+            varref_v_.clear();
+
             /* note: not using emit expr here */
-            parserstatemachine psm(&xs_stack_,
-                                   &env_stack_,
-                                   nullptr /*p_emit_expr*/);
+            parserstatemachine psm = this->make_psm(nullptr /*p_emit_expr*/);
+
+            /* discard state left by previous translation unit
+             * (e.g. if it ended in a parse error)
+             */
+            while (!psm.empty_exprstate())
+                psm.pop_exprstate();
+            while (!env_stack_.empty())
+                env_stack_.pop_envframe();
+
+            lazy_.pending_ = false;
 
             exprseq_xs::start(&psm);
         }
 
+        void
+        parser::begin_lambda_body(const std::vector<envframe> & frame_v)
+        {
+            this->begin_translation_unit();
+
+            for (const envframe & frame : frame_v)
+                env_stack_.push_envframe(frame);
+
+            parserstatemachine psm = this->make_psm(nullptr /*p_emit_expr*/);
+
+            expect_expr_xs::start(&psm);
+        }
+
         rp<Expression>
         parser::include_token(const token_type & tk)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag), xtag("tk", tk));
+            XO_READER_SCOPE(log, logmodule::parser, xtag("tk", tk));
 
-            if (xs_stack_.empty()) {
+            if (this->stack_size() == 0) {
                 throw std::runtime_error(tostr("parser::include_token",
                                                 ": parser not expecting input"
                                                "(call parser.begin_translation_unit()..?)",
@@ -56,21 +177,122 @@ namespace xo {
 
             rp<Expression> retval;
 
-            parserstatemachine psm(&xs_stack_, &env_stack_, &retval);
+            parserstatemachine psm = this->make_psm(&retval);
+
+            if (lazy_.pending_) {
+                /* driver didn't offer body text:  parse body from tokens */
+                lazy_.pending_ = false;
+                psm.on_lazy_body(span<const char>());
+            }
+
+            psm.on_input(tk);
 
-            xs_stack_.top_exprstate().on_input(tk, &psm);
+            if (retval) {
+                if (parserstats * stats = psm.stats())
+                    stats->on_toplevel();
+            }
 
             log && log(xtag("retval", retval));
 
             return retval;
         } /*include_token*/
 
+        rp<Expression>
+        parser::include_lazy_body(const span<const char> & body)
+        {
+            XO_READER_SCOPE(log, logmodule::parser, xtag("body.size", body.size()));
+
+            if (!lazy_.pending_) {
+                throw std::runtime_error(tostr("parser::include_lazy_body",
+                                               ": parser not expecting lambda body text",
+                                               xtag("body.size", body.size())));
+            }
+
+            lazy_.pending_ = false;
+
+            rp<Expression> retval;
+
+            parserstatemachine psm = this->make_psm(&retval);
+
+            psm.on_lazy_body(body);
+
+            if (retval) {
+                if (parserstats * stats = psm.stats())
+                    stats->on_toplevel();
+            }
+
+            return retval;
+        }
+
+        parser_checkpoint
+        parser::checkpoint() const
+        {
+            parser_checkpoint retval;
+
+            std::size_t z = this->stack_size();
+
+            retval.xs_v_.reserve(z);
+
+            /* bottom of stack first.
+             * O(1) per state:  bulky contents are copy-on-write (see cowvector)
+             */
+            for (std::size_t i = z; i > 0; --i)
+                retval.xs_v_.push_back(copy_exprstate(*this->i_exstate(i - 1)));
+
+            /* O(1) per frame,  likewise */
+            retval.frame_v_ = env_stack_.frame_v();
+            retval.n_varref_ = varref_v_.size();
+            retval.lazy_pending_ = lazy_.pending_;
+
+            return retval;
+        }
+
+        void
+        parser::restore(const parser_checkpoint & cp)
+        {
+            XO_READER_SCOPE(log, logmodule::parser, xtag("cp.stack_size", cp.stack_size()));
+
+            parserstatemachine psm = this->make_psm(nullptr /*p_emit_expr*/);
+
+            /* rebuilding stacks is not parsing:  keep it out of parserstats */
+            psm.p_stats_ = nullptr;
+
+            while (!psm.empty_exprstate())
+                psm.pop_exprstate();
+
+            /* keeps frames unchanged since cp */
+            env_stack_.restore_frames(cp.frame_v_);
+
+            /* copy again:  cp may be restored more than once.
+             * Copies share contents with cp,  and keep allocating from
+             * this parser's xs_resource_ (see sequence_xs, progress_xs)
+             */
+            for (const exprstatevariant & xs : cp.xs_v_) {
+                std::visit([&psm](const auto & x)
+                               {
+                                   using T = std::decay_t<decltype(x)>;
+
+                                   psm.push_new_exprstate<T>(x);
+                               },
+                           xs);
+            }
+
+            if (varref_v_.size() > cp.n_varref_)
+                varref_v_.erase(varref_v_.begin() + cp.n_varref_, varref_v_.end());
+
+            lazy_.pending_ = cp.lazy_pending_;
+        }
+
         void
         parser::print(std::ostream & os) const {
             os << "<parser"
+               << xtag("engine", engine_)
                << std::endl;
 
-            xs_stack_.print(os);
+            if (engine_ == parserengine::variant_dispatch)
+                vxs_stack_.print(os);
+            else
+                xs_stack_.print(os);
 
             os << ">" << std::endl;
         }
@@ -5,144 +5,280 @@
 
 #include "parserstatemachine.hpp"
 #include "exprstatestack.hpp"
+#include "xo/expression/Variable.hpp"
+#include "xo/indentlog/print/vector.hpp"
 
 namespace xo {
     using xo::ast::Variable;
 
     namespace scm {
         rp<Variable>
-        parserstatemachine::lookup_var(const std::string & x) const {
+        parserstatemachine::lookup_var(std::string_view x) const {
             return p_env_stack_->lookup(x);
         }
 
-        std::unique_ptr<exprstate>
+        bool
+        parserstatemachine::empty_exprstate() const {
+            if (p_vstack_)
+                return p_vstack_->empty();
+            else
+                return p_stack_->empty();
+        }
+
+        void
         parserstatemachine::pop_exprstate() {
-            return p_stack_->pop_exprstate();
+            if (parserstats * stats = this->stats())
+                stats->on_pop(this->top_exprstate().exs_type());
+
+            if (p_vstack_)
+                p_vstack_->pop_exprstate();
+            else
+                p_stack_->pop_exprstate();
         }
 
         exprstate &
         parserstatemachine::top_exprstate() {
-            return p_stack_->top_exprstate();
+            if (p_vstack_)
+                return p_vstack_->top_exprstate();
+            else
+                return p_stack_->top_exprstate();
         }
 
-        void
-        parserstatemachine::push_exprstate(std::unique_ptr<exprstate> x) {
-            p_stack_->push_exprstate(std::move(x));
+        rp<Variable>
+        parserstatemachine::make_varref(std::string_view x) {
+            lexaddr addr;
+            rp<Variable> var = p_env_stack_->lookup_addr(x, &addr);
+
+            if (parserstats * stats = this->stats()) {
+                if (var)
+                    stats->on_lookup_hit(addr.depth_);
+                else
+                    stats->on_lookup_miss();
+            }
+
+            if (!var)
+                return nullptr;
+
+            rp<Variable> ref = Variable::make(var->name(), var->valuetype());
+            this->note_alloc(alloccategory::expression, sizeof(Variable));
+
+            if (p_varref_v_)
+                p_varref_v_->push_back(varref(ref, addr));
+
+            return ref;
         }
 
         void
         parserstatemachine::push_envframe(envframe x) {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            /* x.argl() is a copy of the lambda's formals */
+            if (!x.argl().empty())
+                this->note_alloc(alloccategory::envframe,
+                                 x.argl().size() * sizeof(rp<Variable>));
 
             log && log(xtag("frame", x));
 
             p_env_stack_->push_envframe(std::move(x));
+
+            if (parserstats * stats = this->stats())
+                stats->on_push_envframe(p_env_stack_->size());
         }
 
         void
         parserstatemachine::pop_envframe() {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
 
             p_env_stack_->pop_envframe();
         }
 
+        void
+        parserstatemachine::extend_envframe(const rp<Variable> & var) {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("var", var));
+
+            p_env_stack_->extend_envframe(var);
+        }
+
         void
         parserstatemachine::on_expr(ref::brw<Expression> x)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            if (parserstats * stats = this->stats())
+                stats->on_expr();
 
             log && log(xtag("x", x),
                        xtag("psm", *this));
 
-            this->p_stack_
-                ->top_exprstate().on_expr(x, this);
+            this->visit_top([x, this](auto & xs) { xs.on_expr(x, this); });
         }
 
         void
         parserstatemachine::on_expr_with_semicolon(ref::brw<Expression> x)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            if (parserstats * stats = this->stats())
+                stats->on_expr();
 
             log && log(xtag("x", x),
                        xtag("psm", *this));
 
-            this->p_stack_
-                ->top_exprstate().on_expr_with_semicolon(x, this);
+            this->visit_top([x, this](auto & xs) { xs.on_expr_with_semicolon(x, this); });
         }
 
         void
         parserstatemachine::on_symbol(const std::string & x)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
 
             log && log(xtag("x", x),
                        xtag("psm", *this));
 
-            this->p_stack_
-                ->top_exprstate().on_symbol(x, this);
+            this->visit_top([&x, this](auto & xs) { xs.on_symbol(x, this); });
+        }
+
+        void
+        parserstatemachine::on_typedescr(TypeDescr td)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("td", td),
+                       xtag("psm", *this));
+
+            this->visit_top([td, this](auto & xs) { xs.on_typedescr(td, this); });
+        }
+
+        void
+        parserstatemachine::on_formal(const rp<Variable> & formal)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("formal", formal.get()),
+                       xtag("psm", *this));
+
+            this->visit_top([&formal, this](auto & xs) { xs.on_formal(formal, this); });
+        }
+
+        void
+        parserstatemachine::on_formal_arglist(const std::vector<rp<Variable>> & argl)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("argl", argl),
+                       xtag("psm", *this));
+
+            this->visit_top([&argl, this](auto & xs) { xs.on_formal_arglist(argl, this); });
+        }
+
+        void
+        parserstatemachine::on_lazy_body(const span<const char> & body)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("body.size", body.size()),
+                       xtag("psm", *this));
+
+            this->visit_top([&body, this](auto & xs) { xs.on_lazy_body(body, this); });
+        }
+
+        void
+        parserstatemachine::on_input(const token_type & tk)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("tk", tk),
+                       xtag("psm", *this));
+
+            this->visit_top([&tk, this](auto & xs) { exprstate::dispatch_input(xs, tk, this); });
+        }
+
+        void
+        parserstatemachine::on_def_token(const token_type & tk)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("tk", tk),
+                       xtag("psm", *this));
+
+            this->visit_top([&tk, this](auto & xs) { xs.on_def_token(tk, this); });
+        }
+
+        void
+        parserstatemachine::on_lambda_token(const token_type & tk)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("tk", tk),
+                       xtag("psm", *this));
+
+            this->visit_top([&tk, this](auto & xs) { xs.on_lambda_token(tk, this); });
         }
 
         void
         parserstatemachine::on_semicolon_token(const token_type & tk)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
 
             log && log(xtag("tk", tk),
                        xtag("psm", *this));
 
-            this->p_stack_
-                ->top_exprstate().on_semicolon_token(tk, this);
+            this->visit_top([&tk, this](auto & xs) { xs.on_semicolon_token(tk, this); });
         }
 
         void
         parserstatemachine::on_operator_token(const token_type & tk)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
 
             log && log(xtag("tk", tk),
                        xtag("psm", *this));
 
-            this->p_stack_
-                ->top_exprstate().on_operator_token(tk, this);
+            this->visit_top([&tk, this](auto & xs) { xs.on_operator_token(tk, this); });
         }
 
         void
         parserstatemachine::on_leftbrace_token(const token_type & tk)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
 
             log && log(xtag("tk", tk),
                        xtag("psm", *this));
 
-            this->p_stack_
-                ->top_exprstate().on_leftbrace_token(tk, this);
+            this->visit_top([&tk, this](auto & xs) { xs.on_leftbrace_token(tk, this); });
         }
 
         void
         parserstatemachine::on_rightbrace_token(const token_type & tk)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::psm);
+
+            log && log(xtag("tk", tk),
+                       xtag("psm", *this));
+
+            this->visit_top([&tk, this](auto & xs) { xs.on_rightbrace_token(tk, this); });
+        }
+
+        void
+        parserstatemachine::on_rightparen_token(const token_type & tk)
+        {
+            XO_READER_SCOPE(log, logmodule::psm);
 
             log && log(xtag("tk", tk),
                        xtag("psm", *this));
 
-            this->p_stack_
-                ->top_exprstate().on_rightbrace_token(tk, this);
+            this->visit_top([&tk, this](auto & xs) { xs.on_rightparen_token(tk, this); });
         }
 
         void
         parserstatemachine::print(std::ostream & os) const {
             os << "<psm";
-            os << xtag("stack", p_stack_);
+            if (p_vstack_)
+                os << xtag("stack", p_vstack_);
+            else
+                os << xtag("stack", p_stack_);
             os << xtag("env_stack", p_env_stack_);
             os << xtag("emit_expr", p_emit_expr_);
             os << ">";
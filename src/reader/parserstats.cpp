@@ -0,0 +1,66 @@
+/* file parserstats.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "parserstats.hpp"
+#include "xo/indentlog/print/tag.hpp"
+
+namespace xo {
+    namespace scm {
+        namespace {
+            /* nonzero buckets of @p hist,  as {k:n k:n ..} */
+            void
+            print_histogram(std::ostream & os, const parserstats::histogram_type & hist)
+            {
+                os << "{";
+
+                bool first = true;
+                for (std::size_t k = 0; k < hist.size(); ++k) {
+                    if (hist[k] == 0)
+                        continue;
+
+                    if (!first)
+                        os << " ";
+                    os << k;
+                    if (k + 1 == hist.size())
+                        os << "+";
+                    os << ":" << hist[k];
+
+                    first = false;
+                }
+
+                os << "}";
+            }
+        }
+
+        void
+        parserstats::print(std::ostream & os) const {
+            os << "<parserstats"
+               << xtag("max_xs_depth", max_xs_depth_)
+               << xtag("max_env_depth", max_env_depth_)
+               << xtag("n_lookup", n_lookup_)
+               << xtag("n_lookup_miss", n_lookup_miss_)
+               << xtag("n_toplevel", n_toplevel_)
+               << xtag("n_expr", n_expr_)
+               << xtag("max_expr_per_toplevel", max_expr_per_toplevel_);
+
+            for (std::size_t i = 0; i < c_n_exstype; ++i) {
+                if (push_v_[i] == 0 && pop_v_[i] == 0)
+                    continue;
+
+                os << " " << static_cast<exprstatetype>(i)
+                   << ":" << push_v_[i] << "/" << pop_v_[i];
+            }
+
+            os << " :xs_depth_hist ";
+            print_histogram(os, xs_depth_hist_);
+            os << " :lookup_depth_hist ";
+            print_histogram(os, lookup_depth_hist_);
+
+            os << ">";
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end parserstats.cpp */
@@ -0,0 +1,170 @@
+/* file pipelinereader.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "pipelinereader.hpp"
+#include "xo/indentlog/print/tag.hpp"
+
+namespace xo {
+    namespace scm {
+        namespace {
+            using clock_type = std::chrono::steady_clock;
+
+            std::uint64_t
+            elapsed_ns(clock_type::time_point t0, clock_type::time_point t1) {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            }
+        }
+
+        void
+        pipeline_stats::print(std::ostream & os) const {
+            os << "<pipeline_stats"
+               << xtag("n_token", n_token_)
+               << xtag("tokenize_busy_ns", tokenize_busy_ns_)
+               << xtag("parse_busy_ns", parse_busy_ns_)
+               << xtag("n_producer_stall", n_producer_stall_)
+               << xtag("n_consumer_stall", n_consumer_stall_)
+               << xtag("mean_occupancy", this->mean_occupancy())
+               << xtag("occupancy_max", occupancy_max_)
+               << ">";
+        }
+
+        pipelinereader::pipelinereader(std::size_t capacity, parserengine engine)
+            : ring_{capacity}, parser_{engine}
+        {}
+
+        void
+        pipelinereader::start(const span_type & input)
+        {
+            /* ring is empty here:  previous read_all() drained it,
+             * or joined tokenizer after cancel.  see pop_slot() below
+             */
+            this->cancel_.store(false, std::memory_order_relaxed);
+            this->producer_error_ = nullptr;
+            this->producer_stats_ = pipeline_stats();
+            this->stats_ = pipeline_stats();
+            this->consumer_wait_ns_ = 0;
+            this->t0_ = clock_type::now();
+
+            /* discard any partial token left by previous read_all()
+             * (e.g. if it ended in an error);  safe:  tokenizer thread not running
+             */
+            tokenizer_ = tokenizer_type();
+            parser_.begin_translation_unit();
+
+            this->producer_ = std::thread([this, input] { this->produce(input); });
+        }
+
+        void
+        pipelinereader::produce(span_type input)
+        {
+            clock_type::time_point t0 = clock_type::now();
+            std::uint64_t wait_ns = 0;
+
+            auto push = [this, &wait_ns](tokenslot && slot)
+                            {
+                                if (ring_.try_push(std::move(slot)))
+                                    return true;
+
+                                ++(producer_stats_.n_producer_stall_);
+
+                                clock_type::time_point w0 = clock_type::now();
+
+                                while (!ring_.try_push(std::move(slot))) {
+                                    if (cancel_.load(std::memory_order_relaxed))
+                                        return false;
+
+                                    std::this_thread::yield();
+                                }
+
+                                wait_ns += elapsed_ns(w0, clock_type::now());
+
+                                return true;
+                            };
+
+            try {
+                while (!input.empty()) {
+                    auto sr = tokenizer_.scan2(input, true /*eof*/);
+
+                    input = input.after_prefix(sr.second);
+
+                    if (sr.first.is_valid())
+                        ++(producer_stats_.n_token_);
+
+                    if (!push(tokenslot{std::move(sr.first), sr.second}))
+                        return;
+                }
+            } catch (...) {
+                this->producer_error_ = std::current_exception();
+            }
+
+            producer_stats_.tokenize_busy_ns_ = elapsed_ns(t0, clock_type::now()) - wait_ns;
+
+            push(tokenslot{token_type(), input.prefix(0ul), true /*end*/});
+        }
+
+        auto
+        pipelinereader::pop_slot() -> tokenslot
+        {
+            tokenslot retval;
+
+            if (!ring_.try_pop(&retval)) {
+                ++(stats_.n_consumer_stall_);
+
+                clock_type::time_point w0 = clock_type::now();
+
+                while (!ring_.try_pop(&retval))
+                    std::this_thread::yield();
+
+                consumer_wait_ns_ += elapsed_ns(w0, clock_type::now());
+            }
+
+            std::size_t z = ring_.size_approx();
+
+            stats_.occupancy_sum_ += z;
+            if (z > stats_.occupancy_max_)
+                stats_.occupancy_max_ = z;
+
+            return retval;
+        }
+
+        void
+        pipelinereader::join()
+        {
+            if (producer_.joinable())
+                producer_.join();
+
+            /* after cancel,  discard anything tokenizer left behind */
+            tokenslot slot;
+            while (ring_.try_pop(&slot))
+                ;
+
+            stats_.parse_busy_ns_ = elapsed_ns(t0_, clock_type::now()) - consumer_wait_ns_;
+            stats_.n_token_ = producer_stats_.n_token_;
+            stats_.tokenize_busy_ns_ = producer_stats_.tokenize_busy_ns_;
+            stats_.n_producer_stall_ = producer_stats_.n_producer_stall_;
+        }
+
+        void
+        pipelinereader::finish()
+        {
+            if (producer_error_)
+                std::rethrow_exception(producer_error_);
+
+            if (parser_.has_incomplete_expr()) {
+                throw std::runtime_error
+                    ("pipelinereader::read_all"
+                     ": eof reached with incomplete expression");
+            }
+
+            if (tokenizer_.has_prefix()) {
+                throw std::runtime_error
+                    ("pipelinereader::read_all"
+                     ": unintelligible input recognized at eof");
+            }
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end pipelinereader.cpp */
@@ -6,77 +6,137 @@
 #include "parserstatemachine.hpp"
 #include "xo/expression/AssignExpr.hpp"
 #include "xo/expression/Apply.hpp"
+#include "xo/expression/Constant.hpp"
 
 namespace xo {
     using xo::ast::Expression;
     using xo::ast::AssignExpr;
     using xo::ast::Variable;
     using xo::ast::Apply;
+    using xo::ast::Constant;
 
     namespace scm {
+        namespace {
+            /** per-operator properties **/
+            struct opinfo {
+                optype op_;
+                const char * descr_;
+                /** binding strength;  higher binds tighter **/
+                int precedence_;
+                opassoc assoc_;
+            };
+
+            /** operator table,  indexed by optype.
+             *  Precedence follows C,  except that := is lowest
+             **/
+            constexpr opinfo s_opinfo_v[] = {
+                {optype::op_assign,        "op:=",  1, opassoc::right},
+                {optype::op_bitor,         "op|",   2, opassoc::left},
+                {optype::op_bitxor,        "op^",   3, opassoc::left},
+                {optype::op_bitand,        "op&",   4, opassoc::left},
+                {optype::op_equal,         "op==",  5, opassoc::left},
+                {optype::op_not_equal,     "op!=",  5, opassoc::left},
+                {optype::op_less,          "op<",   6, opassoc::left},
+                {optype::op_less_equal,    "op<=",  6, opassoc::left},
+                {optype::op_greater,       "op>",   6, opassoc::left},
+                {optype::op_greater_equal, "op>=",  6, opassoc::left},
+                {optype::op_add,           "op+",   7, opassoc::left},
+                {optype::op_subtract,      "op-",   7, opassoc::left},
+                {optype::op_multiply,      "op*",   8, opassoc::left},
+                {optype::op_divide,        "op/",   8, opassoc::left},
+            };
+
+            static_assert(std::size(s_opinfo_v)
+                          == static_cast<std::size_t>(optype::n_optype));
+
+            constexpr bool
+            check_opinfo() {
+                for (std::size_t i = 0; i < std::size(s_opinfo_v); ++i) {
+                    if (static_cast<std::size_t>(s_opinfo_v[i].op_) != i)
+                        return false;
+                }
+                return true;
+            }
+
+            static_assert(check_opinfo(), "s_opinfo_v must be in optype order");
+
+            const opinfo *
+            lookup_opinfo(optype x) {
+                if ((x == optype::invalid) || (x == optype::n_optype))
+                    return nullptr;
+
+                return &s_opinfo_v[static_cast<std::size_t>(x)];
+            }
+        }
+
         const char *
         optype_descr(optype x) {
-            switch (x) {
-            case optype::invalid:
+            if (x == optype::invalid)
                 return "?optype";
-            case optype::op_assign:
-                return "op:=";
-            case optype::op_add:
-                return "op+";
-            case optype::op_subtract:
-                return "op-";
-            case optype::op_multiply:
-                return "op*";
-            case optype::op_divide:
-                return "op/";
-            case optype::n_optype:
-                break;
-            }
-            return "???";
+
+            const opinfo * info = lookup_opinfo(x);
+
+            return info ? info->descr_ : "???";
         }
 
         int
         precedence(optype x) {
-            switch (x) {
-            case optype::invalid:
-            case optype::n_optype:
-                return 0;
+            const opinfo * info = lookup_opinfo(x);
 
-            case optype::op_assign:
-                return 1;
-
-            case optype::op_add:
-            case optype::op_subtract:
-                return 2;
+            return info ? info->precedence_ : 0;
+        }
 
-            case optype::op_multiply:
-            case optype::op_divide:
-                return 3;
-            }
+        opassoc
+        associativity(optype x) {
+            const opinfo * info = lookup_opinfo(x);
 
-            return 0;
+            return info ? info->assoc_ : opassoc::left;
         }
 
-        std::unique_ptr<progress_xs>
-        progress_xs::make(rp<Expression> valex, optype op) {
-            return std::make_unique<progress_xs>(progress_xs(std::move(valex), op));
-        }
+        optype
+        tk2op(tokentype tktype) {
+            /* note: tokenizer doesn't (yet) produce tokens for
+             *   | & ^ == != <= >=
+             * operator table is ready for them
+             */
+            switch (tktype) {
+            case tokentype::tk_assign:
+                return optype::op_assign;
+            case tokentype::tk_leftangle:
+                return optype::op_less;
+            case tokentype::tk_rightangle:
+                return optype::op_greater;
+            case tokentype::tk_plus:
+                return optype::op_add;
+            case tokentype::tk_minus:
+                return optype::op_subtract;
+            case tokentype::tk_star:
+                return optype::op_multiply;
+            case tokentype::tk_slash:
+                return optype::op_divide;
+            default:
+                break;
+            }
 
-        void
-        progress_xs::start(rp<Expression> valex, optype op, parserstatemachine * p_psm) {
-            p_psm->push_exprstate(progress_xs::make(valex, op));
+            return optype::invalid;
         }
 
+        // ----- progress_xs -----
+
         void
         progress_xs::start(rp<Expression> valex, parserstatemachine * p_psm) {
-            p_psm->push_exprstate(progress_xs::make(valex));
+            p_psm->push_new_exprstate<progress_xs>(std::move(valex),
+                                                   p_psm->xs_resource());
         }
 
-        progress_xs::progress_xs(rp<Expression> valex, optype op)
+        progress_xs::progress_xs(rp<Expression> valex,
+                                 std::pmr::memory_resource * mr)
             : exprstate(exprstatetype::expr_progress),
-              lhs_{std::move(valex)},
-              op_type_{op}
-        {}
+              operand_v_{mr},
+              op_v_{mr}
+        {
+            operand_v_.push_back(std::move(valex));
+        }
 
         bool
         progress_xs::admits_f64() const { return false; }
@@ -92,62 +152,56 @@ namespace xo {
         }
 
         rp<Expression>
-        progress_xs::assemble_expr() {
-            /* need to defer building Apply incase expr followed by higher-precedence operator:
-             * consider input like
-             *   3.14 + 2.0 * ...
-             */
-
-            constexpr const char * c_self_name = "progress_xs::assemble_expr";
-
-            if ((op_type_ != optype::invalid) && (rhs_.get() == nullptr)) {
-                throw std::runtime_error(tostr(c_self_name,
-                                               ": expected expr on rhs of operator",
-                                               xtag("lhs", lhs_),
-                                               xtag("op", op_type_)));
-            }
-
-            /* consecutive expressions not legal, e.g:
-             *   3.14 6.28
-             * but expressions surrounding an infix operators is:
-             *   3.14 / 6.28
-             */
-            switch (op_type_) {
-            case optype::invalid:
-                return this->lhs_;
+        progress_xs::make_binop(optype op,
+                                rp<Expression> lhs,
+                                rp<Expression> rhs)
+        {
+            constexpr const char * c_self_name = "progress_xs::make_binop";
 
+            switch (op) {
             case optype::op_assign:
             {
-                ref::brw<Variable> lhs = Variable::from(this->lhs_);
+                ref::brw<Variable> lhs_var = Variable::from(lhs);
 
-                if (!lhs) {
+                if (!lhs_var) {
                     throw std::runtime_error
-                        (tostr("progress_xs::assemble_expr",
-                               " expect variable on lhs of assignment operator :=",
-                               xtag("lhs", lhs_),
-                               xtag("rhs", rhs_)));
+                        (tostr(c_self_name,
+                               ": expect variable on lhs of assignment operator :=",
+                               xtag("lhs", lhs),
+                               xtag("rhs", rhs)));
                 }
 
-                return AssignExpr::make(lhs.promote(),
-                                        this->rhs_);
+                return AssignExpr::make(lhs_var.promote(), rhs);
             }
 
             case optype::op_add:
-                return Apply::make_add2_f64(this->lhs_,
-                                            this->rhs_);
+                return Apply::make_add2_f64(lhs, rhs);
 
             case optype::op_subtract:
-                return Apply::make_sub2_f64(this->lhs_,
-                                              this->rhs_);
+                return Apply::make_sub2_f64(lhs, rhs);
 
             case optype::op_multiply:
-                return Apply::make_mul2_f64(this->lhs_,
-                                              this->rhs_);
+                return Apply::make_mul2_f64(lhs, rhs);
 
             case optype::op_divide:
-                return Apply::make_div2_f64(this->lhs_,
-                                            this->rhs_);
+                return Apply::make_div2_f64(lhs, rhs);
+
+            case optype::op_bitor:
+            case optype::op_bitxor:
+            case optype::op_bitand:
+            case optype::op_equal:
+            case optype::op_not_equal:
+            case optype::op_less:
+            case optype::op_less_equal:
+            case optype::op_greater:
+            case optype::op_greater_equal:
+                /* parses,  but xo::ast doesn't provide a primitive for it yet */
+                throw std::runtime_error
+                    (tostr(c_self_name,
+                           ": operator not yet supported by expression library",
+                           xtag("op", op)));
 
+            case optype::invalid:
             case optype::n_optype:
                 /* unreachable */
                 assert(false);
@@ -157,34 +211,96 @@ namespace xo {
             return nullptr;
         }
 
+        void
+        progress_xs::reduce_top(parserstatemachine * p_psm) {
+            assert(!op_v_.empty());
+            assert(operand_v_.size() == op_v_.size() + 1);
+
+            optype op = op_v_.back();
+            op_v_.pop_back();
+
+            rp<Expression> rhs = operand_v_.back();
+            operand_v_.pop_back();
+
+            rp<Expression> lhs = operand_v_.back();
+            operand_v_.pop_back();
+
+            rp<Expression> folded;
+
+            if (p_psm->p_folder_)
+                folded = p_psm->p_folder_->fold(op, lhs, rhs);
+
+            if (folded) {
+                operand_v_.push_back(std::move(folded));
+                p_psm->note_alloc(alloccategory::expression, sizeof(Constant<double>));
+            } else {
+                operand_v_.push_back(make_binop(op, std::move(lhs), std::move(rhs)));
+
+                /* estimate: AssignExpr is one node;  Apply is node + argument vector
+                 * + primitive (lower bound,  primitive's own storage not visible here)
+                 */
+                p_psm->note_alloc(alloccategory::expression,
+                                  ((op == optype::op_assign)
+                                   ? sizeof(AssignExpr)
+                                   : (sizeof(Apply)
+                                      + 2 * sizeof(rp<Expression>)
+                                      + sizeof(Expression))));
+            }
+        }
+
+        rp<Expression>
+        progress_xs::assemble_expr(parserstatemachine * p_psm) {
+            /* need to defer building Apply incase expr followed by higher-precedence operator:
+             * consider input like
+             *   3.14 + 2.0 * ...
+             */
+
+            constexpr const char * c_self_name = "progress_xs::assemble_expr";
+
+            if (this->expecting_operand()) {
+                throw std::runtime_error(tostr(c_self_name,
+                                               ": expected expr on rhs of operator",
+                                               xtag("lhs", operand_v_.back()),
+                                               xtag("op", op_v_.back())));
+            }
+
+            while (!op_v_.empty())
+                this->reduce_top(p_psm);
+
+            return operand_v_.front();
+        }
+
         void
         progress_xs::on_expr(ref::brw<Expression> expr,
                              parserstatemachine * /*p_psm*/)
         {
             /* note: previous token probably an operator,
              *       handled from progress_xs::on_operator_token(),
-             *       which pushes expect_expr_xs::expect_rhs_expression()
+             *       which pushes expect_expr_xs in operand mode
              */
 
             constexpr const char * c_self_name = "progress_xs::on_expr";
 
-
-            if (op_type_ == optype::invalid) {
+            /* consecutive expressions not legal, e.g:
+             *   3.14 6.28
+             * but expressions surrounding an infix operators is:
+             *   3.14 / 6.28
+             */
+            if (!this->expecting_operand()) {
                 throw std::runtime_error(tostr(c_self_name,
                                                ": consecutive unseparated exprs not legal"));
             }
 
-#ifdef NOT_QUITE
-            assert(result.get());
-
-            /* this expression complete.. */
-            std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
-
-            /* ..but more operators could follow, so don't commit yet */
-            p_stack->push_exprstate(progress_xs::make(result));
-#endif
+            this->operand_v_.push_back(expr.promote());
+        }
 
-            this->rhs_ = expr.promote();
+        void
+        progress_xs::on_expr_with_semicolon(ref::brw<Expression> expr,
+                                            parserstatemachine * p_psm)
+        {
+            /* e.g. operand that consumed a trailing semicolon on our behalf */
+            this->on_expr(expr, p_psm);
+            this->on_semicolon_token(token_type::semicolon(), p_psm);
         }
 
         void
@@ -220,12 +336,11 @@ namespace xo {
         {
             /* note: implementation parllels .on_rightparen_token() */
 
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::progress);
 
-            rp<Expression> expr = this->assemble_expr();
+            rp<Expression> expr = this->assemble_expr(p_psm);
 
-            std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+            p_psm->pop_exprstate();
 
             p_psm->on_expr_with_semicolon(expr);
 
@@ -257,8 +372,7 @@ namespace xo {
         progress_xs::on_leftparen_token(const token_type & tk,
                                         parserstatemachine * /*p_psm*/)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::progress);
 
             constexpr const char * self_name = "exprstate::on_leftparen";
 
@@ -272,13 +386,10 @@ namespace xo {
              /* note: implementation parallels .on_semicolon_token() */
 
 
-             constexpr bool c_debug_flag = true;
-             scope log(XO_DEBUG(c_debug_flag));
+             XO_READER_SCOPE(log, logmodule::progress);
 
              constexpr const char * self_name = "progress_xs::on_rightparen";
 
-             auto p_stack = p_psm->p_stack_;
-
              /* stack may be something like:
               *
               *   lparen_0
@@ -291,126 +402,89 @@ namespace xo {
               */
 
              /* right paren confirms stack expression */
-             rp<Expression> expr = this->assemble_expr();
+             rp<Expression> expr = this->assemble_expr(p_psm);
 
-             std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
+             p_psm->pop_exprstate();
 
-             if (p_stack->empty()) {
+             if (p_psm->empty_exprstate()) {
                  throw std::runtime_error(tostr(self_name,
                                                 ": expected non-empty parsing stack"));
              }
 
-             log && log(xtag("stack", p_stack));
+             log && log(xtag("psm", *p_psm));
 
-             p_psm->top_exprstate().on_expr(expr, p_psm);
+             p_psm->on_expr(expr);
 
              /* now deliver rightparen */
-             p_psm->top_exprstate().on_rightparen_token(tk, p_psm);
+             p_psm->on_rightparen_token(tk);
          }
 
-        namespace {
-            optype
-            tk2op(const tokentype & tktype) {
-                switch (tktype) {
-                case tokentype::tk_plus:
-                    return optype::op_add;
-                case tokentype::tk_minus:
-                    return optype::op_subtract;
-                case tokentype::tk_star:
-                    return optype::op_multiply;
-                case tokentype::tk_slash:
-                    return optype::op_divide;
-                default:
-                    assert(false);
-                    return optype::invalid;
-                }
-                return optype::invalid;
-            }
-        }
-
         void
         progress_xs::on_operator_token(const token_type & tk,
                                        parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::progress);
 
             constexpr const char * c_self_name = "progress_xs::on_operator_token";
 
-            if (op_type_ == optype::invalid) {
-                this->op_type_ = tk2op(tk.tk_type());
+            optype op2 = tk2op(tk.tk_type());
 
-                /* infix operator must be followed by non-empty expression */
-                expect_expr_xs::start(p_psm);
-            } else if (rhs_) {
-                /* already have complete expression stashed.
-                 * behavior depends on operator precedence for tk with stored operator
-                 * this->op_type_
-                 */
-                optype op2 = tk2op(tk.tk_type());
-
-                if (precedence(op2) <= precedence(this->op_type_)) {
-                    /* e.g.
-                     *   6.2 * 4.9 + ...
-                     *
-                     * in stack:
-                     *   1. progress_xs lhs=6.2, op=*, rhs=4.9
-                     *
-                     * out stack
-                     *   1. progress_xs lhs=apply(*,6.2,4.9), op=+
-                     */
-
-                    /* 1. instantiate expression for *this */
-                    auto expr = this->assemble_expr();
-
-                    /* 2. remove from stack */
-                    std::unique_ptr<exprstate> self  = p_psm->pop_exprstate();
-
-                    /* 3. replace with new progress_xs: */
-                    progress_xs::start(expr, op2, p_psm);
-
-                    /* infix operator must be followed by non-empty expression */
-                    expect_expr_xs::start(p_psm);
-                } else {
-                    /* e.g.
-                     *   6.2 + 4.9 * ...
-                     *
-                     * in stack:
-                     *   1. progress_xs lhs=6.2, op=+, rhs=4.9
-                     *
-                     * out stack:
-                     *   1. progress_xs lhs=6.2, op=+
-                     *   2. expect_rhs_expression
-                     *   3. progress_xs lhs=4.9, op=*
-                     *   4. expect_rhs_expression
-                     */
-
-                    std::unique_ptr<exprstate> self = p_psm->pop_exprstate();
-
-                    /* 1. replace with nested incomplete infix exprs */
-                    progress_xs::start(lhs_, op_type_, p_psm);
-                    expect_expr_xs::start(p_psm);
-                    progress_xs::start(rhs_, op2, p_psm);
-                    expect_expr_xs::start(p_psm);
-                }
+            if (op2 == optype::invalid) {
+                this->illegal_input_error(c_self_name, tk);
+            }
 
-            } else {
+            if (this->expecting_operand()) {
                 throw std::runtime_error(tostr(c_self_name,
                                                ": expected expression following operator",
                                                xtag("tk", tk)));
             }
+
+            /* e.g.
+             *   6.2 * 4.9 + ...
+             *
+             * in:
+             *   operands [6.2, 4.9], ops [*]
+             * out:
+             *   operands [apply(*,6.2,4.9)], ops [+]
+             *
+             * vs.
+             *   6.2 + 4.9 * ...
+             *
+             * in:
+             *   operands [6.2, 4.9], ops [+]
+             * out:
+             *   operands [6.2, 4.9], ops [+, *]
+             *
+             * reduce while pending operator binds at least as tightly as op2;
+             * tie goes to pending operator only if op2 is left-associative.
+             */
+            int prec2 = precedence(op2);
+            bool left2 = (associativity(op2) == opassoc::left);
+
+            while (!op_v_.empty()) {
+                int prec1 = precedence(op_v_.back());
+
+                if ((prec1 > prec2) || ((prec1 == prec2) && left2))
+                    this->reduce_top(p_psm);
+                else
+                    break;
+            }
+
+            this->op_v_.push_back(op2);
+
+            /* infix operator must be followed by non-empty expression */
+            expect_expr_xs::start_operand(p_psm);
         }
 
         void
         progress_xs::on_f64_token(const token_type & tk,
                                   parserstatemachine * p_psm)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::progress);
 
             constexpr const char * self_name = "progress_xs::on_f64";
 
-            if (this->op_type_ == optype::invalid) {
+            if (!this->expecting_operand()) {
                 this->illegal_input_error(self_name, tk);
             } else {
                 exprstate::on_f64_token(tk, p_psm);
@@ -422,16 +496,13 @@ namespace xo {
             os << "<progress_xs"
                << xtag("this", (void*)this)
                << xtag("type", exs_type_);
-            if (lhs_)
-                os << xtag("lhs", lhs_);
-            if (op_type_ != optype::invalid)
-                os << xtag("op", op_type_);
-            if (rhs_)
-                os << xtag("rhs", rhs_);
+            if (!operand_v_.empty())
+                os << xtag("lhs", operand_v_.front());
+            if (!op_v_.empty())
+                os << xtag("op", op_v_.back());
+            os << xtag("n_operand", operand_v_.size());
             os << ">";
         }
-
-
     } /*namespace scm*/
 } /*namespace xo*/
 
@@ -1,14 +1,33 @@
 /* @file reader.cpp */
 
 #include "reader.hpp"
+#include "astcache.hpp"
+#include "tokenrecord.hpp"
+#include "readerperf.hpp"
+#include "segmenter.hpp"
 
 namespace xo {
     namespace scm {
         void
         reader::begin_translation_unit() {
+            if (alloc_)
+                alloc_->begin_translation_unit();
+
+            /* discard any partial token left by previous translation unit
+             * (e.g. if it ended in an error)
+             */
+            tokenizer_ = tokenizer_type();
+
             parser_.begin_translation_unit();
         }
 
+        void
+        reader::attach_allocaccount(allocaccount * account) {
+            parser_.attach_allocaccount(account);
+
+            alloc_ = account;
+        }
+
         reader_result
         reader::end_translation_unit() {
             return this->read_expr(span_type(nullptr, nullptr), true /*eof*/);
@@ -17,8 +36,10 @@ namespace xo {
         reader_result
         reader::read_expr(const span_type & input_arg, bool eof)
         {
-            constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag));
+            XO_READER_SCOPE(log, logmodule::reader);
+
+            /* back to idle phase on any exit */
+            readerperf::scope perf_scope(perf_);
 
             span_type input = input_arg;
 
@@ -30,6 +51,45 @@ namespace xo {
             span_type expr_span = input.prefix(0ul);
 
             while (!input.empty()) {
+                if (parser_.lazy_body_pending()) {
+                    if (perf_)
+                        perf_->enter(readerphase::tokenize);
+
+                    /* parser wants lambda body as text:  skip it by brace matching */
+                    span_type block = segmenter::leading_block(input);
+
+                    if (block.empty() && (block.lo() == input.hi()) && !eof) {
+                        /* only whitespace so far;  body may start in next input */
+                        expr_span += input;
+                        input = input.after_prefix(input);
+
+                        break;
+                    }
+
+                    /* empty block -> not a block,  or not closed in this input:
+                     * decline,  and let parser see body tokens
+                     */
+                    span_type used = (block.empty()
+                                      ? input.prefix(0ul)
+                                      : span_type(input.lo(), block.hi()));
+
+                    input = input.after_prefix(used);
+                    expr_span += used;
+
+                    if (recorder_)
+                        recorder_->record_lazy_body(block);
+
+                    if (perf_)
+                        perf_->enter(readerphase::parse);
+
+                    this->parser_.include_lazy_body(block);
+
+                    continue;
+                }
+
+                if (perf_)
+                    perf_->enter(readerphase::tokenize);
+
                 /* read one token from input */
                 auto sr = this->tokenizer_.scan2(input, eof);
                 const auto & tk = sr.first;
@@ -45,6 +105,17 @@ namespace xo {
                 expr_span += used_span;
 
                 if (tk.is_valid()) {
+                    if (recorder_)
+                        recorder_->record_token(tk);
+
+                    if (alloc_)
+                        alloc_->note_string(alloccategory::token_text, tk.text());
+
+                    if (perf_) {
+                        perf_->count_token();
+                        perf_->enter(readerphase::parse);
+                    }
+
                     /* forward just-read token to parser */
                     auto expr = this->parser_.include_token(tk);
 
@@ -53,7 +124,7 @@ namespace xo {
                                    xtag("expr", expr));
 
                         /* token completes an expression -> victory */
-                        return reader_result(expr, expr_span);
+                        return reader_result(expr, expr_span, parser_.take_varrefs());
                     } else {
                         /* token did not complete an expression
                          * (e.g. token for '[')
@@ -92,6 +163,52 @@ namespace xo {
             return reader_result(nullptr, expr_span);
         }
 
+        std::size_t
+        reader::read_all(const span_type & input, bool eof,
+                         std::vector<reader_result> * p_result_v)
+        {
+            return this->read_all(input, eof,
+                                  [p_result_v](reader_result && rr)
+                                      {
+                                          p_result_v->push_back(std::move(rr));
+                                      });
+        }
+
+        read_file_result
+        reader::read_file(const std::string & path)
+        {
+            read_file_result retval;
+
+            retval.file_ = mapped_file::open(path);
+
+            this->begin_translation_unit();
+
+            std::uint32_t flags = this->astcache_flags();
+
+            if (astcache_ && astcache_->lookup(retval.file_.contents(), flags, &retval.result_v_))
+                return retval;
+
+            this->read_all(retval.file_.contents(), true /*eof*/, &retval.result_v_);
+
+            if (astcache_)
+                astcache_->store(retval.file_.contents(), flags, retval.result_v_);
+
+            return retval;
+        }
+
+        std::uint32_t
+        reader::astcache_flags() const
+        {
+            std::uint32_t retval = 0;
+
+            if (parser_.constant_folding_enabled())
+                retval |= 0x1;
+            if (parser_.lazy_lambda_enabled())
+                retval |= 0x2;
+
+            return retval;
+        }
+
     } /*namespace scm*/
 } /*namespace xo*/
 
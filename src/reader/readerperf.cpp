@@ -0,0 +1,216 @@
+/* file readerperf.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "readerperf.hpp"
+#include "xo/indentlog/print/tag.hpp"
+
+#ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace xo {
+    namespace scm {
+        const char *
+        perfevent_descr(perfevent x) {
+            switch (x) {
+            case perfevent::cycles: return "cycles";
+            case perfevent::instructions: return "instructions";
+            case perfevent::branch_misses: return "branch_misses";
+            case perfevent::l1d_misses: return "l1d_misses";
+            case perfevent::llc_misses: return "llc_misses";
+            case perfevent::n_perfevent: break;
+            }
+
+            return "???perfevent";
+        }
+
+        void
+        perfsample::print(std::ostream & os) const {
+            os << "<perfsample";
+            for (std::size_t i = 0; i < c_n_event; ++i)
+                os << xtag(perfevent_descr(static_cast<perfevent>(i)), v_[i]);
+            os << xtag("ipc", this->ipc()) << ">";
+        }
+
+        // ----- perfcounters -----
+
+#ifdef __linux__
+        namespace {
+            /* perf (type, config) for @p x */
+            void
+            event_config(perfevent x, std::uint32_t * p_type, std::uint64_t * p_config)
+            {
+                auto cache_read_miss = [](std::uint64_t cache) {
+                    return (cache
+                            | (std::uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8)
+                            | (std::uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16));
+                };
+
+                *p_type = PERF_TYPE_HARDWARE;
+
+                switch (x) {
+                case perfevent::cycles:
+                    *p_config = PERF_COUNT_HW_CPU_CYCLES;
+                    break;
+                case perfevent::instructions:
+                    *p_config = PERF_COUNT_HW_INSTRUCTIONS;
+                    break;
+                case perfevent::branch_misses:
+                    *p_config = PERF_COUNT_HW_BRANCH_MISSES;
+                    break;
+                case perfevent::l1d_misses:
+                    *p_type = PERF_TYPE_HW_CACHE;
+                    *p_config = cache_read_miss(PERF_COUNT_HW_CACHE_L1D);
+                    break;
+                case perfevent::llc_misses:
+                    *p_type = PERF_TYPE_HW_CACHE;
+                    *p_config = cache_read_miss(PERF_COUNT_HW_CACHE_LL);
+                    break;
+                case perfevent::n_perfevent:
+                    break;
+                }
+            }
+
+            /* open counter for event @p x in group @p group_fd (-1: new group).
+             * -1 on failure
+             */
+            int
+            open_event(perfevent x, int group_fd)
+            {
+                perf_event_attr attr{};
+
+                std::uint32_t type = 0;
+                std::uint64_t config = 0;
+                event_config(x, &type, &config);
+
+                attr.size = sizeof(attr);
+                attr.type = type;
+                attr.config = config;
+                attr.read_format = PERF_FORMAT_GROUP;
+                /* leader starts disabled;  whole group enabled at once */
+                attr.disabled = (group_fd == -1);
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+
+                return static_cast<int>(::syscall(SYS_perf_event_open, &attr,
+                                                  0 /*this thread*/, -1 /*any cpu*/,
+                                                  group_fd, 0 /*flags*/));
+            }
+        }
+
+        perfcounters::perfcounters()
+        {
+            fd_v_.fill(-1);
+
+            int leader = open_event(perfevent::cycles, -1);
+
+            if (leader < 0)
+                return;
+
+            fd_v_[0] = leader;
+            n_open_ = 1;
+
+            /* absent events (e.g. no LLC event in a VM) just read as 0 */
+            for (std::size_t i = 1; i < perfsample::c_n_event; ++i) {
+                int fd = open_event(static_cast<perfevent>(i), leader);
+
+                if (fd >= 0) {
+                    fd_v_[i] = fd;
+                    ++n_open_;
+                }
+            }
+
+            ::ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+
+        perfcounters::~perfcounters()
+        {
+            /* members before leader */
+            for (std::size_t i = perfsample::c_n_event; i > 0; --i) {
+                if (fd_v_[i - 1] >= 0)
+                    ::close(fd_v_[i - 1]);
+            }
+        }
+
+        perfsample
+        perfcounters::read() const
+        {
+            perfsample retval;
+
+            if (!this->available())
+                return retval;
+
+            /* PERF_FORMAT_GROUP: { u64 nr; u64 value[nr]; },  values in open order */
+            std::array<std::uint64_t, 1 + perfsample::c_n_event> buf;
+
+            ssize_t z = ::read(fd_v_[0], buf.data(), sizeof(buf));
+
+            if ((z < ssize_t(sizeof(std::uint64_t))) || (buf[0] != n_open_))
+                return retval;
+
+            std::size_t j = 1;
+            for (std::size_t i = 0; i < perfsample::c_n_event; ++i) {
+                if (fd_v_[i] >= 0)
+                    retval.v_[i] = buf[j++];
+            }
+
+            return retval;
+        }
+#else
+        perfcounters::perfcounters()
+        {
+            fd_v_.fill(-1);
+        }
+
+        perfcounters::~perfcounters() = default;
+
+        perfsample
+        perfcounters::read() const
+        {
+            return perfsample();
+        }
+#endif
+
+        // ----- readerperf -----
+
+        void
+        readerperf::enter(readerphase x)
+        {
+            if (x == current_)
+                return;
+
+            perfsample now = counters_.read();
+
+            phase_v_[static_cast<std::size_t>(current_)] += (now - last_);
+
+            last_ = now;
+            current_ = x;
+        }
+
+        void
+        readerperf::clear()
+        {
+            last_ = counters_.read();
+            phase_v_.fill(perfsample());
+            n_token_ = 0;
+        }
+
+        void
+        readerperf::print(std::ostream & os) const {
+            os << "<readerperf"
+               << xtag("available", this->available())
+               << xtag("n_token", n_token_)
+               << xtag("tokenize", this->phase(readerphase::tokenize))
+               << xtag("parse", this->phase(readerphase::parse))
+               << ">";
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end readerperf.cpp */
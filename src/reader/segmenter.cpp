@@ -0,0 +1,143 @@
+/* file segmenter.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "segmenter.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace xo {
+    namespace scm {
+        namespace {
+            /* invoke @p fn(offset) for each toplevel boundary in @p input,
+             * in increasing order,  until fn returns false
+             */
+            template <typename Fn>
+            void
+            for_each_boundary(const segmenter::span_type & input, simdlevel level, Fn && fn)
+            {
+                /* bytes indexed per scanner call;  bounds index memory */
+                constexpr std::size_t c_piece_size = 256 * structscanner::c_block_size;
+
+                const char * lo = input.lo();
+                std::size_t z = input.size();
+
+                structscanner scanner(level);
+                structindex index;
+
+                for (std::size_t piece_lo = 0; piece_lo < z; piece_lo += c_piece_size) {
+                    std::size_t piece_hi = std::min(piece_lo + c_piece_size, z);
+
+                    index.clear();
+                    scanner.scan(segmenter::span_type(lo + piece_lo, lo + piece_hi), &index);
+
+                    for (std::size_t k = 0, n = index.size(); k < n; ++k) {
+                        std::size_t i = index.pos_v_[k];
+
+                        if ((lo[i] == ';') && (index.depth_v_[k] == 0)) {
+                            if (!fn(i + 1))
+                                return;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<std::size_t>
+        segmenter::split(const span_type & input, std::size_t n_segment, simdlevel level)
+        {
+            std::vector<std::size_t> retval;
+
+            std::size_t z = input.size();
+
+            if ((n_segment < 2) || (z == 0))
+                return retval;
+
+            retval.reserve(n_segment - 1);
+
+            /* next target offset: cut at first toplevel boundary at or after this */
+            std::size_t stride = std::max(z / n_segment, std::size_t(1));
+            std::size_t target = stride;
+
+            for_each_boundary(input, level,
+                              [&](std::size_t cut)
+                                  {
+                                      if ((cut >= target) && (cut < z)) {
+                                          retval.push_back(cut);
+
+                                          if (retval.size() + 1 == n_segment)
+                                              return false;
+
+                                          /* targets already passed are satisfied by this cut */
+                                          while (target <= cut)
+                                              target += stride;
+                                      }
+
+                                      return true;
+                                  });
+
+            return retval;
+        }
+
+        std::vector<std::size_t>
+        segmenter::boundaries(const span_type & input, simdlevel level)
+        {
+            std::vector<std::size_t> retval;
+
+            for_each_boundary(input, level,
+                              [&retval](std::size_t cut)
+                                  {
+                                      retval.push_back(cut);
+                                      return true;
+                                  });
+
+            return retval;
+        }
+
+        auto
+        segmenter::leading_block(const span_type & input) -> span_type
+        {
+            const char * p = input.lo();
+            const char * e = input.hi();
+
+            while ((p != e) && std::isspace(static_cast<unsigned char>(*p)))
+                ++p;
+
+            if ((p == e) || (*p != '{'))
+                return span_type(p, p);
+
+            const char * lo = p;
+            long depth = 0;
+            bool in_string = false;
+
+            for (; p != e; ++p) {
+                char c = *p;
+
+                if (in_string) {
+                    if (c == '\\') {
+                        if (++p == e)
+                            break;
+                    } else if (c == '"') {
+                        in_string = false;
+                    }
+
+                    continue;
+                }
+
+                if (c == '"') {
+                    in_string = true;
+                } else if (c == '{') {
+                    ++depth;
+                } else if ((c == '}') && (--depth == 0)) {
+                    return span_type(lo, p + 1);
+                }
+            }
+
+            /* unterminated */
+            return span_type(lo, lo);
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end segmenter.cpp */
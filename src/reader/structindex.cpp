@@ -0,0 +1,335 @@
+/* file structindex.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "structindex.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <stdexcept>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define XO_READER_X86_SIMD 1
+#  include <immintrin.h>
+#else
+#  define XO_READER_X86_SIMD 0
+#endif
+
+namespace xo {
+    namespace scm {
+        const char *
+        simdlevel_descr(simdlevel x) {
+            switch (x) {
+            case simdlevel::scalar:
+                return "scalar";
+            case simdlevel::sse2:
+                return "sse2";
+            case simdlevel::avx2:
+                return "avx2";
+            case simdlevel::n_simdlevel:
+                break;
+            }
+
+            return "???simdlevel";
+        }
+
+        namespace {
+            /* one bit per byte of a 64-byte block */
+            struct blockmasks {
+                std::uint64_t quote_ = 0;
+                std::uint64_t backslash_ = 0;
+                /* ( ) { } [ ] ; */
+                std::uint64_t op_ = 0;
+            };
+
+            blockmasks
+            classify_scalar(const char * p) {
+                blockmasks m;
+
+                for (std::size_t i = 0; i < structscanner::c_block_size; ++i) {
+                    std::uint64_t bit = std::uint64_t(1) << i;
+
+                    switch (p[i]) {
+                    case '"':
+                        m.quote_ |= bit;
+                        break;
+                    case '\\':
+                        m.backslash_ |= bit;
+                        break;
+                    case '(':
+                    case ')':
+                    case '{':
+                    case '}':
+                    case '[':
+                    case ']':
+                    case ';':
+                        m.op_ |= bit;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+
+                return m;
+            }
+
+#if XO_READER_X86_SIMD
+            blockmasks
+            classify_sse2(const char * p) {
+                blockmasks m;
+
+                for (std::size_t k = 0; k < 4; ++k) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16*k));
+
+                    auto eq = [v](char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); };
+
+                    __m128i op = _mm_or_si128(_mm_or_si128(_mm_or_si128(eq('('), eq(')')),
+                                                           _mm_or_si128(eq('{'), eq('}'))),
+                                              _mm_or_si128(_mm_or_si128(eq('['), eq(']')),
+                                                           eq(';')));
+
+                    unsigned shift = 16*k;
+
+                    m.quote_     |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(eq('"')))) << shift;
+                    m.backslash_ |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(eq('\\')))) << shift;
+                    m.op_        |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(op))) << shift;
+                }
+
+                return m;
+            }
+
+            __attribute__((target("avx2")))
+            inline __m256i
+            eq_avx2(__m256i v, char c) {
+                return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+            }
+
+            __attribute__((target("avx2")))
+            blockmasks
+            classify_avx2(const char * p) {
+                blockmasks m;
+
+                for (std::size_t k = 0; k < 2; ++k) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32*k));
+
+                    __m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(eq_avx2(v, '('),
+                                                                                 eq_avx2(v, ')')),
+                                                                 _mm256_or_si256(eq_avx2(v, '{'),
+                                                                                 eq_avx2(v, '}'))),
+                                                 _mm256_or_si256(_mm256_or_si256(eq_avx2(v, '['),
+                                                                                 eq_avx2(v, ']')),
+                                                                 eq_avx2(v, ';')));
+
+                    unsigned shift = 32*k;
+
+                    m.quote_     |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(eq_avx2(v, '"')))) << shift;
+                    m.backslash_ |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(eq_avx2(v, '\\')))) << shift;
+                    m.op_        |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(op))) << shift;
+                }
+
+                return m;
+            }
+#endif
+
+            /* Bits for characters that follow an odd-length run of backslashes.
+             * Even/odd runs are told apart by where the carry from adding
+             * each run's start bit propagates to (after simdjson).
+             * @p *p_prev_odd:  1 if previous block ended in an odd-length run;
+             * updated for next block.
+             */
+            std::uint64_t
+            find_escaped(std::uint64_t bs, std::uint64_t * p_prev_odd) {
+                constexpr std::uint64_t c_even_bits = 0x5555555555555555ULL;
+                constexpr std::uint64_t c_odd_bits = ~c_even_bits;
+
+                std::uint64_t start_edges = bs & ~(bs << 1);
+                /* run starting at bit 0 continues a run from previous block */
+                std::uint64_t even_start_mask = c_even_bits ^ *p_prev_odd;
+                std::uint64_t even_starts = start_edges & even_start_mask;
+                std::uint64_t odd_starts = start_edges & ~even_start_mask;
+
+                std::uint64_t even_carries = bs + even_starts;
+                std::uint64_t odd_carries = 0;
+                bool ends_odd = __builtin_add_overflow(bs, odd_starts, &odd_carries);
+
+                odd_carries |= *p_prev_odd;
+                *p_prev_odd = ends_odd ? 1 : 0;
+
+                std::uint64_t even_carry_ends = even_carries & ~bs;
+                std::uint64_t odd_carry_ends = odd_carries & ~bs;
+
+                return ((even_carry_ends & c_odd_bits)
+                        | (odd_carry_ends & c_even_bits));
+            }
+
+            /* bit i set iff odd number of bits set in x[0..i] */
+            std::uint64_t
+            prefix_xor(std::uint64_t x) {
+                x ^= x << 1;
+                x ^= x << 2;
+                x ^= x << 4;
+                x ^= x << 8;
+                x ^= x << 16;
+                x ^= x << 32;
+
+                return x;
+            }
+        }
+
+        simdlevel
+        structscanner::best_simdlevel()
+        {
+#if XO_READER_X86_SIMD
+            if (__builtin_cpu_supports("avx2"))
+                return simdlevel::avx2;
+
+            return simdlevel::sse2;
+#else
+            return simdlevel::scalar;
+#endif
+        }
+
+        structindex
+        structscanner::index(const span_type & input, simdlevel level)
+        {
+            structindex retval;
+            structscanner scanner(level);
+
+            scanner.scan(input, &retval);
+
+            return retval;
+        }
+
+        structscanner::structscanner(simdlevel level)
+            : level_{level}
+        {
+#if !XO_READER_X86_SIMD
+            level_ = simdlevel::scalar;
+#endif
+            if ((level_ == simdlevel::avx2) && (best_simdlevel() != simdlevel::avx2))
+                level_ = simdlevel::sse2;
+        }
+
+        void
+        structscanner::reset()
+        {
+            prev_escaped_ = 0;
+            prev_in_string_ = 0;
+            depth_ = 0;
+            offset_ = 0;
+        }
+
+        void
+        structscanner::scan(const span_type & input, structindex * p_index)
+        {
+            constexpr const char * c_self_name = "structscanner::scan";
+
+            std::size_t z = input.size();
+
+            if (offset_ + z > UINT32_MAX) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": input too large for 32-bit offsets",
+                           xtag("offset", offset_),
+                           xtag("size", z)));
+            }
+
+            if (offset_ % c_block_size != 0) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": previous piece was not a whole number of blocks",
+                           xtag("offset", offset_)));
+            }
+
+            const char * p = input.lo();
+            const char * e = p + (z - z % c_block_size);
+
+            for (; p != e; p += c_block_size)
+                this->scan_block(p, p_index);
+
+            if (p != input.hi()) {
+                /* partial last block:  pad with non-structural bytes */
+                char buf[c_block_size];
+
+                std::memset(buf, ' ', c_block_size);
+                std::memcpy(buf, p, input.hi() - p);
+
+                std::uint64_t hi = offset_ + (input.hi() - p);
+
+                this->scan_block(buf, p_index);
+
+                /* report true end-of-input */
+                offset_ = hi;
+            }
+        }
+
+        void
+        structscanner::scan_block(const char * p, structindex * p_index)
+        {
+            blockmasks m;
+
+            switch (level_) {
+#if XO_READER_X86_SIMD
+            case simdlevel::avx2:
+                m = classify_avx2(p);
+                break;
+            case simdlevel::sse2:
+                m = classify_sse2(p);
+                break;
+#endif
+            default:
+                m = classify_scalar(p);
+                break;
+            }
+
+            std::uint64_t escaped = find_escaped(m.backslash_, &prev_escaped_);
+            std::uint64_t quote = m.quote_ & ~escaped;
+            /* opening quote and string interior;  not closing quote */
+            std::uint64_t in_string = prefix_xor(quote) ^ prev_in_string_;
+
+            prev_in_string_ = std::uint64_t(std::int64_t(in_string) >> 63);
+
+            std::uint64_t structural = (m.op_ & ~escaped & ~in_string) | quote;
+
+            if (structural) {
+                std::size_t n = p_index->pos_v_.size();
+                std::size_t n_new = __builtin_popcountll(structural);
+
+                p_index->pos_v_.resize(n + n_new);
+                p_index->depth_v_.resize(n + n_new);
+
+                std::uint32_t * pos = p_index->pos_v_.data() + n;
+                std::int32_t * depth = p_index->depth_v_.data() + n;
+                std::int32_t d = depth_;
+
+                while (structural) {
+                    unsigned i = __builtin_ctzll(structural);
+
+                    switch (p[i]) {
+                    case '(':
+                    case '{':
+                    case '[':
+                        ++d;
+                        break;
+                    case ')':
+                    case '}':
+                    case ']':
+                        --d;
+                        break;
+                    default:
+                        break;
+                    }
+
+                    *pos++ = offset_ + i;
+                    *depth++ = d;
+
+                    structural &= structural - 1;
+                }
+
+                depth_ = d;
+            }
+
+            offset_ += c_block_size;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end structindex.cpp */
@@ -0,0 +1,91 @@
+/* file symboltable.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "symboltable.hpp"
+#include "concurrentsymboltable.hpp"
+#include "xo/indentlog/print/tag.hpp"
+
+namespace xo {
+    namespace scm {
+        std::size_t
+        symboltable::size() const {
+            if (shared_)
+                return shared_->size();
+
+            return name_v_.size();
+        }
+
+        void
+        symboltable::attach_shared(concurrentsymboltable * shared) {
+            shared_ = shared;
+            name_v_.clear();
+            id_map_.clear();
+        }
+
+        symbolid
+        symboltable::intern(std::string_view name) {
+            auto ix = id_map_.find(name);
+
+            if (ix != id_map_.end())
+                return ix->second;
+
+            if (shared_) {
+                symbolid id = shared_->intern(name);
+
+                id_map_.emplace(std::string_view(shared_->name(id)), id);
+
+                return id;
+            }
+
+            symbolid id = name_v_.size();
+
+            name_v_.emplace_back(name);
+            id_map_.emplace(std::string_view(name_v_.back()), id);
+
+            return id;
+        }
+
+        symbolid
+        symboltable::find(std::string_view name) const {
+            auto ix = id_map_.find(name);
+
+            if (ix != id_map_.end())
+                return ix->second;
+
+            if (shared_) {
+                symbolid id = shared_->find(name);
+
+                /* cache hits only:  id is stable once interned.
+                 * A miss is not cached,  since another thread may
+                 * intern the name later
+                 */
+                if (id != c_invalid_symbolid)
+                    id_map_.emplace(std::string_view(shared_->name(id)), id);
+
+                return id;
+            }
+
+            return c_invalid_symbolid;
+        }
+
+        const std::string &
+        symboltable::name(symbolid id) const {
+            if (shared_)
+                return shared_->name(id);
+
+            return name_v_[id];
+        }
+
+        void
+        symboltable::print(std::ostream & os) const {
+            os << "<symboltable"
+               << xtag("size", this->size())
+               << xtag("shared", (shared_ != nullptr))
+               << ">";
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end symboltable.cpp */
@@ -0,0 +1,187 @@
+/* file tokenrecord.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "tokenrecord.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+namespace xo {
+    namespace scm {
+        namespace {
+            constexpr char c_magic[8] = {'x', 'o', 't', 'k', 'r', 'e', 'c', '1'};
+        }
+
+        // ----- tokenrecorder -----
+
+        tokenrecorder::tokenrecorder()
+        {
+            image_.assign(c_magic, sizeof(c_magic));
+        }
+
+        void
+        tokenrecorder::record_token(const token_type & tk)
+        {
+            const std::string & text = tk.text();
+
+            this->append_record(static_cast<std::uint8_t>(tk.tk_type()),
+                                text.data(), text.size());
+        }
+
+        void
+        tokenrecorder::record_lazy_body(const span_type & body)
+        {
+            this->append_record(c_lazy_body, body.lo(), body.size());
+        }
+
+        void
+        tokenrecorder::append_record(std::uint8_t kind, const char * text, std::size_t len)
+        {
+            image_.push_back(static_cast<char>(kind));
+
+            /* unsigned LEB128 */
+            std::size_t z = len;
+            do {
+                std::uint8_t b = z & 0x7f;
+                z >>= 7;
+                if (z)
+                    b |= 0x80;
+                image_.push_back(static_cast<char>(b));
+            } while (z);
+
+            image_.append(text, len);
+
+            ++n_record_;
+        }
+
+        void
+        tokenrecorder::write(const std::string & path) const
+        {
+            constexpr const char * c_self_name = "tokenrecorder::write";
+
+            std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+
+            ofs.write(image_.data(), image_.size());
+
+            if (!ofs) {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": write failed",
+                           xtag("path", path)));
+            }
+        }
+
+        void
+        tokenrecorder::clear()
+        {
+            image_.resize(sizeof(c_magic));
+            n_record_ = 0;
+        }
+
+        // ----- tokenreplay -----
+
+        tokenreplay
+        tokenreplay::open(const std::string & path)
+        {
+            tokenreplay retval;
+
+            retval.file_ = mapped_file::open(path);
+            retval.decode(path);
+
+            return retval;
+        }
+
+        tokenreplay
+        tokenreplay::from_image(std::string image)
+        {
+            tokenreplay retval;
+
+            retval.image_ = std::move(image);
+            retval.decode("image");
+
+            return retval;
+        }
+
+        auto
+        tokenreplay::bytes() const -> span_type
+        {
+            if (file_.size() > 0)
+                return file_.contents();
+
+            return span_type(image_.data(), image_.data() + image_.size());
+        }
+
+        void
+        tokenreplay::decode(const std::string & what)
+        {
+            constexpr const char * c_self_name = "tokenreplay::decode";
+
+            span_type text = this->bytes();
+            const char * lo = text.lo();
+            std::size_t z = text.size();
+
+            if ((z < sizeof(c_magic))
+                || (std::memcmp(lo, c_magic, sizeof(c_magic)) != 0))
+            {
+                throw std::runtime_error
+                    (tostr(c_self_name, ": not a token recording",
+                           xtag("source", what)));
+            }
+
+            auto truncated = [c_self_name, &what](std::size_t pos) {
+                return std::runtime_error
+                    (tostr(c_self_name, ": truncated token recording",
+                           xtag("source", what),
+                           xtag("offset", pos)));
+            };
+
+            record_v_.clear();
+
+            for (std::size_t pos = sizeof(c_magic); pos < z; ) {
+                std::uint8_t kind = lo[pos++];
+
+                std::size_t len = 0;
+                for (unsigned shift = 0; ; shift += 7) {
+                    if ((pos == z) || (shift > 63))
+                        throw truncated(pos);
+
+                    std::uint8_t b = lo[pos++];
+                    len |= std::size_t(b & 0x7f) << shift;
+
+                    if (!(b & 0x80))
+                        break;
+                }
+
+                if (len > z - pos)
+                    throw truncated(pos);
+
+                record rec;
+
+                if (kind == tokenrecorder::c_lazy_body) {
+                    rec.lazy_body_ = true;
+                    rec.lo_ = pos;
+                    rec.hi_ = pos + len;
+                } else {
+                    if (kind >= static_cast<std::uint8_t>(tokentype::n_tokentype)) {
+                        throw std::runtime_error
+                            (tostr(c_self_name, ": unknown token type",
+                                   xtag("source", what),
+                                   xtag("offset", pos),
+                                   xtag("kind", int(kind))));
+                    }
+
+                    rec.tk_ = token_type(static_cast<tokentype>(kind),
+                                         std::string(lo + pos, len));
+                }
+
+                record_v_.push_back(std::move(rec));
+
+                pos += len;
+            }
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end tokenrecord.cpp */
@@ -0,0 +1,107 @@
+/* file variantstatestack.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "variantstatestack.hpp"
+
+namespace xo {
+    namespace scm {
+        namespace {
+            /** exprstate base of variant alternative **/
+            exprstate &
+            as_exprstate(exprstatevariant & x) {
+                return std::visit([](exprstate & xs) -> exprstate & { return xs; }, x);
+            }
+
+            const exprstate &
+            as_exprstate(const exprstatevariant & x) {
+                return std::visit([](const exprstate & xs) -> const exprstate & { return xs; }, x);
+            }
+        }
+
+        variantstatestack::~variantstatestack() {
+            /* destroy in reverse order of construction */
+            while (size_ > 0)
+                this->pop_exprstate();
+
+            for (slot_type * seg : segment_v_) {
+                std::destroy_n(seg, c_segment_size);
+                counter_.deallocate(seg, c_segment_size * sizeof(slot_type), alignof(slot_type));
+            }
+        }
+
+        void
+        variantstatestack::add_segment() {
+            void * mem = counter_.allocate(c_segment_size * sizeof(slot_type), alignof(slot_type));
+            slot_type * seg = static_cast<slot_type *>(mem);
+
+            std::uninitialized_value_construct_n(seg, c_segment_size);
+
+            try {
+                segment_v_.push_back(seg);
+            } catch (...) {
+                std::destroy_n(seg, c_segment_size);
+                counter_.deallocate(mem, c_segment_size * sizeof(slot_type), alignof(slot_type));
+                throw;
+            }
+        }
+
+        exprstatevariant &
+        variantstatestack::top_slot() {
+            if (size_ == 0) {
+                throw std::runtime_error
+                    ("variantstatestack::top_exprstate: unexpected empty stack");
+            }
+
+            return *(this->slot(size_ - 1));
+        }
+
+        exprstate &
+        variantstatestack::top_exprstate() {
+            return as_exprstate(this->top_slot());
+        }
+
+        void
+        variantstatestack::pop_exprstate() {
+            XO_READER_SCOPE(log, logmodule::stack,
+                            xtag("top.exstype", top_exprstate().exs_type()));
+
+            if (size_ > 0) {
+                --size_;
+                this->slot(size_).reset();
+            }
+        }
+
+        exprstate &
+        variantstatestack::operator[](std::size_t i) {
+            assert(i < size_);
+
+            return as_exprstate(*(this->slot(size_ - i - 1)));
+        }
+
+        const exprstate &
+        variantstatestack::operator[](std::size_t i) const {
+            assert(i < size_);
+
+            return as_exprstate(*(this->slot(size_ - i - 1)));
+        }
+
+        void
+        variantstatestack::print(std::ostream & os) const {
+            os << "<variantstatestack"
+               << xtag("size", size_)
+               << std::endl;
+
+            for (std::size_t i = 0; i < size_; ++i) {
+                os << "  [" << size_-i-1 << "] "
+                   << &as_exprstate(*(this->slot(i)))
+                   << std::endl;
+            }
+
+            os << ">" << std::endl;
+        }
+    } /*namespace scm*/
+} /*namespace xo*/
+
+/* end variantstatestack.cpp */
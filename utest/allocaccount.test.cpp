@@ -0,0 +1,205 @@
+/* file allocaccount.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/allocaccount.hpp"
+#include "xo/reader/reader.hpp"
+#include "xo/reader/parser.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <catch2/catch.hpp>
+
+namespace xo {
+    using xo::scm::allocaccount;
+    using xo::scm::alloccategory;
+    using xo::scm::parserengine;
+    using xo::scm::parser;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+
+    namespace ut {
+        TEST_CASE("allocaccount-resource", "[allocaccount]") {
+            allocaccount acct;
+
+            std::pmr::memory_resource * mr = acct.resource(alloccategory::exprstate);
+
+            void * p = mr->allocate(100, 16);
+            REQUIRE(p);
+            mr->deallocate(p, 100, 16);
+
+            CHECK(acct.current().n_alloc(alloccategory::exprstate) == 1);
+            CHECK(acct.current().n_byte(alloccategory::exprstate) == 100);
+            CHECK(acct.current().n_alloc(alloccategory::expression) == 0);
+
+            /* short strings need no heap */
+            acct.note_string(alloccategory::token_text, std::string("x"));
+            CHECK(acct.current().n_alloc(alloccategory::token_text) == 0);
+
+            acct.note_string(alloccategory::token_text, std::string(100, 'x'));
+            CHECK(acct.current().n_alloc(alloccategory::token_text) == 1);
+            CHECK(acct.current().n_byte(alloccategory::token_text) > 100);
+
+            acct.clear();
+            CHECK(acct.tu_v().size() == 1);
+            CHECK(acct.current().empty());
+        }
+
+        TEST_CASE("allocaccount-reader", "[allocaccount]") {
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            std::string text_a
+                = ("def pythagorean_distance = lambda (x : f64, y : f64) x * x + y * y;\n"
+                   "def k = 2.0 * 3.0;\n");
+            std::string text_b
+                = "def g = lambda (x : f64) x + 1.0;\n";
+
+            auto span = [](const std::string & s) {
+                return reader::span_type(s.data(), s.data() + s.size());
+            };
+
+            std::vector<reader_result> plain_v;
+            {
+                reader rdr(engine);
+                rdr.begin_translation_unit();
+                rdr.read_all(span(text_a), true /*eof*/, &plain_v);
+                rdr.begin_translation_unit();
+                rdr.read_all(span(text_b), true /*eof*/, &plain_v);
+            }
+
+            allocaccount acct;
+
+            std::vector<reader_result> acct_v;
+            {
+                reader rdr(engine);
+                rdr.attach_allocaccount(&acct);
+                rdr.begin_translation_unit();
+                rdr.read_all(span(text_a), true /*eof*/, &acct_v);
+                rdr.begin_translation_unit();
+                rdr.read_all(span(text_b), true /*eof*/, &acct_v);
+            }
+
+            INFO(tostr(xtag("acct", acct)));
+
+            /* accounting does not change results */
+            REQUIRE(acct_v.size() == plain_v.size());
+            for (std::size_t i = 0; i < acct_v.size(); ++i)
+                CHECK(tostr(acct_v[i].expr_) == tostr(plain_v[i].expr_));
+
+            REQUIRE(acct.tu_v().size() == 2);
+
+            const auto & tu_a = acct.tu_v()[0];
+            const auto & tu_b = acct.tu_v()[1];
+
+            for (auto c : {alloccategory::expression,
+                           alloccategory::envframe,
+                           alloccategory::lambda_argl})
+            {
+                INFO(tostr(xtag("c", c)));
+
+                CHECK(tu_a.n_alloc(c) > 0);
+                CHECK(tu_b.n_alloc(c) > 0);
+                CHECK(tu_a.n_byte(c) >= tu_a.n_alloc(c));
+            }
+
+            /* only 'pythagorean_distance' is too long for small-string storage */
+            CHECK(tu_a.n_alloc(alloccategory::token_text) == 1);
+            CHECK(tu_b.n_alloc(alloccategory::token_text) == 0);
+
+            /* exprstate memory is counted per request,  not per pool slab
+             * or stack segment:  each unit pays for its own states
+             * (virtual engine) and for infix operand/operator stacks (both engines)
+             */
+            CHECK(tu_a.n_alloc(alloccategory::exprstate) > 0);
+            CHECK(tu_b.n_alloc(alloccategory::exprstate) > 0);
+            CHECK(tu_a.n_alloc(alloccategory::exprstate) > tu_b.n_alloc(alloccategory::exprstate));
+
+            auto total = acct.total();
+            CHECK(total.n_alloc(alloccategory::expression)
+                  == (tu_a.n_alloc(alloccategory::expression)
+                      + tu_b.n_alloc(alloccategory::expression)));
+        }
+
+        TEST_CASE("allocaccount-outlived", "[allocaccount]") {
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            std::string text = "def f = lambda (x : f64) x * 2.0 + 1.0;\n";
+            reader::span_type input(text.data(), text.data() + text.size());
+
+            std::vector<reader_result> v;
+
+            reader rdr(engine);
+            {
+                allocaccount acct;
+                rdr.attach_allocaccount(&acct);
+                rdr.begin_translation_unit();
+                /* not at eof:  leaves incomplete states on the stack */
+                rdr.read_all(reader::span_type(text.data(), text.data() + text.size() - 6),
+                             false /*!eof*/, &v);
+
+                CHECK(acct.current().n_alloc(alloccategory::exprstate) > 0);
+
+                rdr.attach_allocaccount(nullptr);
+            }
+
+            /* memory handed out while attached is released
+             * after account is gone (e.g. under ASan)
+             */
+            rdr.begin_translation_unit();
+            rdr.read_all(input, true /*eof*/, &v);
+
+            REQUIRE(!v.empty());
+            CHECK(v.back().expr_);
+        }
+
+        TEST_CASE("allocaccount-restore", "[allocaccount]") {
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            auto feed = [](parser * p_parser, const std::string & text) {
+                reader::tokenizer_type tkz;
+                auto input = reader::span_type(text.data(), text.data() + text.size());
+
+                while (!input.empty()) {
+                    auto sr = tkz.scan2(input, false /*!eof*/);
+
+                    if (sr.first.is_valid())
+                        p_parser->include_token(sr.first);
+
+                    input = input.after_prefix(sr.second);
+                }
+            };
+
+            allocaccount acct;
+
+            parser psr(engine);
+            psr.attach_allocaccount(&acct);
+            psr.begin_translation_unit();
+
+            /* checkpoint with an infix expression in progress */
+            feed(&psr, "def k = 1.0 + 2.0 * ");
+
+            auto cp = psr.checkpoint();
+
+            psr.restore(cp);
+
+            /* restored operand/operator stacks are shared with cp;
+             * growing them allocates from the parser's resource,  so is counted
+             */
+            std::uint64_t n0 = acct.current().n_alloc(alloccategory::exprstate);
+
+            feed(&psr, "3.0 - 4.0 ");
+
+            CHECK(acct.current().n_alloc(alloccategory::exprstate) > n0);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end allocaccount.test.cpp */
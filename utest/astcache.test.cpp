@@ -0,0 +1,190 @@
+/* file astcache.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/astcache.hpp"
+#include "xo/reader/astimage.hpp"
+#include "xo/reader/reader.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace xo {
+    using xo::scm::astcache;
+    using xo::scm::astimage;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+
+    namespace ut {
+        namespace {
+            const char * s_source
+                = ("def pi : f64 = 3.14159265;\n"
+                   "def sq = lambda (x : f64) x * x;\n"
+                   "def k = 2.0 * 3.0 + 1.0 / 4.0 - 5.0;\n"
+                   "def f = lambda (x : f64, y : f64) { def z = x * y; z; };\n"
+                   "def g = lambda (x : f64) lambda (y : f64) x - y;\n");
+
+            std::vector<reader_result>
+            read_text(const std::string & text, bool fold = false) {
+                reader rdr;
+                std::vector<reader_result> retval;
+
+                rdr.enable_constant_folding(fold);
+                rdr.begin_translation_unit();
+                rdr.read_all(reader::span_type(text.data(), text.data() + text.size()),
+                             true /*eof*/, &retval);
+
+                return retval;
+            }
+
+            /* results @p x, @p y agree:  same printed expressions, spans and variable references */
+            void
+            check_same(const std::vector<reader_result> & x,
+                       const std::vector<reader_result> & y)
+            {
+                REQUIRE(x.size() == y.size());
+
+                for (std::size_t i = 0; i < x.size(); ++i) {
+                    INFO(tostr(xtag("i", i)));
+
+                    CHECK(tostr(x[i].expr_) == tostr(y[i].expr_));
+                    CHECK(x[i].expr_->valuetype() == y[i].expr_->valuetype());
+                    CHECK(x[i].rem_.lo() == y[i].rem_.lo());
+                    CHECK(x[i].rem_.hi() == y[i].rem_.hi());
+
+                    REQUIRE(x[i].varref_v_.size() == y[i].varref_v_.size());
+
+                    for (std::size_t j = 0; j < x[i].varref_v_.size(); ++j) {
+                        CHECK(x[i].varref_v_[j].var_->name() == y[i].varref_v_[j].var_->name());
+                        CHECK(x[i].varref_v_[j].addr_ == y[i].varref_v_[j].addr_);
+                    }
+                }
+            }
+        }
+
+        TEST_CASE("astimage", "[astcache]") {
+            std::string text = s_source;
+            auto source = astimage::span_type(text.data(), text.data() + text.size());
+
+            auto result_v = read_text(text);
+
+            REQUIRE(result_v.size() == 5);
+
+            std::string image;
+
+            REQUIRE(astimage::encode(source, 0 /*flags*/, result_v, &image));
+
+            auto image_span = astimage::span_type(image.data(), image.data() + image.size());
+            std::uint64_t h = astimage::content_hash(source);
+
+            CHECK(astimage::matches(image_span, source, h, 0));
+            CHECK(!astimage::matches(image_span, source, h, 1));
+            CHECK(!astimage::matches(image_span, source, h + 1, 0));
+
+            auto decoded_v = astimage::decode(image_span, source);
+
+            check_same(result_v, decoded_v);
+
+            /* variable references refer to variables within their expression */
+            CHECK(!decoded_v[1].varref_v_.empty());
+
+            /* truncated image */
+            CHECK_THROWS(astimage::decode(astimage::span_type(image.data(), image.data() + image.size() / 2),
+                                          source));
+        }
+
+        TEST_CASE("astcache-read-file", "[astcache]") {
+            namespace fs = std::filesystem;
+
+            std::string stem = "xo_astcache_utest_" + std::to_string(::getpid());
+            fs::path src_path = fs::temp_directory_path() / (stem + ".scm");
+            fs::path cache_dir = fs::temp_directory_path() / (stem + ".cache");
+
+            {
+                std::ofstream ofs(src_path);
+                ofs << s_source;
+            }
+
+            astcache cache(cache_dir.string());
+
+            reader rdr;
+            rdr.attach_astcache(&cache);
+
+            auto r1 = rdr.read_file(src_path.string());
+
+            CHECK(cache.stats().n_miss_ == 1);
+            CHECK(cache.stats().n_store_ == 1);
+
+            auto r2 = rdr.read_file(src_path.string());
+
+            CHECK(cache.stats().n_hit_ == 1);
+
+            {
+                /* spans are relative to each result's own mapping */
+                REQUIRE(r1.result_v_.size() == r2.result_v_.size());
+
+                for (std::size_t i = 0; i < r1.result_v_.size(); ++i) {
+                    const auto & x = r1.result_v_[i];
+                    const auto & y = r2.result_v_[i];
+
+                    CHECK(tostr(x.expr_) == tostr(y.expr_));
+                    CHECK(std::string(x.rem_.lo(), x.rem_.hi()) == std::string(y.rem_.lo(), y.rem_.hi()));
+                }
+            }
+
+            /* sink form also served from cache */
+            std::size_t n = rdr.read_file(src_path.string(), [](reader_result &&) {});
+
+            CHECK(n == 5);
+            CHECK(cache.stats().n_hit_ == 2);
+
+            /* different settings:  separate image */
+            rdr.enable_constant_folding(true);
+
+            auto r3 = rdr.read_file(src_path.string());
+
+            CHECK(cache.stats().n_miss_ == 2);
+            CHECK(tostr(r3.result_v_[2].expr_) != tostr(r1.result_v_[2].expr_));
+
+            rdr.enable_constant_folding(false);
+
+            /* damaged image:  miss,  then replaced */
+            {
+                std::string text = s_source;
+                auto source = astcache::span_type(text.data(), text.data() + text.size());
+                std::string path = cache.image_path(astimage::content_hash(source), 0 /*flags*/);
+
+                REQUIRE(fs::exists(path));
+                fs::resize_file(path, fs::file_size(path) / 2);
+            }
+
+            auto r4 = rdr.read_file(src_path.string());
+
+            CHECK(cache.stats().n_miss_ == 3);
+            CHECK(r4.result_v_.size() == 5);
+
+            rdr.read_file(src_path.string());
+
+            CHECK(cache.stats().n_hit_ == 3);
+
+            /* edited source:  miss */
+            {
+                std::ofstream ofs(src_path, std::ios::app);
+                ofs << "def extra = 1.0;\n";
+            }
+
+            auto r5 = rdr.read_file(src_path.string());
+
+            CHECK(cache.stats().n_miss_ == 4);
+            CHECK(r5.result_v_.size() == 6);
+
+            fs::remove(src_path);
+            fs::remove_all(cache_dir);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end astcache.test.cpp */
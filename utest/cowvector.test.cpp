@@ -0,0 +1,92 @@
+/* file cowvector.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/cowvector.hpp"
+#include <catch2/catch.hpp>
+
+namespace xo {
+    using xo::scm::cowvector;
+
+    namespace ut {
+        TEST_CASE("cowvector", "[cowvector]") {
+            /* small chunks,  so tests cross chunk boundaries */
+            using vector_type = cowvector<int, 4>;
+
+            vector_type v;
+
+            REQUIRE(v.empty());
+
+            for (int i = 0; i < 10; ++i)
+                v.push_back(i);
+
+            REQUIRE(v.size() == 10);
+            CHECK(v.front() == 0);
+            CHECK(v.back() == 9);
+            for (int i = 0; i < 10; ++i)
+                CHECK(v[i] == i);
+
+            /* copy shares storage */
+            vector_type cp = v;
+
+            CHECK(cp.same_as(v));
+            CHECK(v.has_prefix(cp));
+
+            /* changes to v don't show in cp */
+            v.push_back(10);
+
+            CHECK(!cp.same_as(v));
+            CHECK(v.has_prefix(cp));
+            CHECK(!cp.has_prefix(v));
+            CHECK(cp.size() == 10);
+            CHECK(cp.back() == 9);
+
+            for (int i = 0; i < 7; ++i)
+                v.pop_back();
+
+            REQUIRE(v.size() == 4);
+            CHECK(v.back() == 3);
+            CHECK(cp.has_prefix(v));
+            CHECK(cp.to_vector() == std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+            /* same size as before,  different contents */
+            v.push_back(-1);
+
+            CHECK(!cp.has_prefix(v));
+            CHECK(cp[4] == 4);
+            CHECK(v[4] == -1);
+
+            /* changes to cp don't show in v */
+            cp.pop_back();
+            cp.push_back(99);
+
+            CHECK(v.size() == 5);
+            CHECK(cp.back() == 99);
+            CHECK(cp[8] == 8);
+
+            v.clear();
+
+            CHECK(v.empty());
+            CHECK(cp.size() == 10);
+        }
+
+        TEST_CASE("cowvector-long", "[cowvector]") {
+            /* long shared chains release without deep recursion */
+            cowvector<int> v;
+
+            for (int i = 0; i < 1000000; ++i)
+                v.push_back(i);
+
+            cowvector<int> cp = v;
+
+            v.push_back(-1);
+            v.clear();
+
+            CHECK(cp.size() == 1000000);
+            CHECK(cp.back() == 999999);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end cowvector.test.cpp */
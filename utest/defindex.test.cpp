@@ -0,0 +1,168 @@
+/* file defindex.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/defindex.hpp"
+#include "xo/reader/reader.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace xo {
+    using xo::scm::defindexer;
+    using xo::scm::defindex;
+    using xo::scm::defindex_entry;
+    using xo::scm::reader;
+    using xo::ast::DefineExpr;
+
+    namespace ut {
+        namespace {
+            const char * s_source
+                = ("def pi : f64 = 3.14159265;\n"
+                   "def sq = lambda (x : f64) { def y = x * x; y; };\n"
+                   "def e : f64;\n"
+                   "def s = \"a;b\";\n"
+                   "def pi = 3.0;\n");
+        }
+
+        TEST_CASE("defindexer-scan", "[defindex]") {
+            std::string text = s_source;
+
+            auto entry_v = defindexer::scan(defindexer::span_type(text.data(),
+                                                                  text.data() + text.size()));
+
+            REQUIRE(entry_v.size() == 5);
+
+            CHECK(entry_v[0].name_ == "pi");
+            CHECK(entry_v[0].type_ == "f64");
+            CHECK(entry_v[1].name_ == "sq");
+            CHECK(entry_v[1].type_ == "");
+            CHECK(entry_v[2].name_ == "e");
+            CHECK(entry_v[2].type_ == "f64");
+            CHECK(entry_v[3].name_ == "s");
+            CHECK(entry_v[4].name_ == "pi");
+
+            /* each range is exactly the text the reader would consume for that def */
+            for (std::size_t i = 0; i < entry_v.size(); ++i) {
+                const auto & e = entry_v[i];
+
+                INFO(tostr(xtag("i", i), xtag("name", e.name_)));
+
+                std::string form = text.substr(e.lo_, e.hi_ - e.lo_);
+
+                CHECK(form.substr(0, 4) == "def ");
+                CHECK(form.back() == ';');
+                if (e.name_ == "s")
+                    CHECK(form == "def s = \"a;b\";");
+
+                /* reader doesn't do declarations or string literals yet */
+                if ((e.name_ != "e") && (e.name_ != "s")) {
+                    reader rdr;
+                    rdr.begin_translation_unit();
+
+                    auto rr = rdr.read_expr(reader::span_type(form.data(),
+                                                              form.data() + form.size()),
+                                            true /*eof*/);
+
+                    REQUIRE(rr.expr_.get());
+                    CHECK(DefineExpr::from(rr.expr_)->lhs_name() == e.name_);
+                    CHECK(rr.rem_.size() == form.size());
+                }
+            }
+        }
+
+        TEST_CASE("defindex-file", "[defindex]") {
+            namespace fs = std::filesystem;
+
+            std::string stem = "xo_defindex_utest_" + std::to_string(::getpid());
+            fs::path src_path = fs::temp_directory_path() / (stem + ".scm");
+            fs::path index_path = fs::temp_directory_path() / (stem + ".defix");
+
+            {
+                std::ofstream ofs(src_path);
+                ofs << s_source;
+            }
+
+            CHECK(defindexer::index_file(src_path.string(), index_path.string()) == 5);
+
+            {
+                defindex ix = defindex::open(index_path.string());
+
+                REQUIRE(ix.size() == 5);
+
+                /* sorted by name */
+                for (std::size_t i = 1; i < ix.size(); ++i)
+                    CHECK(ix.entry(i - 1).name_ <= ix.entry(i).name_);
+
+                /* redefinition: both,  in source order */
+                auto pi_v = ix.find("pi");
+                REQUIRE(pi_v.size() == 2);
+                CHECK(pi_v[0].type_ == "f64");
+                CHECK(pi_v[0].lo_ == 0);
+                CHECK(pi_v[1].type_ == "");
+                CHECK(pi_v[0].lo_ < pi_v[1].lo_);
+
+                auto sq_v = ix.find("sq");
+                REQUIRE(sq_v.size() == 1);
+                CHECK(std::string(s_source).substr(sq_v[0].lo_, 6) == "def sq");
+
+                CHECK(ix.find("nosuchname").empty());
+                CHECK(ix.find("a").empty());
+                CHECK(ix.find("zz").empty());
+            }
+
+            /* not an index */
+            CHECK_THROWS(defindex::open(src_path.string()));
+
+            /* truncated string table:  last entry's strings run past end of file */
+            {
+                auto z = fs::file_size(index_path);
+
+                fs::resize_file(index_path, z - 1);
+
+                /* open doesn't visit entries;  reading the damaged one throws */
+                defindex ix = defindex::open(index_path.string());
+
+                std::size_t n_throw = 0;
+                for (std::size_t i = 0; i < ix.size(); ++i) {
+                    try {
+                        ix.entry(i);
+                    } catch (std::runtime_error &) {
+                        ++n_throw;
+                    }
+                }
+
+                CHECK(n_throw >= 1);
+            }
+
+            /* corrupt entry:  name length past end of string table */
+            CHECK(defindexer::index_file(src_path.string(), index_path.string()) == 5);
+            {
+                std::fstream ofs(index_path, std::ios::binary | std::ios::in | std::ios::out);
+
+                /* header (16 bytes),  then entry 0:  lo, hi, name_off, name_len */
+                std::uint32_t name_len = 0x7fffffff;
+                ofs.seekp(16 + 8 + 8 + 4);
+                ofs.write(reinterpret_cast<const char *>(&name_len), sizeof(name_len));
+            }
+
+            {
+                defindex ix = defindex::open(index_path.string());
+
+                CHECK_THROWS(ix.entry(0));
+                CHECK_NOTHROW(ix.entry(1));
+                /* first entry in name order */
+                CHECK_THROWS(ix.find(""));
+            }
+
+            fs::remove(src_path);
+            fs::remove(index_path);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end defindex.test.cpp */
@@ -0,0 +1,160 @@
+/* file envframestack.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/envframestack.hpp"
+#include "xo/reflect/Reflect.hpp"
+#include <catch2/catch.hpp>
+
+namespace xo {
+    using xo::scm::envframestack;
+    using xo::scm::envframe;
+    using xo::scm::symboltable;
+    using xo::scm::symbolid;
+    using xo::scm::c_invalid_symbolid;
+    using xo::ast::Variable;
+    using xo::reflect::Reflect;
+
+    namespace ut {
+        TEST_CASE("symboltable-intern", "[symboltable]") {
+            symboltable symtab;
+
+            symbolid x = symtab.intern("x");
+            symbolid y = symtab.intern("y");
+
+            REQUIRE(x != y);
+            REQUIRE(symtab.size() == 2);
+
+            /* same name -> same id,  no new entry */
+            REQUIRE(symtab.intern(std::string("x")) == x);
+            REQUIRE(symtab.size() == 2);
+
+            REQUIRE(symtab.find("y") == y);
+            REQUIRE(symtab.find("z") == c_invalid_symbolid);
+            REQUIRE(symtab.name(x) == "x");
+            REQUIRE(symtab.name(y) == "y");
+        }
+
+        TEST_CASE("envframestack-shadow", "[envframestack]") {
+            auto f64 = Reflect::require<double>();
+
+            rp<Variable> x1 = Variable::make("x", f64);
+            rp<Variable> y1 = Variable::make("y", f64);
+            rp<Variable> x2 = Variable::make("x", f64);
+            rp<Variable> x3 = Variable::make("x", f64);
+
+            envframestack stack;
+
+            REQUIRE(stack.lookup("x").get() == nullptr);
+
+            stack.push_envframe(envframe({x1, y1}));
+
+            REQUIRE(stack.lookup("x").get() == x1.get());
+            REQUIRE(stack.lookup("y").get() == y1.get());
+            REQUIRE(stack.lookup("z").get() == nullptr);
+
+            /* inner frame shadows x, not y */
+            stack.push_envframe(envframe({x2}));
+
+            REQUIRE(stack.size() == 2);
+            REQUIRE(stack.lookup("x").get() == x2.get());
+            REQUIRE(stack.lookup("y").get() == y1.get());
+
+            /* lookup by interned id agrees */
+            symbolid x_id = stack.symtab().find("x");
+            REQUIRE(x_id != c_invalid_symbolid);
+            REQUIRE(stack.lookup(x_id).get() == x2.get());
+
+            /* repeated name within a frame: first occurrence wins */
+            stack.push_envframe(envframe({x3, x2}));
+
+            REQUIRE(stack.lookup("x").get() == x3.get());
+
+            /* pop restores outer bindings */
+            stack.pop_envframe();
+            REQUIRE(stack.lookup("x").get() == x2.get());
+
+            stack.pop_envframe();
+            REQUIRE(stack.lookup("x").get() == x1.get());
+
+            stack.pop_envframe();
+            REQUIRE(stack.empty());
+            REQUIRE(stack.lookup("x").get() == nullptr);
+            REQUIRE(stack.lookup("y").get() == nullptr);
+        }
+
+        TEST_CASE("envframestack-restore", "[envframestack]") {
+            using xo::scm::lexaddr;
+
+            auto f64 = Reflect::require<double>();
+
+            rp<Variable> x1 = Variable::make("x", f64);
+            rp<Variable> y1 = Variable::make("y", f64);
+            rp<Variable> a1 = Variable::make("a", f64);
+            rp<Variable> a2 = Variable::make("a", f64);
+            rp<Variable> b1 = Variable::make("b", f64);
+            rp<Variable> z1 = Variable::make("z", f64);
+
+            envframestack stack;
+
+            /* lambda frame,  then block frame with local defs */
+            stack.push_envframe(envframe({x1, y1}));
+            stack.push_envframe(envframe());
+            stack.extend_envframe(a1);
+
+            std::vector<envframe> saved_v = stack.frame_v();
+
+            REQUIRE(saved_v.size() == 2);
+            CHECK(saved_v[1].same_as(stack.frame_v()[1]));
+
+            /* block extended;  another frame pushed */
+            stack.extend_envframe(a2);
+            stack.extend_envframe(b1);
+            stack.push_envframe(envframe({z1}));
+
+            REQUIRE(stack.lookup("a").get() == a2.get());
+            CHECK(!saved_v[1].same_as(stack.frame_v()[1]));
+            CHECK(stack.frame_v()[1].extends(saved_v[1]));
+
+            stack.restore_frames(saved_v);
+
+            REQUIRE(stack.size() == 2);
+            CHECK(stack.frame_v()[0].same_as(saved_v[0]));
+            CHECK(stack.frame_v()[1].same_as(saved_v[1]));
+            CHECK(stack.lookup("a").get() == a1.get());
+            CHECK(stack.lookup("b").get() == nullptr);
+            CHECK(stack.lookup("z").get() == nullptr);
+            CHECK(stack.lookup("y").get() == y1.get());
+
+            lexaddr addr;
+            REQUIRE(stack.lookup_addr("a", &addr).get() == a1.get());
+            CHECK(addr == lexaddr(0, 0));
+
+            /* later local def shadows earlier one,
+             * also when rebuilding a popped frame
+             */
+            stack.extend_envframe(a2);
+
+            std::vector<envframe> saved2_v = stack.frame_v();
+
+            stack.pop_envframe();
+            stack.pop_envframe();
+
+            REQUIRE(stack.empty());
+
+            stack.restore_frames(saved2_v);
+
+            REQUIRE(stack.size() == 2);
+            CHECK(stack.lookup("a").get() == a2.get());
+            REQUIRE(stack.lookup_addr("a", &addr).get() == a2.get());
+            CHECK(addr == lexaddr(0, 1));
+            CHECK(stack.lookup("x").get() == x1.get());
+
+            /* saved frames unaffected by later changes */
+            CHECK(saved_v[1].argl().size() == 1);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end envframestack.test.cpp */
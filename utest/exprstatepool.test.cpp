@@ -0,0 +1,114 @@
+/* file exprstatepool.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/parser.hpp"
+#include "xo/reader/exprstatepool.hpp"
+#include "xo/tokenizer/tokenizer.hpp"
+#include <catch2/catch.hpp>
+
+namespace xo {
+    using parser_type = xo::scm::parser;
+    using xo::scm::exprstatepool;
+    using xo::scm::exprstatepool_stats;
+    using tokenizer_type = xo::scm::tokenizer<char>;
+
+    namespace ut {
+        namespace {
+            /* feed @p text through tokenizer + parser.
+             * return number of toplevel expressions parsed
+             */
+            std::size_t
+            parse_text(const std::string & text,
+                       tokenizer_type * p_tkz,
+                       parser_type * p_parser)
+            {
+                auto input = tokenizer_type::span_type(text.data(),
+                                                       text.data() + text.size());
+                std::size_t n_expr = 0;
+
+                while (!input.empty()) {
+                    auto sr = p_tkz->scan2(input, false /*!eof*/);
+
+                    if (sr.first.is_valid()) {
+                        if (p_parser->include_token(sr.first))
+                            ++n_expr;
+                    }
+
+                    input = input.after_prefix(sr.second);
+                }
+
+                return n_expr;
+            }
+        }
+
+        TEST_CASE("exprstatepool-reuse", "[exprstatepool]") {
+            exprstatepool pool;
+
+            void * m1 = pool.alloc(40);
+            void * m2 = pool.alloc(40);
+
+            REQUIRE(m1 != m2);
+            REQUIRE(pool.stats().n_slab_ == 1);
+
+            pool.release(m1, 40);
+
+            /* same size class -> same block */
+            void * m3 = pool.alloc(33);
+
+            REQUIRE(m3 == m1);
+
+            pool.release(m2, 40);
+            pool.release(m3, 33);
+
+            REQUIRE(pool.stats().n_alloc_ == 3);
+            REQUIRE(pool.stats().n_release_ == 3);
+            REQUIRE(pool.stats().n_slab_ == 1);
+            REQUIRE(pool.stats().n_oversize_ == 0);
+        }
+
+        TEST_CASE("exprstatepool-steady-state", "[exprstatepool]") {
+            /* long translation unit should not allocate memory for parser states,
+             * once warmed up
+             */
+            std::string form = ("def foo : f64 = 3.14159265;\n"
+                                "def bar = (2.0 * 3.0);\n"
+                                "def sq = lambda (x : f64, y : f64) x;\n");
+
+            tokenizer_type tkz;
+            parser_type parser;
+
+            parser.begin_translation_unit();
+
+            /* warmup */
+            REQUIRE(parse_text(form, &tkz, &parser) == 3);
+
+            exprstatepool_stats s1 = parser.xs_pool_stats();
+
+            REQUIRE(s1.n_slab_ > 0);
+
+            std::size_t n_form = 1000;
+            std::size_t n_expr = 0;
+
+            for (std::size_t i = 0; i < n_form; ++i)
+                n_expr += parse_text(form, &tkz, &parser);
+
+            exprstatepool_stats s2 = parser.xs_pool_stats();
+
+            INFO(xtag("s1", s1) << xtag("s2", s2));
+
+            REQUIRE(n_expr == 3 * n_form);
+            /* parser states were created.. */
+            REQUIRE(s2.n_alloc_ > s1.n_alloc_ + n_expr);
+            /* ..but no new memory obtained for them */
+            REQUIRE(s2.n_slab_ == s1.n_slab_);
+            REQUIRE(s2.n_oversize_ == 0);
+            /* only live state is toplevel exprseq_xs */
+            REQUIRE(s2.n_alloc_ - s2.n_release_ == parser.stack_size());
+            REQUIRE(parser.stack_size() == 1);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end exprstatepool.test.cpp */
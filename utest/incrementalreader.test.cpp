@@ -0,0 +1,244 @@
+/* file incrementalreader.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/incrementalreader.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <catch2/catch.hpp>
+
+namespace xo {
+    using xo::scm::incrementalreader;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+
+    namespace ut {
+        namespace {
+            using span_type = incrementalreader::span_type;
+
+            span_type
+            as_span(const std::string & text) {
+                return span_type(text.data(), text.data() + text.size());
+            }
+
+            /* printed form of each expression */
+            std::vector<std::string>
+            printed(const std::vector<reader_result> & result_v) {
+                std::vector<std::string> retval;
+
+                for (const auto & rr : result_v)
+                    retval.push_back(tostr(rr.expr_));
+
+                return retval;
+            }
+
+            std::vector<reader_result>
+            full_read(const std::string & text) {
+                reader rdr;
+                std::vector<reader_result> retval;
+
+                rdr.begin_translation_unit();
+                rdr.read_all(as_span(text), true /*eof*/, &retval);
+
+                return retval;
+            }
+        }
+
+        TEST_CASE("incrementalreader-hash", "[incrementalreader]") {
+            auto h = [](const std::string & text) { return incrementalreader::form_hash(as_span(text)); };
+
+            CHECK(h("def x = 1.0;") == h("\n  def  x =\t1.0;  "));
+            CHECK(h("def x = 1.0;") != h("def x = 2.0;"));
+            CHECK(h("def xy = 1.0;") != h("def x y = 1.0;"));
+            CHECK(h("def s = \"a b\";") != h("def s = \"a  b\";"));
+        }
+
+        TEST_CASE("incrementalreader", "[incrementalreader]") {
+            std::string v1
+                = ("def a : f64 = 1.0;\n"
+                   "def sq = lambda (x : f64) x * x;\n"
+                   "def g = lambda (a : f64) a;\n"
+                   "def h = lambda (y : f64) y;\n");
+
+            incrementalreader ird;
+
+            auto r1 = ird.read(as_span(v1));
+
+            REQUIRE(r1.size() == 4);
+            CHECK(ird.last_stats().n_form_ == 4);
+            CHECK(ird.last_stats().n_changed_ == 4);
+            CHECK(printed(r1) == printed(full_read(v1)));
+
+            /* identical input:  everything reused */
+            {
+                std::string text = v1;
+                auto r2 = ird.read(as_span(text));
+
+                REQUIRE(r2.size() == 4);
+                CHECK(ird.last_stats().n_reused_ == 4);
+                CHECK(ird.last_stats().n_changed_ == 0);
+
+                for (std::size_t i = 0; i < 4; ++i) {
+                    INFO(tostr(xtag("i", i)));
+
+                    CHECK(r2[i].expr_.get() == r1[i].expr_.get());
+                    /* spans point into new input */
+                    CHECK(std::string(r2[i].rem_.lo(), r2[i].rem_.hi())
+                          == std::string(r1[i].rem_.lo(), r1[i].rem_.hi()));
+                    CHECK(r2[i].rem_.lo() >= text.data());
+                    CHECK(r2[i].rem_.hi() <= text.data() + text.size());
+                }
+            }
+
+            /* whitespace-only edit:  still reused */
+            {
+                std::string text
+                    = ("def a : f64 = 1.0;\n\n"
+                       "def sq =\n  lambda (x : f64)\n    x * x;\n"
+                       "def g = lambda (a : f64) a;\n"
+                       "def h = lambda (y : f64) y;\n");
+                auto r2 = ird.read(as_span(text));
+
+                CHECK(ird.last_stats().n_reused_ == 4);
+                CHECK(r2[1].expr_.get() == r1[1].expr_.get());
+            }
+
+            /* edit one form:  only that form reparsed */
+            {
+                std::string text
+                    = ("def a : f64 = 1.0;\n"
+                       "def sq = lambda (x : f64) x * x * x;\n"
+                       "def g = lambda (a : f64) a;\n"
+                       "def h = lambda (y : f64) y;\n");
+                auto r2 = ird.read(as_span(text));
+
+                REQUIRE(r2.size() == 4);
+                CHECK(ird.last_stats().n_changed_ == 1);
+                CHECK(ird.last_stats().n_invalidated_ == 0);
+                CHECK(ird.last_stats().n_reused_ == 3);
+                CHECK(r2[0].expr_.get() == r1[0].expr_.get());
+                CHECK(r2[1].expr_.get() != r1[1].expr_.get());
+                CHECK(printed(r2) == printed(full_read(text)));
+            }
+
+            /* edit definition of a:  forms mentioning a reparsed too */
+            {
+                std::string text
+                    = ("def a : f64 = 2.0;\n"
+                       "def sq = lambda (x : f64) x * x * x;\n"
+                       "def g = lambda (a : f64) a;\n"
+                       "def h = lambda (y : f64) y;\n");
+                auto r2 = ird.read(as_span(text));
+
+                REQUIRE(r2.size() == 4);
+                CHECK(ird.last_stats().n_changed_ == 1);
+                CHECK(ird.last_stats().n_invalidated_ == 1);
+                CHECK(ird.last_stats().n_reused_ == 2);
+                CHECK(r2[2].expr_.get() != r1[2].expr_.get());
+                CHECK(r2[3].expr_.get() == r1[3].expr_.get());
+                CHECK(printed(r2) == printed(full_read(text)));
+            }
+        }
+
+        TEST_CASE("incrementalreader-reindent", "[incrementalreader]") {
+            /* reused forms get spans in the new text */
+            std::string v1
+                = ("def a : f64 = 1.0;\n"
+                   "def sq = lambda (x : f64) x * x;\n"
+                   "def s = \"p  q\";\n");
+
+            incrementalreader ird;
+
+            auto r1 = ird.read(as_span(v1));
+
+            REQUIRE(r1.size() == 3);
+
+            std::string v2
+                = ("def a : f64 = 1.0;\n\n\n"
+                   "def   sq =\n      lambda (x : f64)\n          x * x;\n"
+                   "  def s =  \"p  q\";\n");
+
+            auto r2 = ird.read(as_span(v2));
+            auto r0 = full_read(v2);
+
+            REQUIRE(r2.size() == 3);
+            REQUIRE(r0.size() == 3);
+            CHECK(ird.last_stats().n_reused_ == 3);
+
+            for (std::size_t i = 0; i < 3; ++i) {
+                INFO(tostr(xtag("i", i)));
+
+                CHECK(r2[i].expr_.get() == r1[i].expr_.get());
+                /* same span as reading v2 from scratch */
+                CHECK(r2[i].rem_.lo() == r0[i].rem_.lo());
+                CHECK(r2[i].rem_.hi() == r0[i].rem_.hi());
+            }
+
+            /* whitespace inside a string literal is not reindentation */
+            std::string v3
+                = ("def a : f64 = 1.0;\n"
+                   "def sq = lambda (x : f64) x * x;\n"
+                   "def s = \"p q\";\n");
+
+            auto r3 = ird.read(as_span(v3));
+
+            REQUIRE(r3.size() == 3);
+            CHECK(ird.last_stats().n_changed_ == 1);
+            CHECK(r3[2].expr_.get() != r1[2].expr_.get());
+            CHECK(r3[2].rem_.hi() == v3.data() + v3.size() - 1);
+        }
+
+        TEST_CASE("incrementalreader-reorder", "[incrementalreader]") {
+            std::string v1
+                = ("def p : f64 = 1.0;\n"
+                   "def q : f64 = 2.0;\n"
+                   "def q : f64 = 2.0;\n"
+                   "def r : f64 = 3.0;\n");
+
+            incrementalreader ird;
+
+            auto r1 = ird.read(as_span(v1));
+
+            REQUIRE(r1.size() == 4);
+
+            /* moved forms match by key;  duplicates each keep their own expression */
+            std::string text
+                = ("def q : f64 = 2.0;\n"
+                   "def r : f64 = 3.0;\n"
+                   "def p : f64 = 1.0;\n"
+                   "def q : f64 = 2.0;\n");
+            auto r2 = ird.read(as_span(text));
+
+            REQUIRE(r2.size() == 4);
+            CHECK(ird.last_stats().n_reused_ == 4);
+            CHECK(r2[1].expr_.get() == r1[3].expr_.get());
+            CHECK(r2[2].expr_.get() == r1[0].expr_.get());
+            CHECK(r2[0].expr_.get() != r2[3].expr_.get());
+            CHECK(printed(r2) == printed(full_read(text)));
+        }
+
+        TEST_CASE("incrementalreader-error", "[incrementalreader]") {
+            std::string v1 = "def a : f64 = 1.0;\ndef b : f64 = 2.0;\n";
+
+            incrementalreader ird;
+
+            auto r1 = ird.read(as_span(v1));
+
+            REQUIRE(r1.size() == 2);
+
+            /* incomplete trailing form */
+            std::string bad = v1 + "def c : f64 = ";
+
+            CHECK_THROWS(ird.read(as_span(bad)));
+
+            /* cache unchanged by failed read */
+            std::string text = v1;
+            auto r2 = ird.read(as_span(text));
+
+            CHECK(ird.last_stats().n_reused_ == 2);
+            CHECK(r2[1].expr_.get() == r1[1].expr_.get());
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end incrementalreader.test.cpp */
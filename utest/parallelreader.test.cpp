@@ -0,0 +1,299 @@
+/* file parallelreader.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/parallelreader.hpp"
+#include "xo/reader/segmenter.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace xo {
+    using xo::scm::concurrentsymboltable;
+    using xo::scm::symboltable;
+    using xo::scm::symbolid;
+    using xo::scm::parallelreader;
+    using xo::scm::parallel_result;
+    using xo::scm::segmenter;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+    using xo::ast::DefineExpr;
+
+    namespace ut {
+        TEST_CASE("concurrentsymboltable", "[parallelreader]") {
+            concurrentsymboltable shared;
+
+            constexpr std::size_t c_n_thread = 4;
+            constexpr std::size_t c_n_name = 500;
+
+            /* ids_v[k][j]: id that thread k got for name j */
+            std::vector<std::vector<symbolid>> ids_v(c_n_thread,
+                                                     std::vector<symbolid>(c_n_name));
+            std::vector<std::thread> thread_v;
+
+            for (std::size_t k = 0; k < c_n_thread; ++k) {
+                thread_v.emplace_back([&shared, &ids_v, k]
+                                          {
+                                              symboltable local;
+                                              local.attach_shared(&shared);
+
+                                              /* twice:  second pass served from local cache */
+                                              for (int pass = 0; pass < 2; ++pass) {
+                                                  for (std::size_t j = 0; j < c_n_name; ++j) {
+                                                      /* threads visit names in different orders */
+                                                      std::size_t jj = (j + k * 137) % c_n_name;
+                                                      ids_v[k][jj] = local.intern("n" + std::to_string(jj));
+                                                  }
+                                              }
+                                          });
+            }
+
+            for (auto & th : thread_v)
+                th.join();
+
+            REQUIRE(shared.size() == c_n_name);
+
+            /* all threads agree on ids */
+            for (std::size_t j = 0; j < c_n_name; ++j) {
+                for (std::size_t k = 1; k < c_n_thread; ++k)
+                    CHECK(ids_v[k][j] == ids_v[0][j]);
+
+                CHECK(shared.name(ids_v[0][j]) == "n" + std::to_string(j));
+            }
+
+            CHECK(shared.find("nosuchname") == xo::scm::c_invalid_symbolid);
+
+            /* find() through an attached table:  miss not cached,  hit is */
+            {
+                symboltable a;
+                symboltable b;
+                a.attach_shared(&shared);
+                b.attach_shared(&shared);
+
+                CHECK(a.find("late") == xo::scm::c_invalid_symbolid);
+
+                symbolid id = b.intern("late");
+
+                CHECK(a.find("late") == id);
+                CHECK(a.find("late") == id);
+                CHECK(a.name(id) == "late");
+            }
+        }
+
+        TEST_CASE("parallelreader", "[parallelreader]") {
+            using span_type = parallelreader::span_type;
+
+            /* input k:  k+1 definitions;  input 3 has a parse error */
+            std::vector<std::string> text_v;
+            for (std::size_t k = 0; k < 8; ++k) {
+                std::string text;
+                for (std::size_t i = 0; i <= k; ++i) {
+                    text += "def f" + std::to_string(k) + "_" + std::to_string(i)
+                        + " = lambda (x : f64, y" + std::to_string(i) + " : f64) x;\n";
+                }
+                if (k == 3)
+                    text += "def bad = );\n";
+                text_v.push_back(text);
+            }
+
+            std::vector<span_type> input_v;
+            for (const auto & text : text_v)
+                input_v.push_back(span_type(text.data(), text.data() + text.size()));
+
+            parallelreader prdr(3);
+
+            REQUIRE(prdr.n_thread() == 3);
+
+            /* twice:  second call reuses readers,  and their state is clean */
+            for (int pass = 0; pass < 2; ++pass) {
+                INFO(tostr(xtag("pass", pass)));
+
+                auto res_v = prdr.read_buffers(input_v);
+
+                REQUIRE(res_v.size() == input_v.size());
+
+                for (std::size_t k = 0; k < res_v.size(); ++k) {
+                    INFO(tostr(xtag("k", k)));
+
+                    const parallel_result & res = res_v[k];
+
+                    CHECK(res.error_.empty() == (k != 3));
+                    REQUIRE(res.result_v_.size() == k + 1);
+
+                    for (std::size_t i = 0; i <= k; ++i) {
+                        CHECK(DefineExpr::from(res.result_v_[i].expr_)->lhs_name()
+                              == "f" + std::to_string(k) + "_" + std::to_string(i));
+                    }
+                }
+            }
+
+            /* formals x, y0..y7 */
+            CHECK(prdr.symtab().size() == 9);
+        }
+
+        TEST_CASE("parallelreader-error-then-good", "[parallelreader]") {
+            /* one worker:  failed input must not leak its partial token into the next */
+            using span_type = parallelreader::span_type;
+
+            std::vector<std::string> text_v = {
+                "def a = 1.0;\ndef s = \"abc",
+                "def b = 2.0;\n",
+            };
+
+            std::vector<span_type> input_v;
+            for (const auto & text : text_v)
+                input_v.push_back(span_type(text.data(), text.data() + text.size()));
+
+            parallelreader prdr(1);
+
+            auto res_v = prdr.read_buffers(input_v);
+
+            REQUIRE(res_v.size() == 2);
+
+            CHECK(!res_v[0].error_.empty());
+            REQUIRE(res_v[0].result_v_.size() == 1);
+
+            INFO(res_v[1].error_);
+
+            CHECK(res_v[1].error_.empty());
+            REQUIRE(res_v[1].result_v_.size() == 1);
+            CHECK(DefineExpr::from(res_v[1].result_v_[0].expr_)->lhs_name() == "b");
+        }
+
+        TEST_CASE("parallelreader-files", "[parallelreader]") {
+            namespace fs = std::filesystem;
+
+            std::vector<std::string> path_v;
+
+            for (std::size_t k = 0; k < 4; ++k) {
+                fs::path path = fs::temp_directory_path()
+                    / ("xo_parallelreader_" + std::to_string(k) + ".utest");
+
+                std::ofstream ofs(path);
+                ofs << "def a" << k << " = 1.0;\n";
+
+                path_v.push_back(path.string());
+            }
+
+            path_v.push_back((fs::temp_directory_path() / "xo_parallelreader_nosuchfile").string());
+
+            parallelreader prdr(2);
+
+            auto res_v = prdr.read_files(path_v);
+
+            REQUIRE(res_v.size() == 5);
+
+            for (std::size_t k = 0; k < 4; ++k) {
+                CHECK(res_v[k].error_.empty());
+                REQUIRE(res_v[k].result_v_.size() == 1);
+                CHECK(DefineExpr::from(res_v[k].result_v_[0].expr_)->lhs_name()
+                      == "a" + std::to_string(k));
+
+                fs::remove(path_v[k]);
+            }
+
+            CHECK(!res_v[4].error_.empty());
+            CHECK(res_v[4].result_v_.empty());
+        }
+
+        TEST_CASE("segmenter", "[parallelreader]") {
+            using span_type = segmenter::span_type;
+
+            std::string text = ("def a = 1.0;"
+                                "def f = lambda (x : f64) { def y = x; y; };"
+                                "def s = \"q;\\\";\";"
+                                "def b = (2.0);");
+
+            auto input = span_type(text.data(), text.data() + text.size());
+
+            /* ask for more segments than there are forms */
+            auto cut_v = segmenter::split(input, 100);
+
+            std::vector<std::string> piece_v;
+            std::size_t lo = 0;
+            for (std::size_t cut : cut_v) {
+                piece_v.push_back(text.substr(lo, cut - lo));
+                lo = cut;
+            }
+            piece_v.push_back(text.substr(lo));
+
+            /* no cut inside braces or string literal */
+            REQUIRE(piece_v.size() == 4);
+            CHECK(piece_v[0] == "def a = 1.0;");
+            CHECK(piece_v[1] == "def f = lambda (x : f64) { def y = x; y; };");
+            CHECK(piece_v[2] == "def s = \"q;\\\";\";");
+            CHECK(piece_v[3] == "def b = (2.0);");
+
+            CHECK(segmenter::split(input, 1).empty());
+            CHECK(segmenter::split(input, 2).size() == 1);
+        }
+
+        TEST_CASE("parallelreader-split", "[parallelreader]") {
+            using span_type = parallelreader::span_type;
+
+            std::string text;
+            for (std::size_t i = 0; i < 100; ++i) {
+                text += "def a" + std::to_string(i) + " = 1.0;\n";
+                text += "def f" + std::to_string(i) + " = lambda (x : f64) { def y = x; y; };\n";
+            }
+
+            auto input = span_type(text.data(), text.data() + text.size());
+
+            /* reference: serial */
+            std::vector<reader_result> expect_v;
+            {
+                reader rdr;
+                rdr.begin_translation_unit();
+                rdr.read_all(input, true /*eof*/, &expect_v);
+            }
+
+            parallelreader prdr(3);
+
+            auto require_same = [&expect_v](const xo::scm::parallel_result & res)
+                                    {
+                                        REQUIRE(res.error_.empty());
+                                        REQUIRE(res.result_v_.size() == expect_v.size());
+
+                                        for (std::size_t i = 0; i < expect_v.size(); ++i) {
+                                            CHECK(res.result_v_[i].rem_.lo() == expect_v[i].rem_.lo());
+                                            CHECK(res.result_v_[i].rem_.hi() == expect_v[i].rem_.hi());
+                                        }
+                                    };
+
+            SECTION("segmenter cuts") {
+                auto res = prdr.read_split(input, 16);
+
+                require_same(res);
+                CHECK(prdr.last_split_stats().n_segment_ == 16);
+                CHECK(prdr.last_split_stats().n_reparse_ == 0);
+            }
+
+            SECTION("bad cuts") {
+                /* cut mid-token, mid-expression, inside a block */
+                std::size_t block = text.find("{ def y");
+                std::vector<std::size_t> cut_v = {3, block + 3, block + 40, text.size() / 2};
+
+                auto res = prdr.read_split(input, cut_v);
+
+                require_same(res);
+                CHECK(prdr.last_split_stats().n_segment_ == 5);
+                CHECK(prdr.last_split_stats().n_reparse_ > 0);
+            }
+
+            SECTION("real error") {
+                std::string bad = text + "def oops = );\n" + text;
+
+                auto res = prdr.read_split(span_type(bad.data(), bad.data() + bad.size()), 8);
+
+                CHECK(!res.error_.empty());
+                /* everything before the error */
+                CHECK(res.result_v_.size() == expect_v.size());
+            }
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end parallelreader.test.cpp */
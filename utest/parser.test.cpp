@@ -5,11 +5,13 @@
 
 #include "xo/reader/parser.hpp"
 #include "xo/reader/define_xs.hpp"
+#include "xo/tokenizer/tokenizer.hpp"
 #include <catch2/catch.hpp>
 
 namespace xo {
     using parser_type = xo::scm::parser;
     using token_type = parser_type::token_type;
+    using xo::scm::parserengine;
     using xo::scm::exprstatetype;
     using xo::scm::define_xs;
     using xo::scm::defexprstatetype;
@@ -20,11 +22,17 @@ namespace xo {
 
     namespace ut {
         TEST_CASE("parser", "[parser]") {
+            /* same expectations for each parser engine */
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
             for (std::size_t i_tc = 0; i_tc < 2; ++i_tc) {
-                parser_type parser;
+                parser_type parser(engine);
 
                 constexpr bool c_debug_flag = true;
-                scope log(XO_DEBUG(c_debug_flag), xtag("i_tc", i_tc));
+                scope log(XO_DEBUG(c_debug_flag), xtag("engine", engine), xtag("i_tc", i_tc));
 
                 parser.begin_translation_unit();
 
@@ -273,6 +281,310 @@ namespace xo {
                 }
             }
         } /*TEST_CASE(parser)*/
+
+        TEST_CASE("parser-infix-depth", "[parser]") {
+            /* parser stack depth doesn't grow with length of an operator chain */
+
+            using tokenizer_type = xo::scm::tokenizer<char>;
+
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            for (std::size_t n_op : {1, 10, 1000}) {
+                std::string text = "def x = 1.0";
+                for (std::size_t i = 0; i < n_op; ++i)
+                    text += ((i % 2 == 0) ? " + 2.0" : " * 3.0");
+                text += ";";
+
+                INFO(tostr(xtag("n_op", n_op)));
+
+                parser_type parser(engine);
+                tokenizer_type tkz;
+
+                parser.begin_translation_unit();
+
+                std::size_t max_depth = 0;
+                std::size_t n_expr = 0;
+                auto input = tokenizer_type::span_type(text.data(), text.data() + text.size());
+
+                while (!input.empty()) {
+                    auto sr = tkz.scan2(input, true /*eof*/);
+
+                    if (sr.first.is_valid()) {
+                        if (parser.include_token(sr.first))
+                            ++n_expr;
+                        max_depth = std::max(max_depth, parser.stack_size());
+                    }
+
+                    input = input.after_prefix(sr.second);
+                }
+
+                CHECK(n_expr == 1);
+                /* exprseq, define, expect_expr, progress, expect_expr */
+                CHECK(max_depth <= 5);
+            }
+        }
+
+        namespace {
+            using tokenizer_type = xo::scm::tokenizer<char>;
+
+            /* feed tokens in @p text to @p parser;  return expressions completed */
+            std::vector<rp<xo::ast::Expression>>
+            feed(parser_type * p_parser, const std::string & text) {
+                std::vector<rp<xo::ast::Expression>> retval;
+
+                tokenizer_type tkz;
+                auto input = tokenizer_type::span_type(text.data(), text.data() + text.size());
+
+                while (!input.empty()) {
+                    auto sr = tkz.scan2(input, false /*!eof*/);
+
+                    if (sr.first.is_valid()) {
+                        auto expr = p_parser->include_token(sr.first);
+
+                        if (expr)
+                            retval.push_back(expr);
+                    }
+
+                    input = input.after_prefix(sr.second);
+                }
+
+                return retval;
+            }
+        }
+
+        TEST_CASE("parser-incomplete-expr", "[parser]") {
+            /* toplevel exprseq_xs alone does not make an incomplete expression */
+
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            parser_type parser(engine);
+
+            parser.begin_translation_unit();
+
+            CHECK(parser.stack_size() == 1);
+            CHECK(!parser.has_incomplete_expr());
+
+            REQUIRE(feed(&parser, "def x = ").empty());
+
+            CHECK(parser.has_incomplete_expr());
+
+            REQUIRE(feed(&parser, "1.0;\n").size() == 1);
+
+            CHECK(parser.stack_size() == 1);
+            CHECK(!parser.has_incomplete_expr());
+        }
+
+        TEST_CASE("parser-checkpoint", "[parser]") {
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            parser_type parser(engine);
+
+            parser.begin_translation_unit();
+
+            /* checkpoint inside a definition,  inside a lambda */
+            REQUIRE(feed(&parser, "def f : f64 = lambda (x : f64) x * ").empty());
+
+            std::size_t depth = parser.stack_size();
+            std::size_t n_varref = parser.varref_v().size();
+
+            auto cp = parser.checkpoint();
+
+            CHECK(cp.stack_size() == depth);
+
+            auto a = feed(&parser, "x;\n");
+
+            REQUIRE(a.size() == 1);
+
+            std::string a_str = tostr(a[0]);
+
+            CHECK(parser.stack_size() == 1);
+            CHECK(parser.varref_v().size() > n_varref);
+
+            /* rewind;  finish differently */
+            parser.restore(cp);
+
+            CHECK(parser.stack_size() == depth);
+            CHECK(parser.varref_v().size() == n_varref);
+
+            auto b = feed(&parser, "2.0;\n");
+
+            REQUIRE(b.size() == 1);
+            CHECK(tostr(b[0]) != a_str);
+            /* first result not disturbed by second */
+            CHECK(tostr(a[0]) == a_str);
+
+            /* same checkpoint again:  same result as first time */
+            parser.restore(cp);
+
+            auto c = feed(&parser, "x;\n");
+
+            REQUIRE(c.size() == 1);
+            CHECK(tostr(c[0]) == a_str);
+            CHECK(c[0].get() != a[0].get());
+
+            /* roll back after a parse error */
+            auto cp2 = parser.checkpoint();
+
+            CHECK(cp2.stack_size() == 1);
+            CHECK_THROWS(feed(&parser, "def g = ;"));
+
+            parser.restore(cp2);
+
+            auto d = feed(&parser, "def g = 1.0;\n");
+
+            REQUIRE(d.size() == 1);
+        }
+
+        TEST_CASE("parser-checkpoint-block", "[parser]") {
+            using xo::scm::parserstats;
+
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            parser_type parser(engine);
+
+            parser.enable_stats(true);
+            parser.begin_translation_unit();
+
+            /* checkpoint inside a block,  after some local definitions */
+            REQUIRE(feed(&parser, ("def f = lambda (x : f64) {"
+                                   " def a = x * 2.0; def b = a + 1.0; b + ")).empty());
+
+            std::size_t depth = parser.stack_size();
+
+            auto cp = parser.checkpoint();
+
+            /* continue:  shadow a,  add a local */
+            auto a = feed(&parser, "1.0; def a = b; def c = a; c * a; };\n");
+
+            REQUIRE(a.size() == 1);
+
+            std::string a_str = tostr(a[0]);
+
+            auto push_count = [&parser]() {
+                std::uint64_t n = 0;
+                for (std::uint64_t k : parser.stats().push_v_)
+                    n += k;
+                return n;
+            };
+
+            std::uint64_t n_push = push_count();
+
+            /* rewind;  locals defined since cp are out of scope again */
+            parser.restore(cp);
+
+            CHECK(parser.stack_size() == depth);
+            /* rebuilding the stack is not counted as parsing */
+            CHECK(push_count() == n_push);
+
+            CHECK_THROWS(feed(&parser, "c; };\n"));
+
+            parser.restore(cp);
+
+            auto b = feed(&parser, "2.0; b; };\n");
+
+            REQUIRE(b.size() == 1);
+            CHECK(tostr(b[0]) != a_str);
+            CHECK(tostr(a[0]) == a_str);
+
+            /* same checkpoint again:  same result as first time */
+            parser.restore(cp);
+
+            auto c = feed(&parser, "1.0; def a = b; def c = a; c * a; };\n");
+
+            REQUIRE(c.size() == 1);
+            CHECK(tostr(c[0]) == a_str);
+        }
+
+        TEST_CASE("parser-stats", "[parser]") {
+            using xo::scm::parserstats;
+
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            parser_type parser(engine);
+
+            parser.enable_stats(true);
+            CHECK(parser.stats_enabled() == parserstats::c_stats_enabled);
+
+            parser.begin_translation_unit();
+
+            auto v = feed(&parser, ("def f = lambda (x : f64) lambda (y : f64) x * y;\n"
+                                    "def g = 1.0;\n"));
+
+            REQUIRE(v.size() == 2);
+
+            const parserstats & stats = parser.stats();
+
+            INFO(tostr(xtag("stats", stats)));
+
+            if constexpr (parserstats::c_stats_enabled) {
+                auto i_def = static_cast<std::size_t>(exprstatetype::defexpr);
+                auto i_lambda = static_cast<std::size_t>(exprstatetype::lambdaexpr);
+
+                CHECK(stats.push_v_[i_def] == 2);
+                CHECK(stats.pop_v_[i_def] == 2);
+                CHECK(stats.push_v_[i_lambda] == 2);
+                CHECK(stats.pop_v_[i_lambda] == 2);
+
+                std::uint64_t n_push = 0;
+                std::uint64_t n_pop = 0;
+                std::uint64_t n_hist = 0;
+                for (std::size_t i = 0; i < parserstats::c_n_exstype; ++i) {
+                    n_push += stats.push_v_[i];
+                    n_pop += stats.pop_v_[i];
+                }
+                for (std::uint64_t n : stats.xs_depth_hist_)
+                    n_hist += n;
+
+                /* toplevel exprseq_xs still on stack */
+                CHECK(n_push == n_pop + 1);
+                CHECK(n_hist == n_push);
+                CHECK(stats.max_xs_depth_ >= 4);
+
+                CHECK(stats.max_env_depth_ == 2);
+
+                /* x: one frame out;  y: innermost */
+                CHECK(stats.n_lookup_ == 2);
+                CHECK(stats.n_lookup_miss_ == 0);
+                CHECK(stats.lookup_depth_hist_[0] == 1);
+                CHECK(stats.lookup_depth_hist_[1] == 1);
+
+                CHECK(stats.n_toplevel_ == 2);
+                CHECK(stats.n_expr_ >= stats.n_toplevel_);
+                CHECK(stats.max_expr_per_toplevel_ >= 1);
+
+                /* unbound name */
+                CHECK_THROWS(feed(&parser, "def h = w;\n"));
+                CHECK(stats.n_lookup_miss_ == 1);
+
+                parser.clear_stats();
+                CHECK(parser.stats().n_toplevel_ == 0);
+
+                parser.begin_translation_unit();
+
+                /* disabled:  no counting */
+                parser.enable_stats(false);
+                feed(&parser, "def k = 2.0;\n");
+                CHECK(parser.stats().n_toplevel_ == 0);
+            } else {
+                CHECK(stats.n_toplevel_ == 0);
+                CHECK(stats.max_xs_depth_ == 0);
+            }
+        }
     } /*namespace ut*/
 } /*namespace xo*/
 
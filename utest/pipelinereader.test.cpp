@@ -0,0 +1,166 @@
+/* file pipelinereader.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/pipelinereader.hpp"
+#include "xo/reader/spscring.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include <catch2/catch.hpp>
+#include <thread>
+
+namespace xo {
+    using xo::scm::spscring;
+    using xo::scm::pipelinereader;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+    using xo::ast::DefineExpr;
+
+    namespace ut {
+        TEST_CASE("spscring", "[pipelinereader]") {
+            spscring<int> ring(3);
+
+            /* capacity rounds up to power of 2 */
+            REQUIRE(ring.capacity() == 4);
+
+            int x = 0;
+            CHECK(!ring.try_pop(&x));
+
+            for (int i = 0; i < 4; ++i)
+                CHECK(ring.try_push(int(i)));
+
+            CHECK(!ring.try_push(99));
+            CHECK(ring.size_approx() == 4);
+
+            for (int i = 0; i < 4; ++i) {
+                REQUIRE(ring.try_pop(&x));
+                CHECK(x == i);
+            }
+
+            CHECK(!ring.try_pop(&x));
+        }
+
+        TEST_CASE("spscring-threaded", "[pipelinereader]") {
+            constexpr int c_n = 100000;
+
+            spscring<int> ring(16);
+
+            std::thread producer([&ring]
+                                     {
+                                         for (int i = 0; i < c_n; ++i) {
+                                             while (!ring.try_push(int(i)))
+                                                 std::this_thread::yield();
+                                         }
+                                     });
+
+            bool in_order = true;
+
+            for (int i = 0; i < c_n; ++i) {
+                int x = -1;
+
+                while (!ring.try_pop(&x))
+                    std::this_thread::yield();
+
+                in_order = in_order && (x == i);
+            }
+
+            producer.join();
+
+            CHECK(in_order);
+            CHECK(ring.size_approx() == 0);
+        }
+
+        TEST_CASE("pipelinereader", "[pipelinereader]") {
+            std::string text;
+            for (int i = 0; i < 200; ++i) {
+                text += "def a" + std::to_string(i) + " = 1.0;\n";
+                text += "def f" + std::to_string(i) + " = lambda (x : f64) x * 2.0;\n";
+            }
+
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            /* reference: single-threaded reader */
+            std::vector<reader_result> expect_v;
+            {
+                reader rdr;
+                rdr.begin_translation_unit();
+                rdr.read_all(input, true /*eof*/, &expect_v);
+            }
+
+            /* small ring,  so both stages stall sometimes */
+            pipelinereader prdr(8);
+
+            /* twice:  pipelinereader is reusable */
+            for (int pass = 0; pass < 2; ++pass) {
+                INFO(tostr(xtag("pass", pass)));
+
+                std::vector<reader_result> result_v;
+                std::size_t n = prdr.read_all(input,
+                                              [&result_v](reader_result && rr)
+                                                  {
+                                                      result_v.push_back(std::move(rr));
+                                                  });
+
+                REQUIRE(n == expect_v.size());
+                REQUIRE(result_v.size() == expect_v.size());
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    CHECK(DefineExpr::from(result_v[i].expr_)->lhs_name()
+                          == DefineExpr::from(expect_v[i].expr_)->lhs_name());
+                    CHECK(result_v[i].rem_.lo() == expect_v[i].rem_.lo());
+                    CHECK(result_v[i].rem_.hi() == expect_v[i].rem_.hi());
+                    CHECK(result_v[i].varref_v_.size() == expect_v[i].varref_v_.size());
+                }
+
+                CHECK(prdr.stats().n_token_ > 0);
+                CHECK(prdr.stats().occupancy_max_ <= 8);
+            }
+        }
+
+        TEST_CASE("pipelinereader-error", "[pipelinereader]") {
+            pipelinereader prdr(8);
+
+            /* parse error part way through;  tokenizer thread must stop cleanly */
+            std::string bad = "def a = 1.0; ) def b = 2.0; def c = 3.0;";
+
+            CHECK_THROWS(prdr.read_all(reader::span_type(bad.data(), bad.data() + bad.size()),
+                                       [](reader_result &&) {}));
+
+            /* incomplete at eof */
+            std::string partial = "def a = 1.0; def b =";
+
+            CHECK_THROWS_AS(prdr.read_all(reader::span_type(partial.data(),
+                                                            partial.data() + partial.size()),
+                                          [](reader_result &&) {}),
+                            std::runtime_error);
+
+            /* still usable afterwards */
+            std::string ok = "def a = 1.0;";
+
+            CHECK(prdr.read_all(reader::span_type(ok.data(), ok.data() + ok.size()),
+                                [](reader_result &&) {}) == 1);
+        }
+
+        TEST_CASE("pipelinereader-error-then-good", "[pipelinereader]") {
+            pipelinereader prdr(8);
+
+            /* unterminated string:  tokenizer ends holding a partial token */
+            std::string bad = "def a = 1.0;\ndef s = \"abc";
+
+            CHECK_THROWS(prdr.read_all(reader::span_type(bad.data(), bad.data() + bad.size()),
+                                       [](reader_result &&) {}));
+
+            /* partial token must not carry into next read */
+            std::string good = "def b = 2.0;\n";
+
+            std::vector<reader_result> v;
+
+            REQUIRE(prdr.read_all(reader::span_type(good.data(), good.data() + good.size()),
+                                  [&v](reader_result && x) { v.push_back(std::move(x)); }) == 1);
+            REQUIRE(v.size() == 1);
+            CHECK(DefineExpr::from(v[0].expr_)->lhs_name() == "b");
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end pipelinereader.test.cpp */
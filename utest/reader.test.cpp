@@ -1,10 +1,25 @@
 /* @file reader.test.cpp */
 
 #include "xo/reader/reader.hpp"
+#include "xo/reader/lazylambda.hpp"
+#include "xo/expression/DefineExpr.hpp"
+#include "xo/expression/Apply.hpp"
+#include "xo/expression/Constant.hpp"
+#include "xo/expression/Lambda.hpp"
+#include "xo/expression/Sequence.hpp"
 #include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
 
 namespace xo {
     using xo::scm::reader;
+    using xo::scm::parserengine;
+    using xo::scm::LazyLambda;
+    using xo::ast::DefineExpr;
+    using xo::ast::Apply;
+    using xo::ast::Constant;
+    using xo::ast::Lambda;
+    using xo::ast::Sequence;
 
     namespace ut {
         namespace {
@@ -19,18 +34,24 @@ namespace xo {
                 {"def foo = lambda (x : f64) 3.1415965;"},
                 {"def foo = lambda (x : f64, y : f64) 3.1415965;"},
                 {"def foo = lambda (x : f64) x;"},
-                {"def foo = lambda (x : f64) { def y = x * x; y; }"},
+                {"def foo = lambda (x : f64) { def y = x * x; y; };"},
             };
         }
 
         TEST_CASE("reader", "[reader]") {
+            /* same expectations for each parser engine */
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
             constexpr bool c_debug_flag = true;
-            scope log(XO_DEBUG(c_debug_flag), xtag("utest", "reader"));
+            scope log(XO_DEBUG(c_debug_flag), xtag("utest", "reader"), xtag("engine", engine));
+
+            INFO(tostr(xtag("engine", engine)));
 
             for (std::size_t i_tc = 0; i_tc < s_testcase_v.size(); ++i_tc) {
                 const test_case & tc = s_testcase_v[i_tc];
 
-                reader rdr;
+                reader rdr(engine);
 
                 scope log(XO_ENTER2(always, c_debug_flag, "reader.testcase"),
                            xtag("i_tc", i_tc));
@@ -61,6 +82,547 @@ namespace xo {
                 }
             }
         }
+
+        TEST_CASE("reader-eof", "[reader]") {
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            /* trailing whitespace after last form is fine at eof */
+            {
+                reader rdr(engine);
+                rdr.begin_translation_unit();
+
+                auto input = reader::span_type::from_cstr("def foo = 1.0;  \n");
+                auto rr = rdr.read_expr(input, true /*eof*/);
+
+                REQUIRE(rr.expr_.get());
+
+                input = input.after_prefix(rr.rem_);
+
+                auto rr2 = rdr.read_expr(input, true /*eof*/);
+
+                CHECK(rr2.expr_.get() == nullptr);
+                CHECK(!rdr.has_incomplete_expr());
+            }
+
+            /* incomplete form at eof is an error */
+            {
+                reader rdr(engine);
+                rdr.begin_translation_unit();
+
+                auto input = reader::span_type::from_cstr("def foo = ");
+
+                CHECK_THROWS(rdr.read_expr(input, true /*eof*/));
+            }
+        }
+
+        TEST_CASE("reader-lexaddr", "[reader]") {
+            using xo::scm::lexaddr;
+
+            struct lexaddr_case {
+                const char * text_;
+                /* expected name, address for each variable reference */
+                std::vector<std::pair<std::string, lexaddr>> expected_v_;
+            };
+
+            std::vector<lexaddr_case> testcase_v = {
+                {"def foo = lambda (x : f64) x;",
+                 {{"x", lexaddr(0, 0)}}},
+                {"def foo = lambda (x : f64, y : f64) y;",
+                 {{"y", lexaddr(0, 1)}}},
+                {"def foo = lambda (x : f64, y : f64) lambda (z : f64) y;",
+                 {{"y", lexaddr(1, 1)}}},
+                {"def foo = lambda (x : f64) lambda (x : f64) x;",
+                 {{"x", lexaddr(0, 0)}}},
+                {"def foo = 3.14159265;",
+                 {}},
+                /* rhs of a local def is parsed before the block's frame exists */
+                {"def foo = lambda (x : f64) { def y = x * x; y; };",
+                 {{"x", lexaddr(0, 0)}, {"x", lexaddr(0, 0)}, {"y", lexaddr(0, 0)}}},
+                /* sequential scoping:  z sees y;  x is one frame out */
+                {"def foo = lambda (x : f64) { def y = x; def z = y; x; };",
+                 {{"x", lexaddr(0, 0)}, {"y", lexaddr(0, 0)}, {"x", lexaddr(1, 0)}}},
+                /* redefinition shadows,  and rhs sees the earlier binding */
+                {"def foo = lambda (x : f64) { def y = x; def y = y; y; };",
+                 {{"x", lexaddr(0, 0)}, {"y", lexaddr(0, 0)}, {"y", lexaddr(0, 1)}}},
+            };
+
+            for (std::size_t i_tc = 0; i_tc < testcase_v.size(); ++i_tc) {
+                const auto & tc = testcase_v[i_tc];
+
+                INFO(tostr(xtag("i_tc", i_tc), xtag("text", tc.text_)));
+
+                reader rdr;
+                rdr.begin_translation_unit();
+
+                auto rr = rdr.read_expr(reader::span_type::from_cstr(tc.text_),
+                                        true /*eof*/);
+
+                REQUIRE(rr.expr_.get());
+                REQUIRE(rr.varref_v_.size() == tc.expected_v_.size());
+
+                for (std::size_t i = 0; i < tc.expected_v_.size(); ++i) {
+                    REQUIRE(rr.varref_v_[i].var_.get());
+                    CHECK(rr.varref_v_[i].var_->name() == tc.expected_v_[i].first);
+                    CHECK(rr.varref_v_[i].addr_ == tc.expected_v_[i].second);
+                }
+            }
+        }
+
+        TEST_CASE("reader-block", "[reader]") {
+            /* local defs in a block stay flat:  one Sequence, no nested lambdas */
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            const char * text
+                = "def foo = lambda (x : f64) { def a = x; def b = a; def c = b; c; };";
+
+            reader rdr(engine);
+            rdr.begin_translation_unit();
+
+            auto rr = rdr.read_expr(reader::span_type::from_cstr(text), true /*eof*/);
+
+            REQUIRE(rr.expr_.get());
+
+            auto def = DefineExpr::from(rr.expr_);
+            REQUIRE(def);
+
+            auto lm = dynamic_cast<Lambda *>(def->rhs().get());
+            REQUIRE(lm);
+
+            auto seq = dynamic_cast<Sequence *>(lm->body().get());
+            REQUIRE(seq);
+            REQUIRE(seq->size() == 4);
+
+            CHECK(DefineExpr::from((*seq)[0])->lhs_name() == "a");
+            CHECK(DefineExpr::from((*seq)[1])->lhs_name() == "b");
+            CHECK(DefineExpr::from((*seq)[2])->lhs_name() == "c");
+            CHECK(!DefineExpr::from((*seq)[3]));
+        }
+
+        TEST_CASE("reader-block-local", "[reader]") {
+            /* block-local defs are not toplevel definitions */
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+
+            INFO(tostr(xtag("engine", engine)));
+
+            reader rdr(engine);
+            rdr.begin_translation_unit();
+
+            std::vector<xo::scm::reader_result> result_v;
+
+            rdr.read_all(reader::span_type::from_cstr
+                         ("def foo = lambda (x : f64) { def a = x; def b = a; b; };\n"
+                          "def bar = 2.0;\n"),
+                         false /*!eof*/,
+                         &result_v);
+
+            REQUIRE(result_v.size() == 2);
+
+            /* globals:  exactly the toplevel DefineExprs */
+            std::vector<std::string> global_v;
+            for (const auto & rr : result_v) {
+                auto def = DefineExpr::from(rr.expr_);
+                REQUIRE(def);
+                global_v.push_back(def->lhs_name());
+            }
+
+            CHECK(global_v == std::vector<std::string>{"foo", "bar"});
+
+            /* locals appear only as Sequence elements,  referenced by address */
+            auto lm = dynamic_cast<Lambda *>(DefineExpr::from(result_v[0].expr_)->rhs().get());
+            REQUIRE(lm);
+            auto seq = dynamic_cast<Sequence *>(lm->body().get());
+            REQUIRE(seq);
+            CHECK(DefineExpr::from((*seq)[0])->lhs_name() == "a");
+            CHECK(DefineExpr::from((*seq)[1])->lhs_name() == "b");
+
+            /* local names not in scope after their block */
+            CHECK_THROWS(rdr.read_expr(reader::span_type::from_cstr("def baz = lambda (y : f64) a;\n"),
+                                       false /*!eof*/));
+        }
+
+        TEST_CASE("reader-lazy-lambda", "[reader]") {
+            parserengine engine = GENERATE(parserengine::virtual_dispatch,
+                                           parserengine::variant_dispatch);
+            /* forced body uses same folding setting as eager parse */
+            bool fold = GENERATE(false, true);
+
+            struct lazy_case {
+                const char * text_;
+                /* true if toplevel lambda is lazy;  else its body is */
+                bool toplevel_lazy_;
+            };
+
+            std::vector<lazy_case> testcase_v = {
+                {"def foo = lambda (x : f64) { def y = x * x; y; };", true},
+                {"def foo = lambda (x : f64) { x; };", true},
+                /* body not a block -> eager;  inner body lazy, sees outer formals */
+                {"def foo = lambda (x : f64, y : f64) lambda (z : f64) { def w = y; z; };", false},
+                /* foldable constants in lazy body */
+                {"def foo = lambda (x : f64) { def y = 2.0 * 3.0; x * y; };", true},
+            };
+
+            for (std::size_t i_tc = 0; i_tc < testcase_v.size(); ++i_tc) {
+                const auto & tc = testcase_v[i_tc];
+
+                INFO(tostr(xtag("engine", engine), xtag("fold", fold),
+                           xtag("i_tc", i_tc), xtag("text", tc.text_)));
+
+                auto input = reader::span_type::from_cstr(tc.text_);
+
+                reader eager(engine);
+                eager.enable_constant_folding(fold);
+                eager.begin_translation_unit();
+                auto rr0 = eager.read_expr(input, true /*eof*/);
+
+                reader lazy(engine);
+                lazy.enable_constant_folding(fold);
+                lazy.enable_lazy_lambda(true);
+                lazy.begin_translation_unit();
+                auto rr1 = lazy.read_expr(input, true /*eof*/);
+
+                REQUIRE(rr0.expr_.get());
+                REQUIRE(rr1.expr_.get());
+                CHECK(rr1.rem_.size() == rr0.rem_.size());
+
+                auto def = DefineExpr::from(rr1.expr_);
+                REQUIRE(def);
+
+                ref::brw<LazyLambda> lz;
+                if (tc.toplevel_lazy_) {
+                    lz = LazyLambda::from(def->rhs());
+                } else {
+                    auto lm = dynamic_cast<Lambda *>(def->rhs().get());
+                    REQUIRE(lm);
+                    lz = LazyLambda::from(lm->body());
+                }
+
+                REQUIRE(lz);
+                CHECK(!lz->is_forced());
+                CHECK(lz->options().engine_ == engine);
+                CHECK(lz->options().constant_folding_ == fold);
+                CHECK(lz->options().lazy_lambda_);
+                CHECK(lz->body_text().front() == '{');
+                CHECK(lz->body_text().back() == '}');
+
+                auto forced = lz->force();
+
+                REQUIRE(forced);
+                CHECK(lz->is_forced());
+                CHECK(lz->force() == forced);
+
+                /* same tree as eager parse,  once forced */
+                CHECK(tostr(rr1.expr_) == tostr(rr0.expr_));
+
+                /* together,  reader + forced body report the same references */
+                std::vector<xo::scm::varref> ref_v = rr1.varref_v_;
+                ref_v.insert(ref_v.end(), lz->varref_v().begin(), lz->varref_v().end());
+
+                REQUIRE(ref_v.size() == rr0.varref_v_.size());
+                for (std::size_t i = 0; i < ref_v.size(); ++i) {
+                    CHECK(ref_v[i].var_->name() == rr0.varref_v_[i].var_->name());
+                    CHECK(ref_v[i].addr_ == rr0.varref_v_[i].addr_);
+                }
+            }
+        }
+
+        TEST_CASE("reader-lazy-lambda-chunked", "[reader]") {
+            /* body split across inputs is parsed eagerly;  body within one input is lazy */
+            std::string text = ("def f = lambda (x : f64) { x; };"
+                                "def g = lambda (x : f64) { x; };");
+            std::size_t split = text.find("{ x") + 2;
+
+            reader rdr;
+            rdr.enable_lazy_lambda(true);
+            rdr.begin_translation_unit();
+
+            std::vector<rp<xo::ast::Expression>> rhs_v;
+            auto sink = [&rhs_v](xo::scm::reader_result && rr)
+                            {
+                                rhs_v.push_back(DefineExpr::from(rr.expr_)->rhs());
+                            };
+
+            auto lo = reader::span_type(text.data(), text.data() + split);
+            auto hi = reader::span_type(text.data() + split, text.data() + text.size());
+
+            CHECK(rdr.read_all(lo, false /*!eof*/, sink) == 0);
+            CHECK(rdr.read_all(hi, true /*eof*/, sink) == 2);
+
+            REQUIRE(rhs_v.size() == 2);
+            CHECK(dynamic_cast<Lambda *>(rhs_v[0].get()));
+            CHECK(LazyLambda::from(rhs_v[1]));
+        }
+
+        TEST_CASE("reader-read-all", "[reader]") {
+            const char * text = ("def a = 1.0;\n"
+                                 "def b = lambda (x : f64) x;\n"
+                                 "  def c = (2.0 * 3.0);\n");
+
+            auto input = reader::span_type::from_cstr(text);
+
+            reader rdr;
+            rdr.begin_translation_unit();
+
+            std::vector<xo::scm::reader_result> result_v;
+            result_v.reserve(4);
+
+            std::size_t n = rdr.read_all(input, true /*eof*/, &result_v);
+
+            REQUIRE(n == 3);
+            REQUIRE(result_v.size() == 3);
+
+            CHECK(DefineExpr::from(result_v[0].expr_)->lhs_name() == "a");
+            CHECK(DefineExpr::from(result_v[1].expr_)->lhs_name() == "b");
+            CHECK(DefineExpr::from(result_v[2].expr_)->lhs_name() == "c");
+
+            /* spans are contiguous,  starting at input */
+            CHECK(result_v[0].rem_.lo() == input.lo());
+            CHECK(result_v[1].rem_.lo() == result_v[0].rem_.hi());
+            CHECK(result_v[2].rem_.lo() == result_v[1].rem_.hi());
+            CHECK(std::string(result_v[2].rem_.lo(), result_v[2].rem_.hi())
+                  == "\n  def c = (2.0 * 3.0);");
+
+            /* variable references travel with their expression */
+            CHECK(result_v[1].varref_v_.size() == 1);
+        }
+
+        TEST_CASE("reader-read-all-chunked", "[reader]") {
+            /* expression split across buffers completes on the later call */
+            std::string text = "def a = 1.0; def b = 2.0; def c = 3.0;";
+            std::size_t split = text.find("2.0") + 1;
+
+            reader rdr;
+            rdr.begin_translation_unit();
+
+            std::vector<std::string> name_v;
+            auto sink = [&name_v](xo::scm::reader_result && rr)
+                            {
+                                name_v.push_back(DefineExpr::from(rr.expr_)->lhs_name());
+                            };
+
+            auto lo = reader::span_type(text.data(), text.data() + split);
+            auto hi = reader::span_type(text.data() + split, text.data() + text.size());
+
+            CHECK(rdr.read_all(lo, false /*!eof*/, sink) == 1);
+            CHECK(rdr.read_all(hi, true /*eof*/, sink) == 2);
+
+            REQUIRE(name_v.size() == 3);
+            CHECK(name_v[0] == "a");
+            CHECK(name_v[1] == "b");
+            CHECK(name_v[2] == "c");
+        }
+
+        TEST_CASE("reader-read-file", "[reader]") {
+            namespace fs = std::filesystem;
+
+            fs::path path = fs::temp_directory_path() / "xo_reader_read_file.utest";
+
+            {
+                std::ofstream ofs(path);
+                ofs << "def a = 1.0;\ndef b = lambda (x : f64) x;\n";
+            }
+
+            reader rdr;
+
+            auto res = rdr.read_file(path.string());
+
+            REQUIRE(res.result_v_.size() == 2);
+            CHECK(DefineExpr::from(res.result_v_[0].expr_)->lhs_name() == "a");
+            CHECK(DefineExpr::from(res.result_v_[1].expr_)->lhs_name() == "b");
+
+            /* spans point into mapping */
+            CHECK(res.result_v_[0].rem_.lo() == res.file_.contents().lo());
+            CHECK(std::string(res.result_v_[0].rem_.lo(), res.result_v_[0].rem_.hi())
+                  == "def a = 1.0;");
+
+            /* sink variant */
+            std::size_t n = rdr.read_file(path.string(),
+                                          [](xo::scm::reader_result &&) {});
+            CHECK(n == 2);
+
+            /* empty file */
+            {
+                std::ofstream ofs(path, std::ios::trunc);
+            }
+
+            CHECK(rdr.read_file(path.string()).result_v_.empty());
+
+            fs::remove(path);
+
+            CHECK_THROWS_AS(rdr.read_file(path.string()), std::runtime_error);
+        }
+
+        TEST_CASE("reader-read-lazy", "[reader]") {
+            using xo::scm::reader_chunk;
+
+            /* chunk boundaries fall mid-token and mid-expression */
+            std::vector<std::string> chunk_v = {
+                "def a = 1.",
+                "0; def b = lambda (x : f64) x; de",
+                "f c = 2.0;",
+                "",
+            };
+
+            std::size_t i_chunk = 0;
+            auto source = [&chunk_v, &i_chunk]()
+                              {
+                                  const std::string & s = chunk_v.at(i_chunk++);
+                                  return reader_chunk{reader::span_type(s.data(), s.data() + s.size()),
+                                                      i_chunk == chunk_v.size()};
+                              };
+
+            auto gen = reader::read_lazy(source);
+
+            /* lazy: nothing read until first pull */
+            CHECK(i_chunk == 0);
+
+            std::vector<std::string> name_v;
+
+            for (auto & rr : gen) {
+                name_v.push_back(DefineExpr::from(rr.expr_)->lhs_name());
+
+                /* suspends after each expression */
+                if (name_v.size() == 1)
+                    CHECK(i_chunk == 2);
+            }
+
+            REQUIRE(name_v.size() == 3);
+            CHECK(name_v[0] == "a");
+            CHECK(name_v[1] == "b");
+            CHECK(name_v[2] == "c");
+            CHECK(i_chunk == chunk_v.size());
+
+            /* errors propagate to consumer */
+            std::string bad = "def a = 1.0; def";
+            auto bad_gen = reader::read_lazy([&bad]()
+                                                 {
+                                                     return reader_chunk{reader::span_type(bad.data(), bad.data() + bad.size()),
+                                                                         true};
+                                                 });
+
+            auto ix = bad_gen.begin();
+            REQUIRE(ix != bad_gen.end());
+            CHECK_THROWS_AS(++ix, std::runtime_error);
+        }
+
+        TEST_CASE("reader-infix", "[reader]") {
+            struct infix_case {
+                const char * text_;
+                /* expected shape of rhs: is each argument itself an Apply? */
+                bool lhs_is_apply_;
+                bool rhs_is_apply_;
+            };
+
+            std::vector<infix_case> testcase_v = {
+                /* left-associative: (1 - 2) - 3 */
+                {"def x = 1.0 - 2.0 - 3.0;", true, false},
+                {"def x = 8.0 / 4.0 / 2.0;", true, false},
+                /* precedence: 1 + (2 * 3) */
+                {"def x = 1.0 + 2.0 * 3.0;", false, true},
+                /* precedence: (1 * 2) + 3 */
+                {"def x = 1.0 * 2.0 + 3.0;", true, false},
+                /* (1 * 2) + (3 * 4) */
+                {"def x = 1.0 * 2.0 + 3.0 * 4.0;", true, true},
+                /* parens: 1 * (2 + 3) */
+                {"def x = 1.0 * (2.0 + 3.0);", false, true},
+            };
+
+            for (std::size_t i_tc = 0; i_tc < testcase_v.size(); ++i_tc) {
+                const auto & tc = testcase_v[i_tc];
+
+                INFO(tostr(xtag("i_tc", i_tc), xtag("text", tc.text_)));
+
+                reader rdr;
+                rdr.begin_translation_unit();
+
+                auto rr = rdr.read_expr(reader::span_type::from_cstr(tc.text_),
+                                        true /*eof*/);
+
+                REQUIRE(rr.expr_.get());
+
+                auto def = DefineExpr::from(rr.expr_);
+                REQUIRE(def);
+
+                auto app = Apply::from(def->rhs());
+                REQUIRE(app);
+                REQUIRE(app->argv().size() == 2);
+
+                CHECK(bool(Apply::from(app->argv()[0])) == tc.lhs_is_apply_);
+                CHECK(bool(Apply::from(app->argv()[1])) == tc.rhs_is_apply_);
+            }
+        }
+
+        TEST_CASE("reader-constfold", "[reader]") {
+            const char * text = "def k = 2.0 * 3.14159265 / 180.0;";
+
+            for (bool fold : {false, true}) {
+                INFO(tostr(xtag("fold", fold)));
+
+                reader rdr;
+                rdr.enable_constant_folding(fold);
+                rdr.begin_translation_unit();
+
+                auto rr = rdr.read_expr(reader::span_type::from_cstr(text), true /*eof*/);
+
+                REQUIRE(rr.expr_.get());
+
+                auto def = DefineExpr::from(rr.expr_);
+                REQUIRE(def);
+
+                auto k = dynamic_cast<Constant<double> *>(def->rhs().get());
+
+                if (fold) {
+                    REQUIRE(k);
+                    /* bit-identical to runtime evaluation */
+                    volatile double x = 2.0;
+                    CHECK(k->value() == (x * 3.14159265) / 180.0);
+                    CHECK(rdr.n_folded() == 2);
+                } else {
+                    CHECK(k == nullptr);
+                    CHECK(Apply::from(def->rhs()));
+                    CHECK(rdr.n_folded() == 0);
+                }
+            }
+        }
+
+        TEST_CASE("reader-constfold-partial", "[reader]") {
+            struct fold_case {
+                const char * text_;
+                std::size_t n_folded_;
+            };
+
+            std::vector<fold_case> testcase_v = {
+                /* only literal-only subtree folds */
+                {"def f = lambda (x : f64) x * (2.0 + 3.0);", 1},
+                /* x * 2.0 isn't literal-only;  neither is (x * 2.0) * 3.0 */
+                {"def f = lambda (x : f64) x * 2.0 * 3.0;", 0},
+                /* 2.0 * 3.0 reduced before x appears */
+                {"def f = lambda (x : f64) 2.0 * 3.0 * x;", 1},
+                /* non-finite result left for runtime */
+                {"def k = 1.0 / 0.0;", 0},
+            };
+
+            for (std::size_t i_tc = 0; i_tc < testcase_v.size(); ++i_tc) {
+                const auto & tc = testcase_v[i_tc];
+
+                INFO(tostr(xtag("i_tc", i_tc), xtag("text", tc.text_)));
+
+                reader rdr;
+                rdr.enable_constant_folding(true);
+                rdr.begin_translation_unit();
+
+                auto rr = rdr.read_expr(reader::span_type::from_cstr(tc.text_), true /*eof*/);
+
+                REQUIRE(rr.expr_.get());
+                CHECK(rdr.n_folded() == tc.n_folded_);
+            }
+        }
     } /*namespace ut*/
 } /*namespace xo*/
 
@@ -0,0 +1,73 @@
+/* file readerperf.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/readerperf.hpp"
+#include "xo/reader/reader.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <catch2/catch.hpp>
+
+namespace xo {
+    using xo::scm::readerperf;
+    using xo::scm::readerphase;
+    using xo::scm::perfevent;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+
+    namespace ut {
+        TEST_CASE("readerperf", "[readerperf]") {
+            std::string text;
+            for (int i = 0; i < 100; ++i)
+                text += "def f" + std::to_string(i) + " = lambda (x : f64, y : f64) x * y + 2.0;\n";
+
+            auto input = reader::span_type(text.data(), text.data() + text.size());
+
+            std::vector<reader_result> plain_v;
+            {
+                reader rdr;
+                rdr.begin_translation_unit();
+                rdr.read_all(input, true /*eof*/, &plain_v);
+            }
+
+            readerperf perf;
+
+            INFO(tostr(xtag("available", perf.available())));
+
+            std::vector<reader_result> perf_v;
+            {
+                reader rdr;
+                rdr.attach_readerperf(&perf);
+                rdr.begin_translation_unit();
+                rdr.read_all(input, true /*eof*/, &perf_v);
+            }
+
+            INFO(tostr(xtag("perf", perf)));
+
+            /* instrumentation does not change results */
+            REQUIRE(perf_v.size() == plain_v.size());
+            for (std::size_t i = 0; i < perf_v.size(); ++i)
+                CHECK(tostr(perf_v[i].expr_) == tostr(plain_v[i].expr_));
+
+            /* tokens counted either way */
+            CHECK(perf.n_token() == 100 * 19);
+
+            if (perf.available()) {
+                CHECK(perf.phase(readerphase::tokenize)[perfevent::cycles] > 0);
+                CHECK(perf.phase(readerphase::parse)[perfevent::cycles] > 0);
+                CHECK(perf.phase(readerphase::parse).ipc() > 0.0);
+            } else {
+                /* no counters:  everything reads zero */
+                CHECK(perf.phase(readerphase::tokenize)[perfevent::cycles] == 0);
+                CHECK(perf.phase(readerphase::parse)[perfevent::instructions] == 0);
+                CHECK(perf.phase(readerphase::parse).ipc() == 0.0);
+            }
+
+            perf.clear();
+            CHECK(perf.n_token() == 0);
+            CHECK(perf.phase(readerphase::parse)[perfevent::cycles] == 0);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end readerperf.test.cpp */
@@ -0,0 +1,153 @@
+/* file structindex.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/structindex.hpp"
+#include "xo/reader/segmenter.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <catch2/catch.hpp>
+#include <random>
+
+namespace xo {
+    using xo::scm::structindex;
+    using xo::scm::structscanner;
+    using xo::scm::simdlevel;
+    using xo::scm::segmenter;
+
+    namespace ut {
+        namespace {
+            using span_type = structscanner::span_type;
+
+            /* byte-at-a-time reference for structscanner */
+            structindex
+            reference_index(const std::string & text) {
+                structindex retval;
+
+                bool in_string = false;
+                /* length of backslash run ending just before current char */
+                std::size_t n_bs = 0;
+                std::int32_t depth = 0;
+
+                for (std::size_t i = 0; i < text.size(); ++i) {
+                    char c = text[i];
+                    bool escaped = (n_bs % 2 == 1);
+
+                    n_bs = (c == '\\') ? n_bs + 1 : 0;
+
+                    if (escaped || (c == '\\'))
+                        continue;
+
+                    if (c == '"') {
+                        in_string = !in_string;
+                    } else if (in_string) {
+                        continue;
+                    } else if ((c == '(') || (c == '{') || (c == '[')) {
+                        ++depth;
+                    } else if ((c == ')') || (c == '}') || (c == ']')) {
+                        --depth;
+                    } else if (c != ';') {
+                        continue;
+                    }
+
+                    retval.pos_v_.push_back(i);
+                    retval.depth_v_.push_back(depth);
+                }
+
+                return retval;
+            }
+
+            span_type
+            as_span(const std::string & text) {
+                return span_type(text.data(), text.data() + text.size());
+            }
+
+            std::vector<simdlevel>
+            all_levels() {
+                return { simdlevel::scalar, simdlevel::sse2, simdlevel::avx2 };
+            }
+        }
+
+        TEST_CASE("structindex", "[structindex]") {
+            std::string text = "def f = lambda (x : f64) { \"a;(\\\"\"; x; };";
+
+            auto expected = reference_index(text);
+
+            /* ( ) { " " ; ; } ; */
+            REQUIRE(expected.size() == 9);
+            CHECK(expected.pos_v_[0] == text.find('('));
+            CHECK(expected.depth_v_[0] == 1);
+            CHECK(expected.depth_v_[2] == 1);
+            CHECK(expected.depth_v_[7] == 0);
+            CHECK(text[expected.pos_v_[8]] == ';');
+
+            for (simdlevel level : all_levels()) {
+                INFO(tostr(xtag("level", level)));
+
+                auto index = structscanner::index(as_span(text), level);
+
+                CHECK(index.pos_v_ == expected.pos_v_);
+                CHECK(index.depth_v_ == expected.depth_v_);
+            }
+        }
+
+        TEST_CASE("structindex-random", "[structindex]") {
+            /* alphabet heavy in structurals, quotes and backslashes,
+             * so that strings and backslash runs straddle block boundaries
+             */
+            const std::string alphabet = "(){}[];\"\\\\\\ab ";
+
+            std::mt19937 rng(12345);
+            std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+
+            for (std::size_t n : {0ul, 1ul, 63ul, 64ul, 65ul, 200ul, 1000ul, 4099ul}) {
+                std::string text;
+                for (std::size_t i = 0; i < n; ++i)
+                    text.push_back(alphabet[pick(rng)]);
+
+                auto expected = reference_index(text);
+
+                for (simdlevel level : all_levels()) {
+                    INFO(tostr(xtag("n", n), xtag("level", level)));
+
+                    auto index = structscanner::index(as_span(text), level);
+
+                    REQUIRE(index.pos_v_ == expected.pos_v_);
+                    REQUIRE(index.depth_v_ == expected.depth_v_);
+
+                    /* same result when input arrives in whole-block pieces */
+                    structscanner scanner(level);
+                    structindex pieces;
+
+                    for (std::size_t lo = 0; lo < n; lo += 3 * structscanner::c_block_size) {
+                        std::size_t hi = std::min(lo + 3 * structscanner::c_block_size, n);
+                        scanner.scan(span_type(text.data() + lo, text.data() + hi), &pieces);
+                    }
+
+                    REQUIRE(pieces.pos_v_ == expected.pos_v_);
+                    REQUIRE(scanner.offset() == n);
+                }
+            }
+        }
+
+        TEST_CASE("segmenter-simdlevel", "[structindex]") {
+            std::string form = "def s = \"x;\\\";\"; def f = lambda (x : f64) { x; };";
+            std::string text;
+
+            while (text.size() < 50000)
+                text += form;
+
+            auto expected = segmenter::split(as_span(text), 37, simdlevel::scalar);
+
+            REQUIRE(expected.size() == 36);
+
+            for (simdlevel level : all_levels()) {
+                INFO(tostr(xtag("level", level)));
+
+                CHECK(segmenter::split(as_span(text), 37, level) == expected);
+            }
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end structindex.test.cpp */
@@ -0,0 +1,125 @@
+/* file tokenrecord.test.cpp
+ *
+ * author: Roland Conybeare
+ */
+
+#include "xo/reader/tokenrecord.hpp"
+#include "xo/reader/reader.hpp"
+#include "xo/reader/lazylambda.hpp"
+#include "xo/indentlog/print/tag.hpp"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <unistd.h>
+
+namespace xo {
+    using xo::scm::tokenrecorder;
+    using xo::scm::tokenreplay;
+    using xo::scm::reader;
+    using xo::scm::reader_result;
+    using xo::scm::parser;
+    using xo::ast::Expression;
+
+    namespace ut {
+        namespace {
+            const char * s_source
+                = ("def pi : f64 = 3.14159265;\n"
+                   "def sq = lambda (x : f64) x * x;\n"
+                   "def f = lambda (x : f64, y : f64) { def z = x * y; z; };\n"
+                   "def g = lambda (x : f64) lambda (y : f64) (x - y);\n");
+
+            /* read @p text,  recording parser input to @p p_rec */
+            std::vector<reader_result>
+            read_recorded(const std::string & text, bool lazy, tokenrecorder * p_rec) {
+                reader rdr;
+                std::vector<reader_result> retval;
+
+                rdr.enable_lazy_lambda(lazy);
+                rdr.attach_tokenrecorder(p_rec);
+                rdr.begin_translation_unit();
+                rdr.read_all(reader::span_type(text.data(), text.data() + text.size()),
+                             true /*eof*/, &retval);
+
+                return retval;
+            }
+
+            std::vector<rp<Expression>>
+            replay(const tokenreplay & tr, bool lazy) {
+                parser psr;
+                psr.enable_lazy_lambda(lazy);
+
+                std::vector<rp<Expression>> retval;
+
+                tr.replay(&psr, [&retval](rp<Expression> x) { retval.push_back(std::move(x)); });
+
+                return retval;
+            }
+        }
+
+        TEST_CASE("tokenrecord", "[tokenrecord]") {
+            for (bool lazy : {false, true}) {
+                INFO(tostr(xtag("lazy", lazy)));
+
+                std::string text = s_source;
+
+                tokenrecorder rec;
+                auto result_v = read_recorded(text, lazy, &rec);
+
+                REQUIRE(result_v.size() == 4);
+                CHECK(rec.size() > 0);
+
+                tokenreplay tr = tokenreplay::from_image(rec.image());
+
+                CHECK(tr.size() == rec.size());
+
+                auto expr_v = replay(tr, lazy);
+
+                REQUIRE(expr_v.size() == result_v.size());
+
+                for (std::size_t i = 0; i < expr_v.size(); ++i) {
+                    INFO(tostr(xtag("i", i)));
+
+                    CHECK(tostr(expr_v[i]) == tostr(result_v[i].expr_));
+                }
+
+                /* replay is repeatable */
+                CHECK(replay(tr, lazy).size() == expr_v.size());
+            }
+        }
+
+        TEST_CASE("tokenrecord-file", "[tokenrecord]") {
+            namespace fs = std::filesystem;
+
+            fs::path path = (fs::temp_directory_path()
+                             / ("xo_tokenrecord_utest_" + std::to_string(::getpid()) + ".tkrec"));
+
+            std::string text = s_source;
+
+            tokenrecorder rec;
+            auto result_v = read_recorded(text, false, &rec);
+
+            rec.write(path.string());
+
+            {
+                tokenreplay tr = tokenreplay::open(path.string());
+
+                CHECK(tr.size() == rec.size());
+                CHECK(replay(tr, false).size() == result_v.size());
+            }
+
+            /* damaged recordings */
+            std::string image = rec.image();
+
+            CHECK_THROWS(tokenreplay::from_image(image.substr(0, image.size() - 1)));
+            CHECK_THROWS(tokenreplay::from_image("not a recording"));
+
+            /* cleared recorder records nothing */
+            rec.clear();
+            CHECK(rec.size() == 0);
+            CHECK(tokenreplay::from_image(rec.image()).size() == 0);
+
+            fs::remove(path);
+        }
+    } /*namespace ut*/
+} /*namespace xo*/
+
+/* end tokenrecord.test.cpp */